@@ -0,0 +1,41 @@
+// ----------------------------------------------------------------------
+// File: output.h
+//
+// Name: Jonathan Goohs
+//
+// Description: This is the header file for the output module. It writes
+//     text, whole numbers and color changes to standard output through
+//     a large buffer of its own, without printf: the buffer only goes
+//     out when it is full or when out_flush() is called.
+//
+//     Anything printed with stdio must be flushed (fflush(stdout))
+//     before this module's output starts, and out_flush() called before
+//     stdio is used again, so the two come out in order.
+//
+//     project3 and project4 each carry a copy of this file, so that
+//     each builds and tars on its own; the copies must be kept the
+//     same, so a fix to one goes in the other too.
+// ----------------------------------------------------------------------
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stddef.h>
+
+#define OUT_BUFFER_SIZE (64 * 1024)   // bytes written at a time
+
+// The colors of the text
+enum out_color {
+    OUT_RESET,          // the terminal's own
+    OUT_RED,
+    OUT_COLORS
+};
+
+void out_text(const char *text, const size_t length);
+void out_string(const char *text);
+void out_char(const char c);
+void out_uint(unsigned long value, const int width);
+void out_color(const enum out_color color);
+int  out_flush(void);
+
+#endif
+// end output.h
@@ -16,8 +16,77 @@
 //     pass through the list to print out the values in the list as well
 //     as their calculated total.
 //
+//     The objects of the list come from a pool: large slabs of them are
+//     allocated at once, each twice the size of the last, and handed out
+//     in order, so building the list costs one malloc per slab instead of
+//     one per object, the objects lie next to each other in memory, and
+//     the whole list is released by freeing its few slabs. With -m each
+//     object is malloc'd and freed on its own instead, as the program
+//     first did, for comparison.
+//
+//     With -u the list is an unrolled one instead: each of its objects
+//     holds CHUNK_VALUES values, a count of them and the link to the
+//     next object in one 64-byte cache line, so adding up the list
+//     reads a whole line of values per link followed rather than one,
+//     and the values of an object are added with SSE2 instructions.
+//     -b compares adding up the two lists and a flat array, from lists
+//     that fit in the L1 cache to lists far larger than the last level
+//     cache.
+//
+//     With -s, build_list also records every SEGMENT_VALUES-th object
+//     of the list in an index, the heads of its segments, and with -p
+//     calc_total splits the segments between threads, each adding up
+//     its share into a 64-bit sum of its own without following the
+//     list to find where that share starts. The threads are started
+//     once and wait for each total to work out. -b -s measures how
+//     much faster a list far larger than the cache is added up on
+//     more threads.
+//
+//     Each object of the linked list also points PREFETCH_DISTANCE
+//     objects further on, and every walk along the list goes through
+//     the walk_t iterator, which asks for the object that far ahead to
+//     be fetched into the cache while it visits this one. A list whose
+//     objects are scattered over memory then waits for memory once
+//     per PREFETCH_DISTANCE objects rather than once per object. -r
+//     scatters the list, linking its objects in a random order, as a
+//     fragmented heap would, and -n walks without prefetching.
+//
+//     With -f there is no list at all: each value is added to the total
+//     and printed as soon as it is made, in one pass, in a fixed amount
+//     of memory however many values there are. -e prints only every
+//     n-th value, in either mode, and the output is written in
+//     OUTPUT_BUFFER blocks rather than a line at a time. -t reports the
+//     most memory the program held (ru_maxrss) in either mode.
+//
+//     The values are printed with the output module (output.h), which
+//     formats the numbers itself into a large buffer and writes it out
+//     when it is full or the printing is done, rather than with a
+//     printf per value; -w prints them with printf instead, and -b -w
+//     compares the two writing to a file and to /dev/null.
+//
 // Syntax:
-//     ./randadd number   #number is an int between 1 and 42, inclusive
+//     ./randadd [-l] [-m] [-n] [-q] [-r] [-t] [-u | -s [-p threads]]
+//               [-e every] number
+//     ./randadd -f [-l] [-q] [-t] [-w] [-e every] number
+//     ./randadd -b [-m] [-n] [-r | -s [-p threads] | -w]
+//         number is an int between 1 and 42, inclusive
+//     -l  large lists: number may be up to 2147483647
+//     -m  malloc and free every object of the list on its own
+//     -q  quiet: do not print the values, only the total
+//     -t  print how long building, adding up and freeing the list took
+//     -u  use an unrolled list
+//     -s  keep an index of the segments of the list
+//     -p  add up the segments on this many threads (default 1)
+//     -r  link the objects of the list in a random order
+//     -n  naive walks along the list, without prefetching
+//     -f  stream the values: add them up and print them without a list
+//     -e  print only every n-th value
+//     -w  print the values with printf
+//     -b  benchmark adding up the lists and an array, or with -s,
+//         adding up a list on 1, 2, 4 ... threads (default 8), or
+//         with -r, walking along lists in order and scattered, with
+//         and without prefetching, or with -w, printing a list with
+//         printf and with the output module
 //
 //Resources:
 //www.geeksforgeeks.org/how-to-use-typedef-in-c to understand the struct definition. 
@@ -38,6 +107,15 @@
 #include <errno.h>
 #include <unistd.h>
 #include <string.h>
+#include <stdbool.h>
+#include <limits.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include "output.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 // constants
 #define VALID_NUM_ARGS 2
@@ -45,11 +123,36 @@
 #define ARGV_NUMBER    1
 #define MIN_NUMBER     1
 #define MAX_NUMBER     42
+#define MAX_LARGE_NUMBER INT_MAX   // with -l
 #define MAX_VALUE      50
 #define BASE_10        10
 #define VALID_EXECUTABLE "./randadd"
 #define RED_TEXT "\033[31m"
 #define RESET_COLOR "\033[0m"
+#define OPTIONS        "be:flmnp:qrstuw"
+#define CACHE_LINE     64
+#define CHUNK_VALUES   12          // values in an object of an unrolled list
+#define FIRST_SLAB     (64 * 1024) // bytes in the first slab of the pool
+#define MAX_SLAB       (256 * 1024 * 1024) // the slabs double up to this
+#define NSEC_PER_SEC   1000000000.0
+#define NSEC_PER_VALUE 1e9         // seconds to ns per value, with a count
+#define BENCH_FIRST    1024        // values in the smallest benchmark list
+#define BENCH_LAST     (1 << 26)   // and in the largest
+#define BENCH_STEP     4
+#define BENCH_VALUES   (1 << 28)   // values added up at each size
+#define ARRAY_BLOCK    (1 << 24)   // values added up in 32 bits at a time
+#define BYTES_PER_KB   1024
+#define SEGMENT_VALUES (1 << 16)   // objects in a segment of the list
+#define FIRST_SEGMENTS 64          // room in the first index of segments
+#define MAX_THREADS    64
+#define BENCH_THREADS  8           // the most threads -b -s tries
+#define PREFETCH_DISTANCE 16       // objects a walk prefetches ahead
+#define BENCH_WALK_VALUES (1 << 26) // values walked at each size by -b -r
+#define OUTPUT_BUFFER  (64 * 1024) // bytes of output written at a time
+#define BENCH_LINES    (1 << 22)   // lines printed by -b -w
+#define BENCH_OUTPUT   "randadd.out"
+#define COUNT_WIDTH    2           // of the numbers printed
+#define VALUE_WIDTH    2
 
 // return codes
 #define SUCCESS        0
@@ -57,6 +160,7 @@
 #define INVALID_NUMBER 2
 #define MALLOC_ERROR   3
 #define BAD_INPUT      4
+#define WRITE_ERROR    5
 
 // Define the structure type to be used in the linked list, where value_t is the variable to represent the struct value
 typedef struct value value_t;
@@ -64,16 +168,144 @@ struct value {
     //struct value holds the members val, an integer, and a pointer to the structure called next
     int val;        // a random value
     value_t *next;  // link to next object in the list
+    value_t *jump;  // the object PREFETCH_DISTANCE further on, or NULL
+};
+
+// A walk along a linked list, from walk_start() on
+typedef struct walk walk_t;
+struct walk {
+    value_t *current;   // the object walk_next() returns next
+};
+
+// An object of an unrolled list: CHUNK_VALUES values, how many of them
+// are used, and the link to the next object, in one cache line. The
+// values that are not used are 0.
+typedef struct chunk chunk_t;
+struct chunk {
+    int val[CHUNK_VALUES];  // random values
+    int count;              // how many of them are used
+    chunk_t *next;          // link to next object in the list
+} __attribute__((aligned(CACHE_LINE)));
+
+// The options given on the command line
+typedef struct options options_t;
+struct options {
+    bool large;         // -l
+    bool use_malloc;    // -m
+    bool quiet;         // -q
+    bool timing;        // -t
+    bool unrolled;      // -u
+    bool bench;         // -b
+    bool segments;      // -s
+    int  threads;       // -p
+    bool shuffle;       // -r
+    bool naive;         // -n
+    bool stream;        // -f
+    int  every;         // -e
+    bool use_printf;    // -w
+};
+
+// A slab of list objects, allocated at once
+typedef struct slab slab_t;
+struct slab {
+    slab_t *next;       // the slab allocated before this one
+    size_t  size;       // how many bytes it holds
+    unsigned char bytes[] __attribute__((aligned(CACHE_LINE)));
+};
+
+// Where the objects of the list come from
+typedef struct pool pool_t;
+struct pool {
+    slab_t *slabs;      // the newest slab first
+    size_t  used;       // bytes handed out of the newest slab
+    bool    use_malloc; // malloc every value on its own instead
+};
+
+
+// The index of the segments of a list: every SEGMENT_VALUES-th object
+typedef struct segments segments_t;
+struct segments {
+    value_t **heads;    // the first object of each segment
+    int count;
+    int size;           // room in heads
+    bool enabled;       // build_list keeps the index
+};
+
+// A thread adding up segments of the list; aligned so no two threads
+// write to the same cache line
+typedef struct worker worker_t;
+struct worker {
+    pthread_t thread;
+    int first;          // the segments it adds up
+    int count;
+    long int total;     // their sum
+} __attribute__((aligned(CACHE_LINE)));
+
+// The threads that add up the segments. The thread calling calc_total
+// is worker 0; the others wait for a new round to start.
+typedef struct team team_t;
+struct team {
+    pthread_mutex_t lock;
+    pthread_cond_t  go;         // a round started, or stop
+    pthread_cond_t  done;       // the last worker finished its share
+    int threads;
+    unsigned int round;         // bumped for each total
+    int busy;                   // workers still adding up this round
+    bool stop;
 };
 
 
+// ----------------------------------------------------------------------
+// ------------------------- G L O B A L S ------------------------------
+// ----------------------------------------------------------------------
+static pool_t Pool = { NULL, 0, false };
+static segments_t Segments = { NULL, 0, 0, false };
+static bool Prefetch = true;    // walks prefetch the objects ahead
+static int Print_every = 1;     // print only every n-th value
+static bool Use_printf = false; // print the values with printf
+static worker_t Workers[MAX_THREADS];
+static team_t Team = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER,
+                       PTHREAD_COND_INITIALIZER, 1, 0, 0, false };
+
+
 // ----------------------------------------------------------------------
 // ------------------------ P R O T O T Y P E S -------------------------
 // ----------------------------------------------------------------------
-int get_input(int argc, char *argv[], int *num);
+int get_input(int argc, char *argv[], int *num, options_t *options);
+void *pool_alloc(const size_t size, const size_t align);
+void free_pool(void);
+value_t *new_value(void);
+chunk_t *new_chunk(void);
+void free_list(value_t *start);
+void free_chunks(chunk_t *start);
+double seconds_since(const struct timespec *start);
+long int max_rss(void);
+void print_start(void);
+void print_value(const long int count, const int val);
+int print_end(void);
+int stream_total(const int num, const bool print, long int *total);
+int add_segment(value_t *head);
+long int sum_segments(const int first, const int count);
+void *run_worker(void *arg);
+int start_workers(const int threads);
+void stop_workers(void);
+static inline void walk_start(walk_t *walk, value_t *start);
+static inline value_t *walk_next(walk_t *walk);
+void set_jumps(value_t *start);
+int shuffle_list(const int num, value_t *start);
 int build_list(const int num, value_t *start);
 int print_list(value_t *start);
 int calc_total(value_t *start, long int *total);
+int build_chunks(const int num, chunk_t *start);
+int print_chunks(chunk_t *start);
+int sum_chunk(const chunk_t *chunk);
+int calc_chunks_total(chunk_t *start, long int *total);
+long int sum_array(const int *values, const int num);
+int benchmark(void);
+int benchmark_threads(const int threads);
+double time_walks(value_t *start, const int num);
+int benchmark_walks(void);
+int benchmark_output(void);
 
 // **********************************************************************
 // **************************  M  A  I  N  ******************************
@@ -84,16 +316,61 @@ int main(int argc, char *argv[])
     int result       = SUCCESS;
     long int total   = -1;
     value_t *start   = NULL;
-    value_t *current = NULL;
+    chunk_t *chunks  = NULL;
+    options_t options;
+    struct timespec begin;
+    double build_time = 0;
+    double total_time = 0;
+    double free_time  = 0;
+    double print_time = 0;
+
+    // Write the output in blocks, not lines
+    setvbuf(stdout, NULL, _IOFBF, OUTPUT_BUFFER);
 
     // Verify the input from the user is valid
-    result = get_input(argc, argv, &num);
+    result = get_input(argc, argv, &num, &options);
+    Pool.use_malloc = options.use_malloc;
+    Segments.enabled = options.segments;
+    Prefetch = !options.naive;
+    Print_every = options.every;
+    Use_printf = options.use_printf;
+    if ((result == SUCCESS) && options.bench) {
+        if (options.shuffle) {
+            return benchmark_walks();
+        }
+        if (options.use_printf) {
+            return benchmark_output();
+        }
+        return options.segments ? benchmark_threads(options.threads)
+                                : benchmark();
+    }
+    if ((result == SUCCESS) && (options.threads > 1)) {
+        result = start_workers(options.threads);
+    }
+
+    // Make, add up and print the values in one pass, without a list
+    if ((result == SUCCESS) && options.stream) {
+        clock_gettime(CLOCK_MONOTONIC, &begin);
+        result = stream_total(num, !options.quiet, &total);
+        total_time = seconds_since(&begin);
+        printf("\nTotal = %ld\n", total);
+        if (options.timing) {
+            printf("%d values streamed: %.3f s, max RSS %ld KiB\n", num,
+                   total_time, max_rss());
+        }
+        return result;
+    }
 
     // Get the memory for the start of the list
+    clock_gettime(CLOCK_MONOTONIC, &begin);
     if (result == SUCCESS) {
         errno = SUCCESS;
-        start = malloc(sizeof(value_t));
-        if (start == NULL) {
+        if (options.unrolled) {
+            chunks = new_chunk();
+        } else {
+            start = new_value();
+        }
+        if ((start == NULL) && (chunks == NULL)) {
             if (errno != SUCCESS) {
                 result = MALLOC_ERROR;
                 printf("malloc error when starting the list\n");
@@ -106,23 +383,43 @@ int main(int argc, char *argv[])
 
     // Build the linked list
     if (result == SUCCESS) {
-        result = build_list(num, start);
+        if (options.unrolled) {
+            result = build_chunks(num, chunks);
+        } else {
+            result = build_list(num, start);
+            if ((result == SUCCESS) && options.shuffle) {
+                result = shuffle_list(num, start);
+            }
+        }
         if (result != SUCCESS) {
             printf("Error: problem building list\n");
         }
     }
+    build_time = seconds_since(&begin);
 
     // Print out linked list
-    if (result == SUCCESS) {
-        result = print_list(start);
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    if ((result == SUCCESS) && !options.quiet) {
+        if (options.unrolled) {
+            result = print_chunks(chunks);
+        } else {
+            result = print_list(start);
+        }
         if (result != SUCCESS) {
             printf("Error printing the list\n");
         }
     }
+    print_time = seconds_since(&begin);
 
     // Calculate and print the sum of the linked list
     if (result == SUCCESS) {
-        result = calc_total(start, &total);
+        clock_gettime(CLOCK_MONOTONIC, &begin);
+        if (options.unrolled) {
+            result = calc_chunks_total(chunks, &total);
+        } else {
+            result = calc_total(start, &total);
+        }
+        total_time = seconds_since(&begin);
         if (result != SUCCESS) {
             printf("Error calculating total\n");
         } else {
@@ -132,18 +429,24 @@ int main(int argc, char *argv[])
     }
 
     // Free up the linked list memory
-    if (start != NULL) {
-        current = start;
-        while (current->next != NULL) {
-            current = current->next;
-            free(start);
-            start = current; //the new head is now the next node
-        }
-    free(current);
-    current = NULL;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    free_list(start);
+    free_chunks(chunks);
+    start  = NULL;
+    chunks = NULL;
+    free_time = seconds_since(&begin);
+    stop_workers();
+
+    if ((result == SUCCESS) && options.timing) {
+        printf("%d values in a%s list from %s: build %.3f s, "
+               "print %.3f s, total %.3f s on %d thread%s, free %.3f s, "
+               "max RSS %ld KiB\n", num,
+               options.unrolled ? "n unrolled" : "",
+               options.use_malloc ? "malloc" : "the pool",
+               build_time, print_time, total_time, options.threads,
+               (options.threads == 1) ? "" : "s", free_time, max_rss());
     }
-    start = NULL;
-    
+
     return result;
 } // end main
 
@@ -157,38 +460,130 @@ int main(int argc, char *argv[])
 //         The value passed to main
 // Outputs:
 //     num
-//         The number indicated by the string input by the user in
-//         argv[ARGV_NUMBER].
+//         The number indicated by the string input by the user after
+//         the options.
+//     options
+//         The options the user gave.
 //     function result:
 //         An indicator of success or failure. A success is a zero,
 //         while a failure is any other value.
 // Description:
 //     This function verifies that the user provided good input. If so,
-//     it returns the integer equivalent of argv[ARGV_NUMBER].
+//     it returns the options and the integer equivalent of the number.
 // ---------------------------------------------------------------------
-int get_input(int argc, char *argv[], int *num){
+int get_input(int argc, char *argv[], int *num, options_t *options){
     errno = 0; //for strtol call
     char *endnum = NULL; //for strtol call
     int result = SUCCESS; //default success
+    long max_number = MAX_NUMBER;
+    int opt;
 
-    //handle bad input cases - bad arg count/wrong args/invalid number
-    if (argc != VALID_NUM_ARGS) {
-        printf("You may only enter two arguments: ./randadd <number>.\n");
+    memset(options, 0, sizeof(*options));
+    options->threads = 1;
+    options->every   = 1;
+    *num = 0;
+    while ((opt = getopt(argc, argv, OPTIONS)) != -1) {
+        switch (opt) {
+        case 'l':
+            options->large = true;
+            max_number = MAX_LARGE_NUMBER;
+            break;
+        case 'm':
+            options->use_malloc = true;
+            break;
+        case 'q':
+            options->quiet = true;
+            break;
+        case 't':
+            options->timing = true;
+            break;
+        case 'u':
+            options->unrolled = true;
+            break;
+        case 'b':
+            options->bench = true;
+            break;
+        case 's':
+            options->segments = true;
+            break;
+        case 'r':
+            options->shuffle = true;
+            break;
+        case 'n':
+            options->naive = true;
+            break;
+        case 'f':
+            options->stream = true;
+            break;
+        case 'w':
+            options->use_printf = true;
+            break;
+        case 'e':
+            options->every = atoi(optarg);
+            if (options->every < 1) {
+                printf("Please print every 1st value or fewer.\n");
+                result = BAD_INPUT;
+            }
+            break;
+        case 'p':
+            options->threads = atoi(optarg);
+            if ((options->threads < 1) || (options->threads > MAX_THREADS)) {
+                printf("Please enter between 1-%d threads.\n", MAX_THREADS);
+                result = BAD_INPUT;
+            }
+            break;
+        default:
+            result = BAD_INPUT;
+            break;
+        }
+    }
+
+    if (options->unrolled && (options->segments || options->shuffle)) {
+        printf("An unrolled list can not have an index of segments "
+               "or be linked in a random order.\n");
+        result = BAD_INPUT;
+    }
+    if ((options->threads > 1) && !options->segments && !options->stream) {
+        printf("Only an index of segments can be added up on threads, "
+               "so -p needs -s.\n");
+        result = BAD_INPUT;
+    }
+    if (options->stream && (options->unrolled || options->segments ||
+                            options->shuffle || options->use_malloc ||
+                            (options->threads > 1))) {
+        printf("Streaming keeps no list, so it can not be unrolled, have "
+               "an index of segments, be linked in a random order, be "
+               "malloc'd or be added up on threads.\n");
         result = BAD_INPUT;
+    }
+    if (options->bench && options->segments && (options->threads == 1)) {
+        options->threads = BENCH_THREADS;
+    }
+
+    //the benchmark picks its own sizes
+    if (options->bench && (argc == optind) && (result == SUCCESS)) {
+        return SUCCESS;
+    }
+
+    //handle bad input cases - bad arg count/wrong args/invalid number
+    if (argc - optind != VALID_NUM_ARGS - 1) {
+        printf("You may only enter two arguments: ./randadd [-flmnqrstuw] [-e every] [-p threads] <number>.\n");
+        return BAD_INPUT;
     } 
     if (strcmp(VALID_EXECUTABLE,argv[ARGV_PROGRAM]) != 0) {
         printf("You have entered the wrong executable file into the command line.\n");
         result = BAD_INPUT;
     } 
     //the user has inputed the correct arguments, now process the input they have entered
-    long converted_input = strtol(argv[ARGV_NUMBER], &endnum, BASE_10);
-    if (errno != 0 || *endnum != '\0' || argv[ARGV_NUMBER] == endnum ) { 
+    long converted_input = strtol(argv[optind], &endnum, BASE_10);
+    if (errno != 0 || *endnum != '\0' || argv[optind] == endnum ) { 
         //handle strtol errors
         printf("You have entered an invalid argument for the second argument, enter an integer.\n");
         result = BAD_INPUT;
     } 
-    if (converted_input < MIN_NUMBER || converted_input > MAX_NUMBER) {
-        printf("Please enter a number between 1-42 inclusive.\n");
+    if (converted_input < MIN_NUMBER || converted_input > max_number) {
+        printf("Please enter a number between %d-%ld inclusive.\n",
+               MIN_NUMBER, max_number);
         result = BAD_INPUT;
     }
     //all validating complete, now pass by reference to the caller and cast as an int
@@ -202,142 +597,1407 @@ int get_input(int argc, char *argv[], int *num){
 
 // ---------------------------------------------------------------------
 // Function:
-//     print_list
+//     pool_alloc
 // Inputs:
-//     start
-//         A pointer to the start of a linked list.
+//     size
+//         The size of the object wanted, at most FIRST_SLAB.
+//     align
+//         Its alignment, a power of two no more than CACHE_LINE.
 // Outputs:
 //     function result:
-//         An indicator of success or failure. A success is a zero,
-//         while a failure is any other value.
+//         The object, or NULL (with errno set) if there is no memory
+//         for it.
 // Description:
-//     This function walks through the linked list, printing out each
-//     value in the list.
+//     This function hands out the next object of the newest slab of the
+//     pool, and allocates a new slab, twice as big as the last one (up
+//     to MAX_SLAB bytes), when that one is used up.
 // ---------------------------------------------------------------------
-int print_list(value_t *start)
+void *pool_alloc(const size_t size, const size_t align)
 {
-    value_t *current = start; //start from the first node in the list
+    slab_t *slab = Pool.slabs;
+    size_t used  = (Pool.used + align - 1) & ~(align - 1);
 
-    int result = SUCCESS;
+    if ((slab == NULL) || (used + size > slab->size)) {
+        size_t bytes = (slab == NULL) ? FIRST_SLAB : slab->size * 2;
 
-    if (start == NULL) {
-        result = BAD_INPUT;
-    } else {
-        int count = 1;
-        printf("\n"); // for formatting
-        while (current != NULL) {
-            //print current node in red as a random num right justified
-            printf(RESET_COLOR "Value %2d = " RED_TEXT "%2d\n",count,current->val);
-            current = current->next; //traversing the linked list
-            count ++;
+        if (bytes > MAX_SLAB) {
+            bytes = MAX_SLAB;
         }
-        printf(RESET_COLOR); //reset color after printing out the values
+        slab = aligned_alloc(CACHE_LINE, sizeof(slab_t) + bytes);
+        if (slab == NULL) {
+            return NULL;
+        }
+        slab->next = Pool.slabs;
+        slab->size = bytes;
+        Pool.slabs = slab;
+        used       = 0;
     }
 
-    return result;
-} // end print_list
+    Pool.used = used + size;
+    return &slab->bytes[used];
+} // end pool_alloc
 
 
 
 // ---------------------------------------------------------------------
 // Function:
-//     calc_total
+//     free_pool
+// Inputs:
+//     none
+// Outputs:
+//     none
+// Description:
+//     This function frees the slabs of the pool, and so every object
+//     handed out of it, a handful of frees however many objects there
+//     are.
+// ---------------------------------------------------------------------
+void free_pool(void)
+{
+    while (Pool.slabs != NULL) {
+        slab_t *slab = Pool.slabs;
+
+        Pool.slabs = slab->next;
+        free(slab);
+    }
+    Pool.used = 0;
+} // end free_pool
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     new_value
+// Inputs:
+//     none
+// Outputs:
+//     function result:
+//         A new value_t object, or NULL (with errno set) if there is no
+//         memory for one.
+// Description:
+//     This function takes the object from the pool, or, with
+//     Pool.use_malloc set, mallocs it on its own.
+// ---------------------------------------------------------------------
+value_t *new_value(void)
+{
+    if (Pool.use_malloc) {
+        return malloc(sizeof(value_t));
+    }
+
+    return pool_alloc(sizeof(value_t), _Alignof(value_t));
+} // end new_value
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     new_chunk
+// Inputs:
+//     none
+// Outputs:
+//     function result:
+//         A new chunk_t object, or NULL (with errno set) if there is no
+//         memory for one.
+// Description:
+//     This function takes the object from the pool, or, with
+//     Pool.use_malloc set, allocates it on its own.
+// ---------------------------------------------------------------------
+chunk_t *new_chunk(void)
+{
+    if (Pool.use_malloc) {
+        return aligned_alloc(CACHE_LINE, sizeof(chunk_t));
+    }
+
+    return pool_alloc(sizeof(chunk_t), _Alignof(chunk_t));
+} // end new_chunk
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     free_list
 // Inputs:
 //     start
-//         A pointer to the start of a linked list.
+//         A pointer to the start of a linked list, or NULL.
+// Outputs:
+//     none
+// Description:
+//     This function releases the list and its index of segments.
+//     Objects from the pool are not freed one by one: the whole pool
+//     is, along with any other list taken from it. With Pool.use_malloc
+//     set, it walks the list freeing each object.
+// ---------------------------------------------------------------------
+void free_list(value_t *start)
+{
+    value_t *current;
+    walk_t walk;
+
+    free(Segments.heads);
+    Segments.heads = NULL;
+    Segments.count = 0;
+    Segments.size  = 0;
+    if (!Pool.use_malloc) {
+        free_pool();
+        return;
+    }
+
+    //the walk has moved on from each object before it is freed
+    walk_start(&walk, start);
+    while ((current = walk_next(&walk)) != NULL) {
+        free(current);
+    }
+} // end free_list
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     free_chunks
+// Inputs:
+//     start
+//         A pointer to the start of an unrolled list, or NULL.
+// Outputs:
+//     none
+// Description:
+//     This function releases the unrolled list as free_list() does a
+//     linked list.
+// ---------------------------------------------------------------------
+void free_chunks(chunk_t *start)
+{
+    chunk_t *current = start;
+
+    if (!Pool.use_malloc) {
+        free_pool();
+        return;
+    }
+
+    while (current != NULL) {
+        current = current->next;
+        free(start);
+        start = current;
+    }
+} // end free_chunks
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     seconds_since
+// Inputs:
+//     start
+//         A time from CLOCK_MONOTONIC.
+// Outputs:
+//     function result:
+//         The seconds since then.
+// ---------------------------------------------------------------------
+double seconds_since(const struct timespec *start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) +
+           (now.tv_nsec - start->tv_nsec) / NSEC_PER_SEC;
+} // end seconds_since
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     max_rss
+// Inputs:
+//     none
+// Outputs:
+//     function result:
+//         The most memory the program has held so far, in KiB.
+// ---------------------------------------------------------------------
+long int max_rss(void)
+{
+    struct rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return -1;
+    }
+
+    return usage.ru_maxrss;
+} // end max_rss
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     print_start
+// Inputs:
+//     none
+// Outputs:
+//     none
+// Description:
+//     This function starts printing values: it prints the blank line
+//     before them and flushes stdout, so the output module's writes
+//     come after everything printed so far.
+// ---------------------------------------------------------------------
+void print_start(void)
+{
+    printf("\n"); // for formatting
+    fflush(stdout);
+} // end print_start
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     print_value
+// Inputs:
+//     count
+//         The place of the value in the list, from 1.
+//     val
+//         The value.
+// Outputs:
+//     none
+// Description:
+//     This function prints the value in red, right justified, with the
+//     output module, or with printf if Use_printf is set.
+// ---------------------------------------------------------------------
+void print_value(const long int count, const int val)
+{
+    if (Use_printf) {
+        printf(RESET_COLOR "Value %2ld = " RED_TEXT "%2d\n", count, val);
+        return;
+    }
+
+    out_color(OUT_RESET);
+    out_text("Value ", sizeof("Value ") - 1);
+    out_uint(count, COUNT_WIDTH);
+    out_text(" = ", sizeof(" = ") - 1);
+    out_color(OUT_RED);
+    out_uint(val, VALUE_WIDTH);
+    out_char('\n');
+} // end print_value
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     print_end
+// Inputs:
+//     none
 // Outputs:
-//     total:
-//         The total of all values in the input linked list.
 //     function result:
 //         An indicator of success or failure. A success is a zero,
 //         while a failure is any other value.
 // Description:
-//     Given the linked list passed as input, this function will calculate
-//     the total of each value within the list.
+//     This function resets the color after the values, and writes out
+//     what the output module still holds, so stdio may print again.
 // ---------------------------------------------------------------------
-int calc_total(value_t *start, long int *total)
+int print_end(void)
 {
-    int result = SUCCESS;
-    value_t *current = start; //start from first node in the linked list
-    int count = 0; //initialize count with value in first node
+    if (Use_printf) {
+        printf(RESET_COLOR);
+        return SUCCESS;
+    }
 
-    if (start == NULL) {
-        result = BAD_INPUT;
-    } else {
-        while (current != NULL) {
-            count += current->val; //accessing the val at that given node and adding to total
-            current =  current->next; //traverse to the next node
-        }
-    
-    *total = (long int)count;
-    // provide the total back to main
+    out_color(OUT_RESET);
+    if (out_flush() != SUCCESS) {
+        perror("Unable to print the values");
+        return WRITE_ERROR;
     }
-    return result;
-} // end calc_total
+
+    return SUCCESS;
+} // end print_end
 
 
 
 // ---------------------------------------------------------------------
 // Function:
-//     build_list
+//     stream_total
 // Inputs:
 //     num
-//         A number indicating how many objects need to be created
-//         in a linked list.
-//     start
-//         A pointer to memory that shall be used as the start of
-//         the linked list.
+//         How many random values to make.
+//     print
+//         Whether to print them, as print_list() would.
 // Outputs:
+//     total:
+//         The total of the values.
 //     function result:
 //         An indicator of success or failure. A success is a zero,
 //         while a failure is any other value.
 // Description:
-//     This function creates a linked list of value_t objects. The
-//     number of objects to create is given as an input 'num'. In
-//     addition, this function initializes the 'val' member of each
-//     struct to a random integer in the range provided by MAX_VALUE.
+//     This function makes the values as build_list() does, but adds
+//     each up and prints it at once, and keeps none of them.
 // ---------------------------------------------------------------------
-int build_list(const int num, value_t *start)
+int stream_total(const int num, const bool print, long int *total)
 {
-    int result = SUCCESS;
-    unsigned int i;
-    value_t *last = NULL;
-    value_t *new  = NULL;
+    long int count = 0;
 
-    // verify passed pointer is valid
-    if (start == NULL) {
-        printf("Error: unexpected NULL pointer in build_list\n");
-        result = BAD_POINTER;
-    } else {    // we have a valid starting pointer
-        // seed the random number generator
-        srandom(time(NULL) * getpid());
+    // seed the random number generator
+    srandom(time(NULL) * getpid());
 
-        // initialize the initial struct
-        start->val  = (random() % MAX_VALUE) + 1;
-        start->next = NULL;
+    if (print) {
+        print_start();
+    }
+    //count from 0, as counting to num would overflow at INT_MAX
+    for (int i = 0; i < num; ++i) {
+        int val = (random() % MAX_VALUE) + 1;
 
-        // allocate additional structs and link them together
-        for (i=1, last=start; i < num; ++i) {
-            errno = SUCCESS;
-            new = malloc(sizeof(value_t));
-            if (new == NULL) {
-                if (errno == SUCCESS) {
-                    printf("Unexpected problem allocating memory.\n");
-                    result = MALLOC_ERROR;
-                } else {
-                    perror("Memory allocation error");
-                    result = errno;
-                }
-                break;
-            }
-            new->val   = (random() % MAX_VALUE) + 1;
-            new->next  = NULL;
-            last->next = new;
-            last       = new;
+        count += val;
+        if (print && ((i + 1L) % Print_every == 0)) {
+            print_value(i + 1L, val);
         }
     }
+    *total = count;
 
-    return result;
+    return print ? print_end() : SUCCESS;
+} // end stream_total
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     add_segment
+// Inputs:
+//     head
+//         The first object of a segment of the list being built.
+// Outputs:
+//     function result:
+//         An indicator of success or failure. A success is a zero,
+//         while a failure is any other value.
+// Description:
+//     This function adds the segment to the index, when there is one,
+//     making the index twice as big when it is full.
+// ---------------------------------------------------------------------
+int add_segment(value_t *head)
+{
+    if (!Segments.enabled) {
+        return SUCCESS;
+    }
+    if (Segments.count == Segments.size) {
+        int size = (Segments.size == 0) ? FIRST_SEGMENTS : Segments.size * 2;
+        value_t **heads = realloc(Segments.heads, size * sizeof(*heads));
+
+        if (heads == NULL) {
+            printf("malloc error when adding a segment\n");
+            return MALLOC_ERROR;
+        }
+        Segments.heads = heads;
+        Segments.size  = size;
+    }
+    Segments.heads[Segments.count++] = head;
+
+    return SUCCESS;
+} // end add_segment
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     sum_segments
+// Inputs:
+//     first
+//         The first segment to add up.
+//     count
+//         How many segments to add up.
+// Outputs:
+//     function result:
+//         The total of their values.
+// Description:
+//     Each segment runs from its head to the head of the next one, or
+//     to the end of the list.
+// ---------------------------------------------------------------------
+long int sum_segments(const int first, const int count)
+{
+    long int total = 0;
+
+    for (int s = first; s < first + count; ++s) {
+        value_t *end = (s + 1 < Segments.count) ? Segments.heads[s + 1] : NULL;
+        value_t *current;
+        walk_t walk;
+
+        walk_start(&walk, Segments.heads[s]);
+        while ((current = walk_next(&walk)) != end) {
+            total += current->val;
+        }
+    }
+
+    return total;
+} // end sum_segments
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     run_worker
+// Inputs:
+//     arg
+//         The worker.
+// Outputs:
+//     function result:
+//         NULL
+// Description:
+//     The thread function of workers 1 and on: each round, it adds up
+//     its share of the segments and reports that it is done.
+// ---------------------------------------------------------------------
+void *run_worker(void *arg)
+{
+    worker_t *worker = arg;
+    unsigned int round = 0;
+
+    pthread_mutex_lock(&Team.lock);
+    for (;;) {
+        while (!Team.stop && (Team.round == round)) {
+            pthread_cond_wait(&Team.go, &Team.lock);
+        }
+        if (Team.stop) {
+            break;
+        }
+        round = Team.round;
+        pthread_mutex_unlock(&Team.lock);
+
+        worker->total = sum_segments(worker->first, worker->count);
+
+        pthread_mutex_lock(&Team.lock);
+        if (--Team.busy == 0) {
+            pthread_cond_signal(&Team.done);
+        }
+    }
+    pthread_mutex_unlock(&Team.lock);
+
+    return NULL;
+} // end run_worker
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     start_workers
+// Inputs:
+//     threads
+//         How many threads calc_total shall use, from 1 to MAX_THREADS.
+// Outputs:
+//     function result:
+//         An indicator of success or failure. A success is a zero,
+//         while a failure is any other value.
+// Description:
+//     This function starts the threads after the first, which wait for
+//     calc_total to give them work until stop_workers() is called.
+// ---------------------------------------------------------------------
+int start_workers(const int threads)
+{
+    Team.round = 0;
+    Team.stop  = false;
+    for (Team.threads = 1; Team.threads < threads; ++Team.threads) {
+        if (pthread_create(&Workers[Team.threads].thread, NULL, run_worker,
+                           &Workers[Team.threads]) != 0) {
+            perror("pthread_create");
+            stop_workers();
+            return BAD_INPUT;
+        }
+    }
+
+    return SUCCESS;
+} // end start_workers
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     stop_workers
+// Inputs:
+//     none
+// Outputs:
+//     none
+// Description:
+//     This function stops the threads start_workers() started, leaving
+//     calc_total to add up lists by itself.
+// ---------------------------------------------------------------------
+void stop_workers(void)
+{
+    pthread_mutex_lock(&Team.lock);
+    Team.stop = true;
+    pthread_cond_broadcast(&Team.go);
+    pthread_mutex_unlock(&Team.lock);
+
+    for (int t = 1; t < Team.threads; ++t) {
+        pthread_join(Workers[t].thread, NULL);
+    }
+    Team.threads = 1;
+} // end stop_workers
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     print_list
+// Inputs:
+//     start
+//         A pointer to the start of a linked list.
+// Outputs:
+//     function result:
+//         An indicator of success or failure. A success is a zero,
+//         while a failure is any other value.
+// Description:
+//     This function walks through the linked list, printing out each
+//     value in the list, or each Print_every-th.
+// ---------------------------------------------------------------------
+int print_list(value_t *start)
+{
+    value_t *current;
+    walk_t walk;
+
+    int result = SUCCESS;
+
+    if (start == NULL) {
+        result = BAD_INPUT;
+    } else {
+        long int count = 1; //a long, as it passes INT_MAX after the last value
+        print_start();
+        walk_start(&walk, start); //start from the first node in the list
+        while ((current = walk_next(&walk)) != NULL) {
+            //print current node in red as a random num right justified
+            if (count % Print_every == 0) {
+                print_value(count, current->val);
+            }
+            count ++;
+        }
+        result = print_end(); //reset color after printing out the values
+    }
+
+    return result;
+} // end print_list
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     calc_total
+// Inputs:
+//     start
+//         A pointer to the start of a linked list.
+// Outputs:
+//     total:
+//         The total of all values in the input linked list.
+//     function result:
+//         An indicator of success or failure. A success is a zero,
+//         while a failure is any other value.
+// Description:
+//     Given the linked list passed as input, this function will calculate
+//     the total of each value within the list. If the list has an index
+//     of segments and there are workers, its segments are shared out
+//     between them, as evenly as they can be, and their sums added up.
+// ---------------------------------------------------------------------
+int calc_total(value_t *start, long int *total)
+{
+    int result = SUCCESS;
+    value_t *current;
+    walk_t walk;
+    long int count = 0; //a long, as lists of -l overflow an int
+
+    if (start == NULL) {
+        result = BAD_INPUT;
+    } else if ((Team.threads > 1) && (Segments.count > 0) &&
+               (Segments.heads[0] == start)) {
+        int threads = Team.threads;
+
+        for (int t = 0; t < threads; ++t) {
+            Workers[t].count = Segments.count / threads +
+                               (t < Segments.count % threads);
+            Workers[t].first = (t == 0) ? 0
+                               : Workers[t - 1].first + Workers[t - 1].count;
+        }
+
+        // start the round, take worker 0's share, and wait for the rest
+        pthread_mutex_lock(&Team.lock);
+        Team.busy = threads - 1;
+        ++Team.round;
+        pthread_cond_broadcast(&Team.go);
+        pthread_mutex_unlock(&Team.lock);
+
+        Workers[0].total = sum_segments(Workers[0].first, Workers[0].count);
+
+        pthread_mutex_lock(&Team.lock);
+        while (Team.busy > 0) {
+            pthread_cond_wait(&Team.done, &Team.lock);
+        }
+        pthread_mutex_unlock(&Team.lock);
+
+        for (int t = 0; t < threads; ++t) {
+            count += Workers[t].total;
+        }
+        *total = count;
+    } else {
+        walk_start(&walk, start); //start from first node in the linked list
+        while ((current = walk_next(&walk)) != NULL) {
+            count += current->val; //accessing the val at that given node and adding to total
+        }
+    
+    *total = count;
+    // provide the total back to main
+    }
+    return result;
+} // end calc_total
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     walk_start
+// Inputs:
+//     start
+//         A pointer to the start of a linked list, or NULL.
+// Outputs:
+//     walk
+//         A walk along the list, from its start.
+// ---------------------------------------------------------------------
+static inline void walk_start(walk_t *walk, value_t *start)
+{
+    walk->current = start;
+} // end walk_start
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     walk_next
+// Inputs:
+//     walk
+//         A walk along a linked list.
+// Outputs:
+//     function result:
+//         The next object of the list, or NULL at its end.
+// Description:
+//     This function moves the walk on to the object after the one it
+//     returns, so the caller may free that one. Unless Prefetch is
+//     off, it asks for the object PREFETCH_DISTANCE further on to be
+//     fetched into the cache meanwhile; prefetching NULL does nothing.
+// ---------------------------------------------------------------------
+static inline value_t *walk_next(walk_t *walk)
+{
+    value_t *current = walk->current;
+
+    if (current != NULL) {
+        if (Prefetch) {
+            __builtin_prefetch(current->jump);
+        }
+        walk->current = current->next;
+    }
+
+    return current;
+} // end walk_next
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     set_jumps
+// Inputs:
+//     start
+//         A pointer to the start of a linked list.
+// Outputs:
+//     none
+// Description:
+//     This function points each object of the list at the object
+//     PREFETCH_DISTANCE further on, keeping the last PREFETCH_DISTANCE
+//     objects it passed in a ring. The last objects jump to NULL.
+// ---------------------------------------------------------------------
+void set_jumps(value_t *start)
+{
+    value_t *behind[PREFETCH_DISTANCE] = { NULL };
+    unsigned int i = 0;
+
+    for (value_t *current = start; current != NULL;
+         current = current->next, ++i) {
+        value_t **ring = &behind[i % PREFETCH_DISTANCE];
+
+        if (*ring != NULL) {
+            (*ring)->jump = current;
+        }
+        current->jump = NULL;
+        *ring = current;
+    }
+} // end set_jumps
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     shuffle_list
+// Inputs:
+//     num
+//         The number of objects in the list.
+//     start
+//         A pointer to the start of the linked list.
+// Outputs:
+//     function result:
+//         An indicator of success or failure. A success is a zero,
+//         while a failure is any other value.
+// Description:
+//     This function links the objects of the list again in a random
+//     order, keeping start first, so that walking the list jumps all
+//     over memory, as a list built on a fragmented heap does. The index
+//     of segments and the jump pointers are made again to match.
+// ---------------------------------------------------------------------
+int shuffle_list(const int num, value_t *start)
+{
+    int result = SUCCESS;
+    value_t **order = malloc(num * sizeof(*order));
+    value_t *current = start;
+
+    if (order == NULL) {
+        printf("malloc error when shuffling the list\n");
+        return MALLOC_ERROR;
+    }
+
+    for (int i = 0; i < num; ++i, current = current->next) {
+        order[i] = current;
+    }
+    for (int i = num - 1; i > 1; --i) {
+        int j = 1 + random() % i;       // Fisher-Yates, after start
+        value_t *swap = order[i];
+
+        order[i] = order[j];
+        order[j] = swap;
+    }
+
+    Segments.count = 0;
+    for (int i = 0; (i < num) && (result == SUCCESS); ++i) {
+        order[i]->next = (i + 1 < num) ? order[i + 1] : NULL;
+        if (i % SEGMENT_VALUES == 0) {
+            result = add_segment(order[i]);
+        }
+    }
+    set_jumps(start);
+    free(order);
+
+    return result;
+} // end shuffle_list
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     build_list
+// Inputs:
+//     num
+//         A number indicating how many objects need to be created
+//         in a linked list.
+//     start
+//         A pointer to memory that shall be used as the start of
+//         the linked list.
+// Outputs:
+//     function result:
+//         An indicator of success or failure. A success is a zero,
+//         while a failure is any other value.
+// Description:
+//     This function creates a linked list of value_t objects, taken
+//     from the pool with new_value(). The
+//     number of objects to create is given as an input 'num'. In
+//     addition, this function initializes the 'val' member of each
+//     struct to a random integer in the range provided by MAX_VALUE.
+//     With Segments.enabled set, it records every SEGMENT_VALUES-th
+//     object in the index of segments. Last, it sets the jump pointers
+//     of the list.
+// ---------------------------------------------------------------------
+int build_list(const int num, value_t *start)
+{
+    int result = SUCCESS;
+    unsigned int i;
+    value_t *last = NULL;
+    value_t *new  = NULL;
+
+    // verify passed pointer is valid
+    if (start == NULL) {
+        printf("Error: unexpected NULL pointer in build_list\n");
+        result = BAD_POINTER;
+    } else {    // we have a valid starting pointer
+        // seed the random number generator
+        srandom(time(NULL) * getpid());
+
+        // initialize the initial struct
+        start->val  = (random() % MAX_VALUE) + 1;
+        start->next = NULL;
+        start->jump = NULL;
+        Segments.count = 0;     // the index is of this list now
+        result = add_segment(start);
+
+        // allocate additional structs and link them together
+        for (i=1, last=start; (i < num) && (result == SUCCESS); ++i) {
+            errno = SUCCESS;
+            new = new_value();
+            if (new == NULL) {
+                if (errno == SUCCESS) {
+                    printf("Unexpected problem allocating memory.\n");
+                    result = MALLOC_ERROR;
+                } else {
+                    perror("Memory allocation error");
+                    result = errno;
+                }
+                break;
+            }
+            new->val   = (random() % MAX_VALUE) + 1;
+            new->next  = NULL;
+            new->jump  = NULL;
+            last->next = new;
+            last       = new;
+            if (i % SEGMENT_VALUES == 0) {
+                result = add_segment(new);
+            }
+        }
+        set_jumps(start);
+    }
+
+    return result;
 } // end build_list
 
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     build_chunks
+// Inputs:
+//     num
+//         A number indicating how many values the unrolled list holds.
+//     start
+//         A pointer to memory that shall be used as the first object
+//         of the unrolled list.
+// Outputs:
+//     function result:
+//         An indicator of success or failure. A success is a zero,
+//         while a failure is any other value.
+// Description:
+//     This function creates an unrolled list of chunk_t objects, taken
+//     from the pool with new_chunk(), filling each with CHUNK_VALUES
+//     random values, as build_list() does, before starting the next.
+// ---------------------------------------------------------------------
+int build_chunks(const int num, chunk_t *start)
+{
+    int result = SUCCESS;
+    chunk_t *last = start;
+    chunk_t *new  = NULL;
+
+    // verify passed pointer is valid
+    if (start == NULL) {
+        printf("Error: unexpected NULL pointer in build_chunks\n");
+        return BAD_POINTER;
+    }
+
+    // seed the random number generator
+    srandom(time(NULL) * getpid());
+    memset(start, 0, sizeof(*start));
+
+    for (int i = 0; i < num; ++i) {
+        // allocate another struct when the last is full
+        if (last->count == CHUNK_VALUES) {
+            errno = SUCCESS;
+            new = new_chunk();
+            if (new == NULL) {
+                if (errno == SUCCESS) {
+                    printf("Unexpected problem allocating memory.\n");
+                    result = MALLOC_ERROR;
+                } else {
+                    perror("Memory allocation error");
+                    result = errno;
+                }
+                break;
+            }
+            memset(new, 0, sizeof(*new));
+            last->next = new;
+            last       = new;
+        }
+        last->val[last->count++] = (random() % MAX_VALUE) + 1;
+    }
+
+    return result;
+} // end build_chunks
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     print_chunks
+// Inputs:
+//     start
+//         A pointer to the start of an unrolled list.
+// Outputs:
+//     function result:
+//         An indicator of success or failure. A success is a zero,
+//         while a failure is any other value.
+// Description:
+//     This function prints the values of the unrolled list just as
+//     print_list() prints a linked list.
+// ---------------------------------------------------------------------
+int print_chunks(chunk_t *start)
+{
+    chunk_t *current = start;
+    long int count = 1; //a long, as it passes INT_MAX after the last value
+
+    if (start == NULL) {
+        return BAD_INPUT;
+    }
+
+    print_start();
+    while (current != NULL) {
+        for (int i = 0; i < current->count; ++i) {
+            if (count % Print_every == 0) {
+                print_value(count, current->val[i]);
+            }
+            count ++;
+        }
+        current = current->next;
+    }
+
+    return print_end(); //reset color after printing out the values
+} // end print_chunks
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     sum_chunk
+// Inputs:
+//     chunk
+//         An object of an unrolled list.
+// Outputs:
+//     function result:
+//         The sum of its values.
+// Description:
+//     The values that are not used are 0, so all CHUNK_VALUES are
+//     added, four at a time in an SSE2 register where there is one.
+// ---------------------------------------------------------------------
+int sum_chunk(const chunk_t *chunk)
+{
+#ifdef __SSE2__
+    const __m128i *four = (const __m128i *)chunk->val;
+    __m128i sum = _mm_load_si128(&four[0]);
+
+    for (int i = 1; i < CHUNK_VALUES / 4; ++i) {
+        sum = _mm_add_epi32(sum, _mm_load_si128(&four[i]));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+
+    return _mm_cvtsi128_si32(sum);
+#else
+    int sum = 0;
+
+    for (int i = 0; i < CHUNK_VALUES; ++i) {
+        sum += chunk->val[i];
+    }
+
+    return sum;
+#endif
+} // end sum_chunk
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     calc_chunks_total
+// Inputs:
+//     start
+//         A pointer to the start of an unrolled list.
+// Outputs:
+//     total:
+//         The total of all values in the unrolled list.
+//     function result:
+//         An indicator of success or failure. A success is a zero,
+//         while a failure is any other value.
+// Description:
+//     This function adds up the unrolled list an object at a time.
+// ---------------------------------------------------------------------
+int calc_chunks_total(chunk_t *start, long int *total)
+{
+    chunk_t *current = start;
+    long int count = 0;
+
+    if (start == NULL) {
+        return BAD_INPUT;
+    }
+
+    while (current != NULL) {
+        count += sum_chunk(current);
+        current = current->next;
+    }
+    *total = count;
+
+    return SUCCESS;
+} // end calc_chunks_total
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     sum_array
+// Inputs:
+//     values
+//         An array of values from 1 to MAX_VALUE.
+//     num
+//         How many there are.
+// Outputs:
+//     function result:
+//         Their sum.
+// Description:
+//     The benchmark's flat array, added up as fast as it can be: four
+//     values at a time in an SSE2 register, where there is one, in
+//     blocks of ARRAY_BLOCK values whose sums cannot overflow its
+//     32-bit lanes.
+// ---------------------------------------------------------------------
+long int sum_array(const int *values, const int num)
+{
+    long int total = 0;
+    int i = 0;
+
+#ifdef __SSE2__
+    while (i + 4 <= num) {
+        int end = (num - i > ARRAY_BLOCK) ? i + ARRAY_BLOCK : num;
+        __m128i sum = _mm_setzero_si128();
+        int lanes[4];
+
+        for (; i + 4 <= end; i += 4) {
+            sum = _mm_add_epi32(sum,
+                                _mm_loadu_si128((const __m128i *)&values[i]));
+        }
+        _mm_storeu_si128((__m128i *)lanes, sum);
+        total += (long int)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    }
+#endif
+    for (; i < num; ++i) {
+        total += values[i];
+    }
+
+    return total;
+} // end sum_array
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     benchmark
+// Inputs:
+//     none
+// Outputs:
+//     function result:
+//         An indicator of success or failure. A success is a zero,
+//         while a failure is any other value.
+// Description:
+//     This function builds a linked list, an unrolled list and a flat
+//     array of the same number of values, from BENCH_FIRST values up to
+//     BENCH_LAST, and adds up each of them over and over, about
+//     BENCH_VALUES values in all, printing the time it took per value
+//     and the memory each holds. The smallest fit in the L1 cache, the
+//     largest are far larger than the last level cache.
+// ---------------------------------------------------------------------
+int benchmark(void)
+{
+    int result = SUCCESS;
+
+    printf("%10s %10s %10s %10s %10s %10s %10s\n", "values",
+           "list KiB", "list ns", "unrl KiB", "unrl ns",
+           "array KiB", "array ns");
+
+    for (int num = BENCH_FIRST; num <= BENCH_LAST; num *= BENCH_STEP) {
+        int passes = (num < BENCH_VALUES) ? BENCH_VALUES / num : 1;
+        value_t *start = new_value();
+        chunk_t *chunks = new_chunk();
+        int *values = malloc(num * sizeof(int));
+        struct timespec begin;
+        double list_time, chunks_time, array_time;
+        long int list_total = 0, chunks_total = 0, array_total = 0;
+        long int total;
+        bool differ = false;
+
+        if ((start == NULL) || (chunks == NULL) || (values == NULL)) {
+            printf("malloc error when starting the lists\n");
+            result = MALLOC_ERROR;
+        } else {
+            result = build_list(num, start);
+        }
+        if (result == SUCCESS) {
+            result = build_chunks(num, chunks);
+        }
+        if (result != SUCCESS) {
+            free_list(start);
+            free_chunks(chunks);
+            free(values);
+            break;
+        }
+        for (int i = 0; i < num; ++i) {
+            values[i] = (random() % MAX_VALUE) + 1;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &begin);
+        for (int p = 0; p < passes; ++p) {
+            calc_total(start, &total);
+            differ |= (p > 0) && (total != list_total);
+            list_total = total;
+        }
+        list_time = seconds_since(&begin);
+
+        clock_gettime(CLOCK_MONOTONIC, &begin);
+        for (int p = 0; p < passes; ++p) {
+            calc_chunks_total(chunks, &total);
+            differ |= (p > 0) && (total != chunks_total);
+            chunks_total = total;
+        }
+        chunks_time = seconds_since(&begin);
+
+        clock_gettime(CLOCK_MONOTONIC, &begin);
+        for (int p = 0; p < passes; ++p) {
+            total = sum_array(values, num);
+            differ |= (p > 0) && (total != array_total);
+            array_total = total;
+        }
+        array_time = seconds_since(&begin);
+
+        if (differ) {
+            printf("Error: the totals of the passes differ\n");
+            result = BAD_INPUT;
+        }
+
+        printf("%10d %10zu %10.3f %10zu %10.3f %10zu %10.3f\n", num,
+               num * sizeof(value_t) / BYTES_PER_KB,
+               list_time * NSEC_PER_VALUE / ((double)passes * num),
+               (num + CHUNK_VALUES - 1) / CHUNK_VALUES * sizeof(chunk_t) /
+                   BYTES_PER_KB,
+               chunks_time * NSEC_PER_VALUE / ((double)passes * num),
+               num * sizeof(int) / BYTES_PER_KB,
+               array_time * NSEC_PER_VALUE / ((double)passes * num));
+        fflush(stdout);
+
+        free_list(start);
+        free_chunks(chunks);
+        free(values);
+    }
+
+    return result;
+} // end benchmark
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     benchmark_threads
+// Inputs:
+//     threads
+//         The most threads to add up the list on.
+// Outputs:
+//     function result:
+//         An indicator of success or failure. A success is a zero,
+//         while a failure is any other value.
+// Description:
+//     This function builds a list of BENCH_LAST values, with an index
+//     of segments, and adds it up on 1, 2, 4 ... threads, printing the
+//     time it took per value and how much faster it was than on one.
+// ---------------------------------------------------------------------
+int benchmark_threads(const int threads)
+{
+    int result = SUCCESS;
+    int passes = BENCH_VALUES / BENCH_LAST;
+    value_t *start = new_value();
+    long int first = 0;
+    double one = 0;
+
+    if (start == NULL) {
+        printf("malloc error when starting the list\n");
+        return MALLOC_ERROR;
+    }
+    result = build_list(BENCH_LAST, start);
+
+    printf("%d values in %d segments, %zu KiB\n", BENCH_LAST,
+           Segments.count, BENCH_LAST * sizeof(value_t) / BYTES_PER_KB);
+    printf("%10s %10s %10s\n", "threads", "ns", "speedup");
+    for (int t = 1; (t <= threads) && (result == SUCCESS); t *= 2) {
+        struct timespec begin;
+        double seconds;
+        long int total;
+
+        result = start_workers(t);
+        clock_gettime(CLOCK_MONOTONIC, &begin);
+        for (int p = 0; (p < passes) && (result == SUCCESS); ++p) {
+            calc_total(start, &total);
+            if ((t > 1 || p > 0) && (total != first)) {
+                printf("Error: %ld on %d threads, %ld on one\n", total, t,
+                       first);
+                result = BAD_INPUT;
+            }
+            first = total;
+        }
+        seconds = seconds_since(&begin);
+        stop_workers();
+
+        if (t == 1) {
+            one = seconds;
+        }
+        printf("%10d %10.3f %10.2f\n", t,
+               seconds * NSEC_PER_VALUE / ((double)passes * BENCH_LAST),
+               one / seconds);
+        fflush(stdout);
+    }
+
+    free_list(start);
+
+    return result;
+} // end benchmark_threads
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     time_walks
+// Inputs:
+//     start
+//         A pointer to the start of a linked list.
+//     num
+//         The number of values in it.
+// Outputs:
+//     function result:
+//         The ns per value calc_total takes to add it up, over about
+//         BENCH_WALK_VALUES values, or a negative number if the totals
+//         differ.
+// ---------------------------------------------------------------------
+double time_walks(value_t *start, const int num)
+{
+    int passes = (num < BENCH_WALK_VALUES) ? BENCH_WALK_VALUES / num : 1;
+    struct timespec begin;
+    long int first = 0;
+    long int total;
+
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    for (int p = 0; p < passes; ++p) {
+        calc_total(start, &total);
+        if ((p > 0) && (total != first)) {
+            return -1;
+        }
+        first = total;
+    }
+
+    return seconds_since(&begin) * NSEC_PER_VALUE / ((double)passes * num);
+} // end time_walks
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     benchmark_walks
+// Inputs:
+//     none
+// Outputs:
+//     function result:
+//         An indicator of success or failure. A success is a zero,
+//         while a failure is any other value.
+// Description:
+//     This function builds linked lists from BENCH_FIRST values up to
+//     BENCH_LAST, and adds each up without and with prefetching, first
+//     as built, its objects in order in memory, then linked in a
+//     random order, printing the time each walk took per value.
+// ---------------------------------------------------------------------
+int benchmark_walks(void)
+{
+    int result = SUCCESS;
+
+    printf("%10s %10s %10s %10s %10s %10s\n", "values", "list KiB",
+           "in order", "prefetch", "scattered", "prefetch");
+
+    for (int num = BENCH_FIRST; num <= BENCH_LAST; num *= BENCH_STEP) {
+        value_t *start = new_value();
+        double ns[4];
+
+        if (start == NULL) {
+            printf("malloc error when starting the list\n");
+            return MALLOC_ERROR;
+        }
+        result = build_list(num, start);
+        for (int w = 0; (w < 4) && (result == SUCCESS); ++w) {
+            if (w == 2) {
+                result = shuffle_list(num, start);
+            }
+            Prefetch = (w % 2 == 1);
+            ns[w] = time_walks(start, num);
+            if (ns[w] < 0) {
+                printf("Error: the totals of the passes differ\n");
+                result = BAD_INPUT;
+            }
+        }
+        Prefetch = true;
+        free_list(start);
+        if (result != SUCCESS) {
+            break;
+        }
+
+        printf("%10d %10zu %10.3f %10.3f %10.3f %10.3f\n", num,
+               num * sizeof(value_t) / BYTES_PER_KB, ns[0], ns[1], ns[2],
+               ns[3]);
+        fflush(stdout);
+    }
+
+    return result;
+} // end benchmark_walks
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     benchmark_output
+// Inputs:
+//     none
+// Outputs:
+//     function result:
+//         An indicator of success or failure. A success is a zero,
+//         while a failure is any other value.
+// Description:
+//     This function builds a list of BENCH_LINES values and prints it
+//     with print_list(), with printf and with the output module, to
+//     the file BENCH_OUTPUT and to /dev/null, printing the lines
+//     written per second each way. stdout is pointed at the file for
+//     each run, and the time includes flushing it.
+// ---------------------------------------------------------------------
+int benchmark_output(void)
+{
+    static const char *targets[] = { BENCH_OUTPUT, "/dev/null" };
+    int result = SUCCESS;
+    value_t *start = new_value();
+    double rate[2][2];
+    int saved;
+
+    if (start == NULL) {
+        printf("malloc error when starting the list\n");
+        return MALLOC_ERROR;
+    }
+    result = build_list(BENCH_LINES, start);
+    fflush(stdout);
+    saved = dup(STDOUT_FILENO);
+
+    for (int t = 0; (t < 2) && (result == SUCCESS); ++t) {
+        for (int w = 0; (w < 2) && (result == SUCCESS); ++w) {
+            int fd = open(targets[t], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            struct timespec begin;
+
+            if ((fd < 0) || (dup2(fd, STDOUT_FILENO) < 0)) {
+                perror(targets[t]);
+                result = WRITE_ERROR;
+                break;
+            }
+            close(fd);
+
+            Use_printf = (w == 0);
+            clock_gettime(CLOCK_MONOTONIC, &begin);
+            result = print_list(start);
+            fflush(stdout);
+            rate[t][w] = BENCH_LINES / seconds_since(&begin);
+
+            dup2(saved, STDOUT_FILENO);
+        }
+    }
+    close(saved);
+    unlink(BENCH_OUTPUT);
+    free_list(start);
+
+    if (result == SUCCESS) {
+        printf("%d lines of print_list, lines/s\n", BENCH_LINES);
+        printf("%12s %14s %14s %8s\n", "to", "printf", "output", "speedup");
+        for (int t = 0; t < 2; ++t) {
+            printf("%12s %14.0f %14.0f %8.2f\n", targets[t], rate[t][0],
+                   rate[t][1], rate[t][1] / rate[t][0]);
+        }
+    }
+
+    return result;
+} // end benchmark_output
+
 // end randadd.c
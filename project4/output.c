@@ -0,0 +1,261 @@
+// ----------------------------------------------------------------------
+// File: output.c
+//
+// Name: Jonathan Goohs
+//
+// Description: This file implements the output module (see output.h).
+//     Numbers are turned into text two digits at a time, from a table
+//     of the pairs "00" to "99", and the color escapes are kept with
+//     their lengths, so nothing is parsed or measured per line. The
+//     buffer goes to standard output with write(), as few times as it
+//     can be.
+//
+//     project3 and project4 each carry a copy of this file, so that
+//     each builds and tars on its own; the copies must be kept the
+//     same, so a fix to one goes in the other too.
+//
+//Resources:
+//1. write man page
+// ----------------------------------------------------------------------
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include "output.h"
+
+// constants
+#define SUCCESS        0
+#define MAX_DIGITS     20          // of an unsigned long
+#define BASE_100       100
+
+// ----------------------------------------------------------------------
+// ------------------------- G L O B A L S ------------------------------
+// ----------------------------------------------------------------------
+
+// The digits of 0 thru 99, two characters each
+static const char Digit_pairs[2 * BASE_100 + 1] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// The escape of each color, and its length
+static const struct {
+    const char *text;
+    size_t length;
+} Colors[OUT_COLORS] = {
+    [OUT_RESET] = { "\033[0m",  sizeof("\033[0m") - 1 },
+    [OUT_RED]   = { "\033[31m", sizeof("\033[31m") - 1 },
+};
+
+static char Buffer[OUT_BUFFER_SIZE];
+static size_t Used = 0;         // bytes in the buffer
+static int Error = SUCCESS;     // errno of the first write that failed
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     write_all
+// Inputs:
+//     text
+//         The bytes to write to standard output.
+//     length
+//         How many there are.
+// Outputs:
+//     none
+// Description:
+//     This function writes all of the bytes, however many write() calls
+//     it takes, and keeps the errno of a write that fails in Error.
+// ---------------------------------------------------------------------
+static void write_all(const char *text, size_t length)
+{
+    while (length > 0) {
+        ssize_t wrote = write(STDOUT_FILENO, text, length);
+
+        if (wrote < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (Error == SUCCESS) {
+                Error = errno;
+            }
+            return;
+        }
+        text   += wrote;
+        length -= wrote;
+    }
+} // end write_all
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     flush_buffer
+// Inputs:
+//     none
+// Outputs:
+//     none
+// Description:
+//     This function writes out what is in the buffer. A write that fails
+//     stays in Error until out_flush() reports it.
+// ---------------------------------------------------------------------
+static void flush_buffer(void)
+{
+    write_all(Buffer, Used);
+    Used = 0;
+} // end flush_buffer
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     out_flush
+// Inputs:
+//     none
+// Outputs:
+//     function result:
+//         SUCCESS, or the errno of the first write that failed since
+//         the last call.
+// Description:
+//     This function writes out what is in the buffer, and reports any
+//     write that failed since the last call, including those made when
+//     the buffer filled up.
+// ---------------------------------------------------------------------
+int out_flush(void)
+{
+    int result;
+
+    flush_buffer();
+    result = Error;
+    Error  = SUCCESS;
+
+    return result;
+} // end out_flush
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     out_text
+// Inputs:
+//     text
+//         Some text; it need not end in '\0'.
+//     length
+//         How many characters of it to write.
+// Outputs:
+//     none
+// Description:
+//     This function adds the text to the buffer, writing the buffer
+//     out first if it has no room. Text larger than the buffer is
+//     written out at once.
+// ---------------------------------------------------------------------
+void out_text(const char *text, const size_t length)
+{
+    if (Used + length > OUT_BUFFER_SIZE) {
+        flush_buffer();
+    }
+    if (length > OUT_BUFFER_SIZE) {
+        write_all(text, length);
+        return;
+    }
+    memcpy(&Buffer[Used], text, length);
+    Used += length;
+} // end out_text
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     out_string
+// Inputs:
+//     text
+//         A string.
+// Outputs:
+//     none
+// ---------------------------------------------------------------------
+void out_string(const char *text)
+{
+    out_text(text, strlen(text));
+} // end out_string
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     out_char
+// Inputs:
+//     c
+//         A character.
+// Outputs:
+//     none
+// ---------------------------------------------------------------------
+void out_char(const char c)
+{
+    if (Used == OUT_BUFFER_SIZE) {
+        flush_buffer();
+    }
+    Buffer[Used++] = c;
+} // end out_char
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     out_uint
+// Inputs:
+//     value
+//         A whole number.
+//     width
+//         The least number of characters to write it in; it is padded
+//         with spaces on the left, as printf("%*lu") would.
+// Outputs:
+//     none
+// Description:
+//     This function works out the digits from the last, two at a time
+//     while there are two or more left.
+// ---------------------------------------------------------------------
+void out_uint(unsigned long value, const int width)
+{
+    char digits[MAX_DIGITS];
+    char *first = &digits[MAX_DIGITS];
+    size_t length;
+
+    while (value >= BASE_100) {
+        const char *pair = &Digit_pairs[2 * (value % BASE_100)];
+
+        value /= BASE_100;
+        *--first = pair[1];
+        *--first = pair[0];
+    }
+    if (value >= 10) {
+        *--first = Digit_pairs[2 * value + 1];
+        *--first = Digit_pairs[2 * value];
+    } else {
+        *--first = '0' + value;
+    }
+    length = &digits[MAX_DIGITS] - first;
+
+    for (int pad = width - (int)length; pad > 0; --pad) {
+        out_char(' ');
+    }
+    out_text(first, length);
+} // end out_uint
+
+
+
+// ---------------------------------------------------------------------
+// Function:
+//     out_color
+// Inputs:
+//     color
+//         The color for the text that follows.
+// Outputs:
+//     none
+// ---------------------------------------------------------------------
+void out_color(const enum out_color color)
+{
+    out_text(Colors[color].text, Colors[color].length);
+} // end out_color
+
+// end output.c
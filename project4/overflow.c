@@ -15,6 +15,10 @@
 //1. www.scaler.com/topics/c/overflow-and-underflow-in-c/ for overflow checking reference
 //2. stackoverflow.com/questions/18841167/invalid-read-in-valgrind for my read error troubleshooting
 //3. calloc man page
+//
+//The table is printed with the output module (output.h), which formats
+//the numbers itself into a buffer that is written out in one go,
+//rather than with a printf per line.
 //-----------------------
 
 //Libraries
@@ -25,6 +29,7 @@
 #include <unistd.h>
 #include <string.h>
 #include <math.h>
+#include "output.h"
 
 //Constants
 #define VALID_NUM_ARGS 2
@@ -34,8 +39,9 @@
 #define MAX_NUMBER     20
 #define MAX_VALUE      500500500
 #define BASE_10        10
-#define RED_TEXT "\033[31m"
-#define RESET_COLOR "\033[0m"
+#define COUNT_WIDTH    5           // of the columns of the table
+#define VALUE_WIDTH    9
+#define TOTAL_WIDTH    10
 
 //Return Vals
 #define SUCCESS        0
@@ -232,28 +238,42 @@ int print_values(unsigned int value_list[]){
         return result;
     }
 
-    printf("\t Random    Running\n");
-    printf("Count\t  Value\t     Total\n");
-    printf("----- --------- ----------\n");
+    fflush(stdout); //anything printed so far comes first
+    out_string("\t Random    Running\n");
+    out_string("Count\t  Value\t     Total\n");
+    out_string("----- --------- ----------\n");
     //continue looping until you hit null terminator
     while (*value_list != '\0') {
         prev_total = running_total;
         //stores the previous count and updates current value with next item in list
 
+        out_uint(count, COUNT_WIDTH);
+        out_char(' ');
         //check for unsigned int overflow
         if (__UINT32_MAX__ - prev_total < *value_list) {
             //print value that causes the overflow in red
-            printf("%5d %s%9u%s %10u would cause overflow\n",count, RED_TEXT, *value_list, 
-                RESET_COLOR, running_total);
+            out_color(OUT_RED);
+            out_uint(*value_list, VALUE_WIDTH);
+            out_color(OUT_RESET);
+            out_char(' ');
+            out_uint(running_total, TOTAL_WIDTH);
+            out_string(" would cause overflow\n");
         } else {
             running_total += *value_list;
-            printf("%5d %9u %10u\n",count,*value_list,running_total);
-            
+            out_uint(*value_list, VALUE_WIDTH);
+            out_char(' ');
+            out_uint(running_total, TOTAL_WIDTH);
+            out_char('\n');
         }
         //increment place in list and counter postfix
         value_list++;
         count++;
         }
 
+    //write out the table
+    if (out_flush() != SUCCESS) {
+        result = BAD_PRINT;
+    }
+
     return result;
 }
\ No newline at end of file
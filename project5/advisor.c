@@ -0,0 +1,217 @@
+// ----------------------------------------------------------------------
+// File: advisor.c
+//
+// Name: Jonathan Goohs
+//
+// Description: This is the implementation of the ADVISOR module of the
+//     YAHTZEE game. It is fast enough to run on every keypress:
+//
+//     - Once per turn, advisor_turn() has the SOLVER work out the value
+//       of every roll with 0, 1 and 2 rerolls left (about 50 us).
+//     - For the dice on the table, each of the 32 ways to keep them is
+//       priced from its REROLL transition table: the sum, over the
+//       rolls the reroll can end in, of chance times value. Ways that
+//       keep the same multiset are only priced once.
+//
+//     With the table from ./solve loaded, values are expected final
+//     scores of optimal play. Without it, the rest of the game counts
+//     as nothing, and the advice maximizes the current turn only.
+// ----------------------------------------------------------------------
+#include <stdbool.h>
+#include "play.h"
+#include "solver.h"
+#include "advisor.h"
+
+#define ALL_DICE      ((1u << NUMBER_OF_DICE) - 1)
+#define NO_STATE      (~0u)
+
+// **************************************************************************
+// **************************** GLOBAL VARIABLES ****************************
+// **************************************************************************
+
+// The values of the current turn, and the state they were worked out for
+static struct solver_turn_t Plan;
+static unsigned int Plan_used = NO_STATE;
+static int          Plan_upper;
+static int          Plan_total;
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     rank
+// Inputs
+//     suggestion
+//         A new suggestion.
+//     advice
+//         The best suggestions so far, best first.
+//     count, max
+//         How many suggestions there are and may be.
+// Outputs
+//     advice
+//         The suggestion is inserted in order, if it makes the cut.
+//     function result
+//         The new count.
+// ---------------------------------------------------------------------
+static int rank(const struct advice_t *suggestion, struct advice_t advice[],
+                int count, const int max)
+{
+    int i;
+
+    if (count < max) {
+        i = count++;
+    } else if (advice[max - 1].value < suggestion->value) {
+        i = max - 1;
+    } else {
+        return count;
+    }
+    while ((i > 0) && (advice[i - 1].value < suggestion->value)) {
+        advice[i] = advice[i - 1];
+        --i;
+    }
+    advice[i] = *suggestion;
+
+    return count;
+
+}//end rank
+
+
+// **************************************************************************
+// *************************** EXTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     advisor_turn
+// Inputs
+//     used
+//         The items used so far, bit item-1 for each.
+//     upper
+//         The upper section subtotal.
+//     total
+//         The score so far, bonus included.
+// Outputs
+//     none
+// Description
+//     Gets the values of the turn ready. This must be called before
+//     advisor_keeps() and advisor_items(); it only does the work when
+//     the scorecard has changed since the last call.
+// ---------------------------------------------------------------------
+void advisor_turn(const unsigned int used, const int upper, const int total)
+{
+    Plan_total = total;
+    if ((used == Plan_used) && (upper == Plan_upper)) {
+        return;
+    }
+
+    reroll_init();
+    solver_turn(used, upper, &Plan);
+    Plan_used  = used;
+    Plan_upper = upper;
+
+}//end advisor_turn
+
+
+// ---------------------------------------------------------------------
+// Function
+//     advisor_keeps
+// Inputs
+//     values
+//         The dice on the table.
+//     rerolls_left
+//         1 or 2, counting the reroll about to be made.
+//     max
+//         The most suggestions wanted.
+// Outputs
+//     advice
+//         The best ways to keep the dice, best first. Keeping all five
+//         dice means not rolling again.
+//     function result
+//         The number of suggestions.
+// ---------------------------------------------------------------------
+int advisor_keeps(const unsigned char values[], const int rerolls_left,
+                  struct advice_t advice[], const int max)
+{
+    const float *after = Plan.roll_value[rerolls_left - 1];
+    bool priced[REROLL_KEEPS] = { false };
+    int count = 0;
+
+    for (unsigned int mask = 0; mask <= ALL_DICE; ++mask) {
+        unsigned char kept[NUMBER_OF_DICE];
+        struct advice_t suggestion;
+        const short *keys;
+        const float *chances;
+        int outcomes;
+        int size = 0;
+        int keep;
+        double value = 0;
+
+        for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+            if (mask & (1u << i)) {
+                kept[size++] = values[i];
+            }
+        }
+        keep = reroll_keep_of(kept, size);
+        if (priced[keep]) {
+            continue;
+        }
+        priced[keep] = true;
+
+        outcomes = reroll_outcomes(keep, &keys, &chances);
+        for (int i = 0; i < outcomes; ++i) {
+            value += chances[i] * after[keys[i]];
+        }
+
+        suggestion.keep  = mask;
+        suggestion.item  = 0;
+        suggestion.value = Plan_total + value;
+        count = rank(&suggestion, advice, count, max);
+    }
+
+    return count;
+
+}//end advisor_keeps
+
+
+// ---------------------------------------------------------------------
+// Function
+//     advisor_items
+// Inputs
+//     values
+//         The dice on the table.
+//     max
+//         The most suggestions wanted.
+// Outputs
+//     advice
+//         The best unused items to score the dice in now, best first.
+//     function result
+//         The number of suggestions.
+// ---------------------------------------------------------------------
+int advisor_items(const unsigned char values[], struct advice_t advice[],
+                  const int max)
+{
+    int key = scoretab_key(values);
+    int count = 0;
+
+    for (int item = ACES; item <= CHANCE; ++item) {
+        struct advice_t suggestion;
+
+        if (Plan_used & SOLVER_ITEM_BIT(item)) {
+            continue;
+        }
+        suggestion.keep  = ALL_DICE;
+        suggestion.item  = item;
+        suggestion.value = Plan_total +
+                           solver_item_value(Plan_used, Plan_upper, key,
+                                             item);
+        count = rank(&suggestion, advice, count, max);
+    }
+
+    return count;
+
+}//end advisor_items
+
+// end advisor.c
@@ -0,0 +1,30 @@
+// -------------------------------------------------------------------
+// File: advisor.h
+//
+// Name: Jonathan Goohs
+//
+// Description: This is the header file for the ADVISOR module of the
+//     YAHTZEE game. It ranks the ways to keep the current dice, and
+//     the items to score them in, by expected final score.
+// -------------------------------------------------------------------
+#ifndef ADVISOR_H
+#define ADVISOR_H
+
+#define ADVISOR_TOP  3          // # suggestions the game shows
+
+// One suggestion
+struct advice_t {
+    unsigned int keep;          // dice to keep, bit i for die i
+    int          item;          // item to score in, for advisor_items()
+    double       value;         // expected final score
+};
+
+extern void advisor_turn(const unsigned int used, const int upper,
+                         const int total);
+extern int  advisor_keeps(const unsigned char values[],
+                          const int rerolls_left,
+                          struct advice_t advice[], const int max);
+extern int  advisor_items(const unsigned char values[],
+                          struct advice_t advice[], const int max);
+
+#endif
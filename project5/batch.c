@@ -0,0 +1,477 @@
+// ----------------------------------------------------------------------
+// File: batch.c
+//
+// Name: Jonathan Goohs
+//
+// Description: This is the implementation of the BATCH module of the
+//     YAHTZEE game. A SCORETAB lookup scores one hand and item at a
+//     time; here 16 or 32 hands are scored at once, one hand per byte
+//     lane of an SSE2 or AVX2 register, with no table and no branches:
+//
+//         face counts   each die is compared with the face, and the
+//                       all-ones lanes of the matches are added up;
+//                       the same masks, ANDed with the face, add up to
+//                       the upper section scores
+//         of a kind     the largest count, and whether any count is 2
+//         straights     a bit per face showing, tested against the
+//                       masks of the runs (as packed_score() in play.c)
+//
+//     The kernel is written twice, with SSE2 intrinsics (every x86-64
+//     has them) and with AVX2 ones, each compiled for its own target so
+//     the rest of the program still runs on any x86-64; the best one
+//     the CPU supports is picked at run time. (GCC vector extensions,
+//     as in rng.c, were tried first: a 32-byte vector compare is done
+//     a byte at a time without AVX2.) play.c checks every kernel
+//     against the rules for every ordered roll.
+//
+// Resources:
+// 1. Intel Intrinsics Guide
+// 2. GCC manual, "x86 Function Attributes" (target)
+// ----------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <immintrin.h>
+#include "batch.h"
+#include "rng.h"
+#include "score.h"
+#include "scoretab.h"
+
+#define SSE2_LANES        16        // hands to a register
+#define AVX2_LANES        32
+#define BLOCK             AVX2_LANES    // every kernel scores whole blocks
+#define FACE_BIT(f)       (1 << ((f) - 1))
+#define FACES_SM_LOW      0x0F      // 1 2 3 4
+#define FACES_SM_MID      0x1E      // 2 3 4 5
+#define FACES_SM_HIGH     0x3C      // 3 4 5 6
+#define FACES_LG_LOW      0x1F      // 1 2 3 4 5
+#define FACES_LG_HIGH     0x3E      // 2 3 4 5 6
+#define FULL_HOUSE_MOST   3
+#define KIND3_MOST        3
+#define KIND4_MOST        4
+
+#define BENCH_HANDS       (1L << 16)    // hands per batch
+#define BENCH_PASSES      256
+#define BENCH_SEED        0x42
+#define NSEC_PER_SEC      1000000000L
+#define HANDS_PER_MHAND   1e6
+
+// ****  DEFINED TYPES ****
+
+// A kernel: scores hands [0, hands), a multiple of BLOCK for vectors
+typedef void (*batch_kernel_f)(const unsigned char *const dice[],
+                               unsigned char *const scores[],
+                               const long hands);
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     score_table
+// Inputs
+//     dice, hands
+//         The hands.
+// Outputs
+//     scores
+//         Every item of every hand, from the SCORETAB.
+// ---------------------------------------------------------------------
+static void score_table(const unsigned char *const dice[],
+                        unsigned char *const scores[], const long hands)
+{
+    unsigned char values[NUMBER_OF_DICE];
+
+    for (long h = 0; h < hands; ++h) {
+        int key;
+
+        for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+            values[i] = dice[i][h];
+        }
+        key = scoretab_key(values);
+        for (int item = ACES; item <= CHANCE; ++item) {
+            scores[item][h] = scoretab_score(key, item);
+        }
+    }
+
+}//end score_table
+
+
+// ---------------------------------------------------------------------
+// Function
+//     score_sse2
+// Inputs
+//     dice, hands
+//         The hands; hands is a multiple of SSE2_LANES.
+// Outputs
+//     scores
+//         Every item of every hand.
+// Description
+//     The kernel, 16 hands to a register. There is no unsigned byte
+//     compare in SSE2, so "count >= n" is max(count, n) == count.
+// ---------------------------------------------------------------------
+__attribute__((target("sse2")))
+static void score_sse2(const unsigned char *const dice[],
+                       unsigned char *const scores[], const long hands)
+{
+    const __m128i zero = _mm_setzero_si128();
+
+    for (long h = 0; h < hands; h += SSE2_LANES) {
+        __m128i die[NUMBER_OF_DICE];
+        __m128i total = zero;
+        __m128i most  = zero;
+        __m128i pair  = zero;
+        __m128i faces = zero;
+        __m128i small;
+        __m128i large;
+        __m128i mask;
+
+        for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+            die[i] = _mm_loadu_si128((const __m128i *)(dice[i] + h));
+            total  = _mm_add_epi8(total, die[i]);
+        }
+
+        for (int face = ACES; face <= SIXES; ++face) {
+            const __m128i value = _mm_set1_epi8(face);
+            __m128i count  = zero;
+            __m128i points = zero;
+
+            // A match is all ones, so subtracting it counts one
+            for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+                __m128i match = _mm_cmpeq_epi8(die[i], value);
+
+                count  = _mm_sub_epi8(count, match);
+                points = _mm_add_epi8(points, _mm_and_si128(match, value));
+            }
+            _mm_storeu_si128((__m128i *)(scores[face] + h), points);
+
+            most  = _mm_max_epu8(most, count);
+            pair  = _mm_or_si128(pair, _mm_cmpeq_epi8(count,
+                                                      _mm_set1_epi8(2)));
+            faces = _mm_or_si128(faces, _mm_andnot_si128(
+                                     _mm_cmpeq_epi8(count, zero),
+                                     _mm_set1_epi8(FACE_BIT(face))));
+        }
+
+#define SSE2_RUN(run)                                                   \
+        _mm_cmpeq_epi8(_mm_and_si128(faces, _mm_set1_epi8(run)),       \
+                       _mm_set1_epi8(run))
+#define SSE2_AT_LEAST(n)                                                \
+        _mm_cmpeq_epi8(_mm_max_epu8(most, _mm_set1_epi8(n)), most)
+#define SSE2_STORE(item, lanes, score)                                  \
+        _mm_storeu_si128((__m128i *)(scores[item] + h),                 \
+                         _mm_and_si128((lanes), (score)))
+
+        small = _mm_or_si128(_mm_or_si128(SSE2_RUN(FACES_SM_LOW),
+                                          SSE2_RUN(FACES_SM_MID)),
+                             SSE2_RUN(FACES_SM_HIGH));
+        large = _mm_or_si128(SSE2_RUN(FACES_LG_LOW), SSE2_RUN(FACES_LG_HIGH));
+        mask  = _mm_cmpeq_epi8(most, _mm_set1_epi8(FULL_HOUSE_MOST));
+
+        SSE2_STORE(KIND3, SSE2_AT_LEAST(KIND3_MOST), total);
+        SSE2_STORE(KIND4, SSE2_AT_LEAST(KIND4_MOST), total);
+        SSE2_STORE(FULL_HOUSE, _mm_and_si128(mask, pair),
+                   _mm_set1_epi8(SCORE_FULL_HOUSE));
+        SSE2_STORE(STRAIGHT_SM, small, _mm_set1_epi8(SCORE_STRAIGHT_SM));
+        SSE2_STORE(STRAIGHT_LG, large, _mm_set1_epi8(SCORE_STRAIGHT_LG));
+        SSE2_STORE(YAHTZEE,
+                   _mm_cmpeq_epi8(most, _mm_set1_epi8(NUMBER_OF_DICE)),
+                   _mm_set1_epi8(SCORE_YAHTZEE));
+        _mm_storeu_si128((__m128i *)(scores[CHANCE] + h), total);
+
+#undef SSE2_RUN
+#undef SSE2_AT_LEAST
+#undef SSE2_STORE
+    }
+
+}//end score_sse2
+
+
+// ---------------------------------------------------------------------
+// Function
+//     score_avx2
+// Inputs
+//     dice, hands
+//         The hands; hands is a multiple of AVX2_LANES.
+// Outputs
+//     scores
+//         Every item of every hand.
+// Description
+//     score_sse2(), 32 hands to a register.
+// ---------------------------------------------------------------------
+__attribute__((target("avx2")))
+static void score_avx2(const unsigned char *const dice[],
+                       unsigned char *const scores[], const long hands)
+{
+    const __m256i zero = _mm256_setzero_si256();
+
+    for (long h = 0; h < hands; h += AVX2_LANES) {
+        __m256i die[NUMBER_OF_DICE];
+        __m256i total = zero;
+        __m256i most  = zero;
+        __m256i pair  = zero;
+        __m256i faces = zero;
+        __m256i small;
+        __m256i large;
+        __m256i mask;
+
+        for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+            die[i] = _mm256_loadu_si256((const __m256i *)(dice[i] + h));
+            total  = _mm256_add_epi8(total, die[i]);
+        }
+
+        for (int face = ACES; face <= SIXES; ++face) {
+            const __m256i value = _mm256_set1_epi8(face);
+            __m256i count  = zero;
+            __m256i points = zero;
+
+            for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+                __m256i match = _mm256_cmpeq_epi8(die[i], value);
+
+                count  = _mm256_sub_epi8(count, match);
+                points = _mm256_add_epi8(points,
+                                         _mm256_and_si256(match, value));
+            }
+            _mm256_storeu_si256((__m256i *)(scores[face] + h), points);
+
+            most  = _mm256_max_epu8(most, count);
+            pair  = _mm256_or_si256(pair, _mm256_cmpeq_epi8(count,
+                                                   _mm256_set1_epi8(2)));
+            faces = _mm256_or_si256(faces, _mm256_andnot_si256(
+                                        _mm256_cmpeq_epi8(count, zero),
+                                        _mm256_set1_epi8(FACE_BIT(face))));
+        }
+
+#define AVX2_RUN(run)                                                   \
+        _mm256_cmpeq_epi8(_mm256_and_si256(faces, _mm256_set1_epi8(run)), \
+                          _mm256_set1_epi8(run))
+#define AVX2_AT_LEAST(n)                                                \
+        _mm256_cmpeq_epi8(_mm256_max_epu8(most, _mm256_set1_epi8(n)), most)
+#define AVX2_STORE(item, lanes, score)                                  \
+        _mm256_storeu_si256((__m256i *)(scores[item] + h),              \
+                            _mm256_and_si256((lanes), (score)))
+
+        small = _mm256_or_si256(_mm256_or_si256(AVX2_RUN(FACES_SM_LOW),
+                                                AVX2_RUN(FACES_SM_MID)),
+                                AVX2_RUN(FACES_SM_HIGH));
+        large = _mm256_or_si256(AVX2_RUN(FACES_LG_LOW),
+                                AVX2_RUN(FACES_LG_HIGH));
+        mask  = _mm256_cmpeq_epi8(most, _mm256_set1_epi8(FULL_HOUSE_MOST));
+
+        AVX2_STORE(KIND3, AVX2_AT_LEAST(KIND3_MOST), total);
+        AVX2_STORE(KIND4, AVX2_AT_LEAST(KIND4_MOST), total);
+        AVX2_STORE(FULL_HOUSE, _mm256_and_si256(mask, pair),
+                   _mm256_set1_epi8(SCORE_FULL_HOUSE));
+        AVX2_STORE(STRAIGHT_SM, small, _mm256_set1_epi8(SCORE_STRAIGHT_SM));
+        AVX2_STORE(STRAIGHT_LG, large, _mm256_set1_epi8(SCORE_STRAIGHT_LG));
+        AVX2_STORE(YAHTZEE,
+                   _mm256_cmpeq_epi8(most, _mm256_set1_epi8(NUMBER_OF_DICE)),
+                   _mm256_set1_epi8(SCORE_YAHTZEE));
+        _mm256_storeu_si256((__m256i *)(scores[CHANCE] + h), total);
+
+#undef AVX2_RUN
+#undef AVX2_AT_LEAST
+#undef AVX2_STORE
+    }
+
+}//end score_avx2
+
+
+// **************************************************************************
+// *************************** EXTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     batch_supported
+// Inputs
+//     kernel
+//         A way of scoring.
+// Outputs
+//     function result
+//         Whether this CPU can run it.
+// ---------------------------------------------------------------------
+bool batch_supported(const enum batch_kernel_t kernel)
+{
+    switch (kernel) {
+    case BATCH_TABLE:
+        return true;
+    case BATCH_SSE2:
+        return __builtin_cpu_supports("sse2");
+    case BATCH_AVX2:
+        return __builtin_cpu_supports("avx2");
+    default:
+        return false;
+    }
+
+}//end batch_supported
+
+
+// ---------------------------------------------------------------------
+// Function
+//     batch_best
+// Inputs
+//     none
+// Outputs
+//     function result
+//         The fastest kernel this CPU can run.
+// ---------------------------------------------------------------------
+enum batch_kernel_t batch_best(void)
+{
+    int kernel = BATCH_KERNELS - 1;
+
+    while (!batch_supported(kernel)) {
+        --kernel;
+    }
+
+    return kernel;
+
+}//end batch_best
+
+
+// ---------------------------------------------------------------------
+// Function
+//     batch_name
+// Inputs
+//     kernel
+//         A way of scoring.
+// Outputs
+//     function result
+//         Its name.
+// ---------------------------------------------------------------------
+const char *batch_name(const enum batch_kernel_t kernel)
+{
+    static const char *names[BATCH_KERNELS] = { "table", "sse2", "avx2" };
+
+    return ((int)kernel < BATCH_KERNELS) ? names[kernel] : "?";
+
+}//end batch_name
+
+
+// ---------------------------------------------------------------------
+// Function
+//     batch_score
+// Inputs
+//     kernel
+//         The way of scoring; one that batch_supported().
+//     dice
+//         dice[i][h] is die i (1 thru 6) of hand h.
+//     hands
+//         The number of hands.
+// Outputs
+//     scores
+//         scores[item][h] is the score of item (ACES thru CHANCE) for
+//         hand h.
+// Description
+//     The vector kernels score BLOCK hands at a time; the hands left
+//     over are copied into a block padded with dice of 0, which match
+//     no face, and scored as a whole block.
+// ---------------------------------------------------------------------
+void batch_score(const enum batch_kernel_t kernel,
+                 const unsigned char *const dice[],
+                 unsigned char *const scores[], const long hands)
+{
+    static const batch_kernel_f kernels[BATCH_KERNELS] = {
+        score_table, score_sse2, score_avx2
+    };
+    unsigned char tail_dice[NUMBER_OF_DICE][BLOCK];
+    unsigned char tail_scores[SCORETAB_ITEMS][BLOCK];
+    const unsigned char *tail_in[NUMBER_OF_DICE];
+    unsigned char *tail_out[SCORETAB_ITEMS];
+    long whole = (kernel == BATCH_TABLE) ? hands : hands - hands % BLOCK;
+    long rest = hands - whole;
+
+    kernels[kernel](dice, scores, whole);
+    if (rest == 0) {
+        return;
+    }
+
+    memset(tail_dice, 0, sizeof(tail_dice));
+    for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+        memcpy(tail_dice[i], dice[i] + whole, rest);
+        tail_in[i] = tail_dice[i];
+    }
+    for (int item = 0; item < SCORETAB_ITEMS; ++item) {
+        tail_out[item] = tail_scores[item];
+    }
+    kernels[kernel](tail_in, tail_out, BLOCK);
+    for (int item = ACES; item <= CHANCE; ++item) {
+        memcpy(scores[item] + whole, tail_scores[item], rest);
+    }
+
+}//end batch_score
+
+
+// ---------------------------------------------------------------------
+// Function
+//     batch_benchmark
+// Inputs
+//     none
+// Outputs
+//     none
+// Description
+//     Scores a batch of BENCH_HANDS random hands BENCH_PASSES times
+//     with every kernel the CPU supports, and prints hands scored per
+//     second. The sums of the scores are printed so the work can't be
+//     optimized away, and must be the same for every kernel.
+// ---------------------------------------------------------------------
+void batch_benchmark(void)
+{
+    const unsigned char *dice[NUMBER_OF_DICE];
+    unsigned char *scores[SCORETAB_ITEMS];
+    unsigned char *memory;
+    struct rng_t rng;
+    struct timespec start;
+    struct timespec stop;
+
+    scoretab_init();
+    memory = malloc((NUMBER_OF_DICE + SCORETAB_ITEMS) * BENCH_HANDS);
+    if (memory == NULL) {
+        perror("malloc");
+        return;
+    }
+    rng_seed(&rng, BENCH_SEED, 0);
+    rng_dice(&rng, memory, NUMBER_OF_DICE * BENCH_HANDS);
+    for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+        dice[i] = memory + i * BENCH_HANDS;
+    }
+    for (int item = 0; item < SCORETAB_ITEMS; ++item) {
+        scores[item] = memory + (NUMBER_OF_DICE + item) * BENCH_HANDS;
+    }
+
+    printf("\n%i passes x %li hands x %i items, best kernel here %s\n",
+           BENCH_PASSES, BENCH_HANDS, CHANCE, batch_name(batch_best()));
+    printf("%-10s %10s %12s %12s\n", "kernel", "ms", "Mhands/s", "sum");
+    for (int kernel = 0; kernel < BATCH_KERNELS; ++kernel) {
+        long nsec;
+        long sum = 0;
+
+        if (!batch_supported(kernel)) {
+            printf("%-10s %10s\n", batch_name(kernel), "unsupported");
+            continue;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int pass = 0; pass < BENCH_PASSES; ++pass) {
+            batch_score(kernel, dice, scores, BENCH_HANDS);
+            sum += scores[pass % CHANCE + 1][pass];
+        }
+        clock_gettime(CLOCK_MONOTONIC, &stop);
+        nsec = (stop.tv_sec - start.tv_sec) * NSEC_PER_SEC +
+               (stop.tv_nsec - start.tv_nsec);
+        for (int item = ACES; item <= CHANCE; ++item) {
+            for (long h = 0; h < BENCH_HANDS; ++h) {
+                sum += scores[item][h];
+            }
+        }
+        printf("%-10s %10.1f %12.1f %12li\n", batch_name(kernel),
+               nsec / 1e6, (double)BENCH_PASSES * BENCH_HANDS /
+               HANDS_PER_MHAND / (nsec / (double)NSEC_PER_SEC), sum);
+    }
+
+    free(memory);
+
+}//end batch_benchmark
+
+// end batch.c
@@ -0,0 +1,38 @@
+// -------------------------------------------------------------------
+// File: batch.h
+//
+// Name: Jonathan Goohs
+//
+// Description: This is the header file for the BATCH module of the
+//     YAHTZEE game. It scores many hands of five dice at once, every
+//     scorecard item of every hand, for simulations that have whole
+//     arrays of hands to score.
+//
+//     Hands are passed as a structure of arrays: dice[i][h] is die i
+//     of hand h, and the kernel writes scores[item][h] for the items
+//     ACES thru CHANCE (scores[0] is not used).
+// -------------------------------------------------------------------
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdbool.h>
+#include "game.h"
+
+// The ways of scoring a batch
+enum batch_kernel_t {
+    BATCH_TABLE,            // a SCORETAB lookup per hand and item
+    BATCH_SSE2,             // 16 hands at a time in SSE2 registers
+    BATCH_AVX2,             // 32 hands at a time in AVX2 registers
+    BATCH_KERNELS
+};
+
+extern enum batch_kernel_t batch_best(void);
+extern bool        batch_supported(const enum batch_kernel_t kernel);
+extern const char *batch_name(const enum batch_kernel_t kernel);
+extern void        batch_score(const enum batch_kernel_t kernel,
+                               const unsigned char *const dice[],
+                               unsigned char *const scores[],
+                               const long hands);
+extern void        batch_benchmark(void);
+
+#endif
@@ -0,0 +1,425 @@
+// ----------------------------------------------------------------------
+// File: bench.c
+//
+// Name: Jonathan Goohs
+//
+// Description: This measures one build of the YAHTZEE game for the
+//     benchmark matrix of the Makefile (make results.txt). It runs
+//     fixed workloads with the binaries in a build directory, each
+//     several times, and prints one row of the report:
+//
+//         size      the size of yahtzee in bytes
+//         sim       ./sim playing SIM_GAMES greedy games with a fixed
+//                   seed: the median wall time, and the instructions
+//                   it ran in user space
+//         game      ./yahtzee playing a scripted game with a fixed
+//                   seed on a pseudo-terminal: the same figures
+//         start     the time from fork() to the first frame the game
+//                   draws, the median of the runs
+//
+//     Instructions are counted with perf_event_open(), from the exec()
+//     of the workload on; where the kernel does not allow it (e.g. in
+//     a container, or with kernel.perf_event_paranoid > 2) they are
+//     shown as "-".
+//
+// Syntax: ./bench [-r runs] [-n name] dir
+//         ./bench -H
+//     -r  runs of each workload (default 5)
+//     -n  the name of the build in the report (default dir)
+//     -H  print the header of the report instead
+//
+// Resources:
+// 1. perf_event_open man page
+// 2. forkpty man page
+// ----------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <pty.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include "game.h"
+#include "score.h"
+
+#define DEFAULT_RUNS      5
+#define MAX_RUNS          101
+#define SIM_GAMES         "100000"
+#define WORKLOAD_SEED     "1"
+#define GAME_ROWS         24
+#define GAME_COLS         80
+#define SCRIPT_SIZE       256
+#define TIMEOUT_MS        60000     // a workload that hangs is killed
+#define READ_SIZE         4096
+#define NO_COUNT          (-1.0)
+#define NSEC_PER_SEC      1000000000L
+#define NSEC_PER_MSEC     1e6
+#define NSEC_PER_USEC     1e3
+#define PER_MILLION       1e6
+
+// ****  DEFINED TYPES ****
+
+// What one run of a workload measured
+struct bench_run_t {
+    double wall_ns;
+    double first_ns;            // to the first output, pty runs only
+    double instructions;        // NO_COUNT if they could not be counted
+};
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     elapsed
+// Inputs
+//     start
+//         A time from CLOCK_MONOTONIC.
+// Outputs
+//     function result
+//         The nanoseconds since then.
+// ---------------------------------------------------------------------
+static double elapsed(const struct timespec *start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) * NSEC_PER_SEC +
+           (now.tv_nsec - start->tv_nsec);
+
+}//end elapsed
+
+
+// ---------------------------------------------------------------------
+// Function
+//     count_instructions
+// Inputs
+//     pid
+//         A child that has not called exec() yet.
+// Outputs
+//     function result
+//         A counter of the user space instructions of the child and its
+//         threads, from its exec() on, or -1 if there can't be one.
+// ---------------------------------------------------------------------
+static int count_instructions(const pid_t pid)
+{
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.type           = PERF_TYPE_HARDWARE;
+    attr.size           = sizeof(attr);
+    attr.config         = PERF_COUNT_HW_INSTRUCTIONS;
+    attr.disabled       = 1;
+    attr.enable_on_exec = 1;
+    attr.inherit        = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+
+    return syscall(SYS_perf_event_open, &attr, pid, -1, -1, 0);
+
+}//end count_instructions
+
+
+// ---------------------------------------------------------------------
+// Function
+//     run_workload
+// Inputs
+//     dir
+//         The build directory; the workload runs in it.
+//     argv
+//         The workload.
+//     script
+//         The keys to type, or NULL to run it without a terminal.
+// Outputs
+//     run
+//         What was measured.
+//     function result
+//         SUCCESS, or !SUCCESS if the workload failed or hung.
+// Description
+//     The child waits on a pipe until its instruction counter is set
+//     up, then runs the workload. A scripted workload gets a GAME_ROWS
+//     by GAME_COLS pseudo-terminal; its keys are typed once it has
+//     drawn its first frame, and its output is read and thrown away
+//     until it exits.
+// ---------------------------------------------------------------------
+static int run_workload(const char *dir, char *const argv[],
+                        const char *script, struct bench_run_t *run)
+{
+    struct winsize size = { GAME_ROWS, GAME_COLS, 0, 0 };
+    struct timespec start;
+    char buffer[READ_SIZE];
+    int ready[2];
+    int master = -1;
+    int counter;
+    int status;
+    bool hung = false;
+    pid_t pid;
+    long long count;
+
+    run->first_ns = 0;
+    run->instructions = NO_COUNT;
+    if (pipe(ready) < 0) {
+        return !SUCCESS;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pid = (script != NULL) ? forkpty(&master, NULL, NULL, &size) : fork();
+    if (pid < 0) {
+        return !SUCCESS;
+    }
+    if (pid == 0) {
+        char go;
+
+        close(ready[1]);
+        if (script == NULL) {
+            int null = open("/dev/null", O_RDWR);
+
+            dup2(null, STDIN_FILENO);
+            dup2(null, STDOUT_FILENO);
+        }
+        if ((read(ready[0], &go, 1) != 1) || (chdir(dir) < 0)) {
+            _exit(EXIT_FAILURE);
+        }
+        execv(argv[0], argv);
+        _exit(EXIT_FAILURE);
+    }
+
+    // The child may exec() now
+    close(ready[0]);
+    counter = count_instructions(pid);
+    if (write(ready[1], "", 1) != 1) {
+        kill(pid, SIGKILL);
+    }
+    close(ready[1]);
+
+    // Type the keys once the first frame is up, and drain the output
+    if (script != NULL) {
+        struct pollfd poll_fd = { master, POLLIN, 0 };
+        ssize_t got;
+
+        while (poll(&poll_fd, 1, TIMEOUT_MS) > 0) {
+            got = read(master, buffer, sizeof(buffer));
+            if (got <= 0) {
+                break;          // EIO once the game has exited
+            }
+            if (run->first_ns == 0) {
+                run->first_ns = elapsed(&start);
+                if (write(master, script, strlen(script)) < 0) {
+                    break;
+                }
+            }
+        }
+        hung = (poll(&poll_fd, 1, 0) == 0);
+        if (hung) {
+            kill(pid, SIGKILL);
+        }
+    }
+
+    waitpid(pid, &status, 0);
+    run->wall_ns = elapsed(&start);
+    if (master >= 0) {
+        close(master);
+    }
+    if (counter >= 0) {
+        if (read(counter, &count, sizeof(count)) == sizeof(count)) {
+            run->instructions = count;
+        }
+        close(counter);
+    }
+
+    return (!hung && WIFEXITED(status) &&
+            (WEXITSTATUS(status) == EXIT_SUCCESS)) ? SUCCESS : !SUCCESS;
+
+}//end run_workload
+
+
+// ---------------------------------------------------------------------
+// Function
+//     compare
+// Inputs
+//     a, b
+//         Two doubles.
+// Outputs
+//     function result
+//         Their order, for qsort().
+// ---------------------------------------------------------------------
+static int compare(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+
+    return (x > y) - (x < y);
+
+}//end compare
+
+
+// ---------------------------------------------------------------------
+// Function
+//     median
+// Inputs
+//     values, count
+//         Some figures; they are sorted.
+// Outputs
+//     function result
+// ---------------------------------------------------------------------
+static double median(double values[], const int count)
+{
+    qsort(values, count, sizeof(values[0]), compare);
+    return values[count / 2];
+
+}//end median
+
+
+// ---------------------------------------------------------------------
+// Function
+//     measure
+// Inputs
+//     dir, argv, script
+//         The workload, as for run_workload().
+//     runs
+//         How many times to run it.
+// Outputs
+//     wall_ms, first_us, minstructions
+//         The medians of the runs; minstructions is NO_COUNT if the
+//         instructions could not be counted.
+//     function result
+//         SUCCESS, or !SUCCESS if a run failed.
+// ---------------------------------------------------------------------
+static int measure(const char *dir, char *const argv[], const char *script,
+                   const int runs, double *wall_ms, double *first_us,
+                   double *minstructions)
+{
+    struct bench_run_t run;
+    double wall[MAX_RUNS];
+    double first[MAX_RUNS];
+    double instructions[MAX_RUNS];
+
+    for (int r = 0; r < runs; ++r) {
+        if (run_workload(dir, argv, script, &run) != SUCCESS) {
+            fprintf(stderr, "bench: %s in %s failed\n", argv[0], dir);
+            return !SUCCESS;
+        }
+        wall[r] = run.wall_ns;
+        first[r] = run.first_ns;
+        instructions[r] = run.instructions;
+    }
+
+    *wall_ms = median(wall, runs) / NSEC_PER_MSEC;
+    *first_us = median(first, runs) / NSEC_PER_USEC;
+    *minstructions = median(instructions, runs);
+    if (*minstructions != NO_COUNT) {
+        *minstructions /= PER_MILLION;
+    }
+
+    return SUCCESS;
+
+}//end measure
+
+
+// ---------------------------------------------------------------------
+// Function
+//     print_count
+// Inputs
+//     minstructions
+//         Millions of instructions, or NO_COUNT.
+// Outputs
+//     none
+// ---------------------------------------------------------------------
+static void print_count(const double minstructions)
+{
+    if (minstructions == NO_COUNT) {
+        printf(" %10s", "-");
+    } else {
+        printf(" %10.1f", minstructions);
+    }
+
+}//end print_count
+
+
+// **************************************************************************
+// *********************************  MAIN  *********************************
+// **************************************************************************
+
+int main(int argc, char *argv[])
+{
+    static char *sim[] = {
+        "./sim", "-g", SIM_GAMES, "-s", WORKLOAD_SEED, NULL
+    };
+    static char *game[] = { "./yahtzee", "--seed", WORKLOAD_SEED, NULL };
+    char script[SCRIPT_SIZE] = "";
+    char path[PATH_MAX];
+    struct stat status;
+    const char *name = NULL;
+    double sim_ms, game_ms, start_us, unused;
+    double sim_minst, game_minst;
+    int runs = DEFAULT_RUNS;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "r:n:H")) != -1) {
+        switch (opt) {
+        case 'r':
+            runs = atoi(optarg);
+            break;
+        case 'n':
+            name = optarg;
+            break;
+        case 'H':
+            printf("%-16s %9s %9s %10s %9s %10s %9s\n", "build",
+                   "size B", "sim ms", "sim Minst", "game ms", "game Minst",
+                   "start us");
+            return EXIT_SUCCESS;
+        default:
+            fprintf(stderr, "Usage: %s [-r runs] [-n name] dir\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if ((optind != argc - 1) || (runs < 1) || (runs > MAX_RUNS)) {
+        fprintf(stderr, "Usage: %s [-r runs] [-n name] dir\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (name == NULL) {
+        name = argv[optind];
+    }
+    snprintf(path, sizeof(path), "%s/yahtzee", argv[optind]);
+    if (stat(path, &status) < 0) {
+        perror(path);
+        return EXIT_FAILURE;
+    }
+
+    // Roll twice, then score the next item, every turn
+    for (int item = ACES; item <= CHANCE; ++item) {
+        snprintf(script + strlen(script), sizeof(script) - strlen(script),
+                 "r\nr\n%d\n", item);
+    }
+
+    if ((measure(argv[optind], sim, NULL, runs, &sim_ms, &unused,
+                 &sim_minst) != SUCCESS) ||
+        (measure(argv[optind], game, script, runs, &game_ms, &start_us,
+                 &game_minst) != SUCCESS)) {
+        return EXIT_FAILURE;
+    }
+
+    printf("%-16s %9lld %9.1f", name, (long long)status.st_size, sim_ms);
+    print_count(sim_minst);
+    printf(" %9.1f", game_ms);
+    print_count(game_minst);
+    printf(" %9.0f\n", start_us);
+
+    return EXIT_SUCCESS;
+
+}//end main
+
+// end bench.c
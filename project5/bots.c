@@ -0,0 +1,448 @@
+// ----------------------------------------------------------------------
+// File: bots.c
+//
+// Name: Jonathan Goohs
+//
+// Description: This is a load generator for the YAHTZEE game server
+//     (./server). It opens many sessions at once, each played by a bot
+//     that sends a request, waits for the reply, and sends the next
+//     one, and reports how fast the server answered: moves per second
+//     and the percentiles of the time from sending a request to having
+//     its reply.
+//
+//     The bots are simple on purpose: they keep the dice of the face
+//     they have most of, and score where the dice are worth the most.
+//     All of them run on one thread with epoll, so the client costs
+//     little next to the server.
+//
+// Syntax: ./bots [-p path] [-c sessions] [-g games] [-S]
+//     -p  the server's socket (default yahtzee.sock)
+//     -c  number of sessions open at once (default 100)
+//     -g  games each session plays (default 20)
+//     -S  scaling run: 1, 4, 16, ... up to -c sessions, one line each
+//
+// Resources:
+// 1. epoll(7) and unix(7) man pages
+// ----------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "play.h"
+#include "score.h"
+#include "scoretab.h"
+#include "server.h"
+
+#define DEFAULT_SESSIONS   100
+#define DEFAULT_GAMES       20
+#define SCALE_STEP           4
+#define MAX_EVENTS         256
+#define MAX_ROLLS            3
+#define LATENCY_BINS    100000    // 1 us each; slower moves go in the last
+#define NSEC_PER_USEC     1000
+#define NSEC_PER_SEC      1000000000L
+
+// ****  DEFINED TYPES ****
+
+// One bot and its session
+struct bot_t {
+    int             fd;
+    int             games_left;
+    unsigned int    used;           // items scored, bit item-1 for each
+    struct timespec sent;           // when the last request went out
+    int             in_used;
+    char            in[SERVER_LINE];
+};
+
+// What a run measured
+struct load_stats_t {
+    int    sessions;
+    long   games;
+    long   points;                  // total of the final scores
+    long   moves;                   // requests answered
+    double seconds;
+    long   latency[LATENCY_BINS];   // # moves per us of latency
+};
+
+
+// **************************************************************************
+// **************************** GLOBAL VARIABLES ****************************
+// **************************************************************************
+
+static const char *Path = SERVER_PATH;
+static int         Epoll_fd;
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     send_request
+// Inputs
+//     bot
+//         A bot with no request outstanding.
+//     request
+//         The request, '\n' included.
+// Outputs
+//     function result
+//         false if the server is gone.
+// ---------------------------------------------------------------------
+static bool send_request(struct bot_t *bot, const char *request)
+{
+    size_t length = strlen(request);
+
+    clock_gettime(CLOCK_MONOTONIC, &bot->sent);
+    return write(bot->fd, request, length) == (ssize_t)length;
+
+}//end send_request
+
+
+// ---------------------------------------------------------------------
+// Function
+//     next_move
+// Inputs
+//     bot
+//         A bot in a game.
+//     reply
+//         The server's last SERVER_DICE reply.
+// Outputs
+//     request
+//         What the bot does next: reroll, keeping the dice of the face
+//         it has most of, or score where the dice are worth the most.
+// ---------------------------------------------------------------------
+static void next_move(struct bot_t *bot, const char *reply, char *request)
+{
+    unsigned char values[NUMBER_OF_DICE];
+    char dice[NUMBER_OF_DICE + 1];
+    int counts[NUMBER_OF_SIDES + 1] = { 0 };
+    int turn;
+    int roll;
+    int total;
+    int best = 1;
+
+    sscanf(reply + 1, "%i %i %5s %i", &turn, &roll, dice, &total);
+    for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+        values[i] = dice[i] - '0';
+        ++counts[values[i]];
+    }
+    for (int face = 2; face <= NUMBER_OF_SIDES; ++face) {
+        if (counts[face] >= counts[best]) {
+            best = face;
+        }
+    }
+
+    if ((roll < MAX_ROLLS) && (counts[best] < NUMBER_OF_DICE)) {
+        int used = sprintf(request, "%c ", SERVER_ROLL);
+
+        for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+            if (values[i] == best) {
+                request[used++] = '1' + i;
+            }
+        }
+        strcpy(request + used, "\n");
+    } else {
+        int key = scoretab_key(values);
+        int item = 0;
+
+        for (int i = ACES; i <= CHANCE; ++i) {
+            if (!(bot->used & (1u << (i - 1))) &&
+                ((item == 0) ||
+                 (scoretab_score(key, i) > scoretab_score(key, item)))) {
+                item = i;
+            }
+        }
+        bot->used |= 1u << (item - 1);
+        sprintf(request, "%c %i\n", SERVER_SCORE, item);
+    }
+
+}//end next_move
+
+
+// ---------------------------------------------------------------------
+// Function
+//     take_reply
+// Inputs
+//     bot
+//         A bot with a request outstanding.
+//     reply
+//         The reply to it, without its '\n'.
+//     stats
+//         The run so far.
+// Outputs
+//     stats
+//         The move and its latency are counted.
+//     function result
+//         false if the bot is done.
+// ---------------------------------------------------------------------
+static bool take_reply(struct bot_t *bot, const char *reply,
+                       struct load_stats_t *stats)
+{
+    char request[SERVER_LINE];
+    struct timespec now;
+    long usec;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    usec = ((now.tv_sec - bot->sent.tv_sec) * NSEC_PER_SEC +
+            (now.tv_nsec - bot->sent.tv_nsec)) / NSEC_PER_USEC;
+    ++stats->latency[(usec < LATENCY_BINS) ? usec : LATENCY_BINS - 1];
+    ++stats->moves;
+
+    if (reply[0] == SERVER_DICE) {
+        next_move(bot, reply, request);
+    } else if (reply[0] == SERVER_END) {
+        ++stats->games;
+        stats->points += atol(reply + 1);
+        if (--bot->games_left == 0) {
+            return false;
+        }
+        bot->used = 0;
+        sprintf(request, "%c\n", SERVER_NEW);
+    } else {
+        fprintf(stderr, "server: %s\n", reply);
+        return false;
+    }
+
+    return send_request(bot, request);
+
+}//end take_reply
+
+
+// ---------------------------------------------------------------------
+// Function
+//     connect_bot
+// Inputs
+//     bot
+//         A bot to connect.
+// Outputs
+//     function result
+//         false if the server could not be reached.
+// ---------------------------------------------------------------------
+static bool connect_bot(struct bot_t *bot)
+{
+    struct sockaddr_un address;
+    struct epoll_event event;
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, Path, sizeof(address.sun_path) - 1);
+
+    bot->fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if ((bot->fd < 0) ||
+        (connect(bot->fd, (struct sockaddr *)&address,
+                 sizeof(address)) < 0)) {
+        perror(Path);
+        return false;
+    }
+    fcntl(bot->fd, F_SETFL, fcntl(bot->fd, F_GETFL) | O_NONBLOCK);
+
+    event.events   = EPOLLIN;
+    event.data.ptr = bot;
+    return epoll_ctl(Epoll_fd, EPOLL_CTL_ADD, bot->fd, &event) == 0;
+
+}//end connect_bot
+
+
+// ---------------------------------------------------------------------
+// Function
+//     run_load
+// Inputs
+//     sessions
+//         How many bots play at once.
+//     games
+//         How many games each bot plays.
+// Outputs
+//     stats
+//         What was measured.
+//     function result
+//         false if the server could not be reached.
+// Description
+//     Connects the bots, has them all start a game, and then answers
+//     whichever replies come in until every bot has played its games.
+// ---------------------------------------------------------------------
+static bool run_load(const int sessions, const int games,
+                     struct load_stats_t *stats)
+{
+    static struct epoll_event events[MAX_EVENTS];
+    struct bot_t *bots = calloc(sessions, sizeof(*bots));
+    char request[SERVER_LINE];
+    struct timespec start;
+    struct timespec stop;
+    int playing = 0;
+
+    memset(stats, 0, sizeof(*stats));
+    stats->sessions = sessions;
+    if (bots == NULL) {
+        return false;
+    }
+    for (int i = 0; i < sessions; ++i) {
+        bots[i].games_left = games;
+        if (!connect_bot(&bots[i])) {
+            return false;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    sprintf(request, "%c\n", SERVER_NEW);
+    for (int i = 0; i < sessions; ++i) {
+        playing += send_request(&bots[i], request);
+    }
+
+    while (playing > 0) {
+        int ready = epoll_wait(Epoll_fd, events, MAX_EVENTS, -1);
+
+        if ((ready < 0) && (errno != EINTR)) {
+            perror("epoll_wait");
+            return false;
+        }
+        for (int e = 0; e < ready; ++e) {
+            struct bot_t *bot = events[e].data.ptr;
+            ssize_t result = read(bot->fd, bot->in + bot->in_used,
+                                  sizeof(bot->in) - bot->in_used);
+            char *end;
+            bool done = (result == 0) ||
+                        ((result < 0) && (errno != EAGAIN) &&
+                         (errno != EINTR));
+
+            if (result > 0) {
+                bot->in_used += result;
+            }
+
+            // There is only ever one reply outstanding
+            end = memchr(bot->in, '\n', bot->in_used);
+            if (end != NULL) {
+                *end = '\0';
+                bot->in_used = 0;
+                done = !take_reply(bot, bot->in, stats);
+            }
+            if (done) {
+                close(bot->fd);
+                --playing;
+            }
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    stats->seconds = (stop.tv_sec - start.tv_sec) +
+                     (stop.tv_nsec - start.tv_nsec) / 1e9;
+    free(bots);
+
+    return true;
+
+}//end run_load
+
+
+// ---------------------------------------------------------------------
+// Function
+//     percentile
+// Inputs
+//     stats
+//         A run.
+//     fraction
+//         e.g. 0.99
+// Outputs
+//     function result
+//         The latency in us that the fraction of the moves beat.
+// ---------------------------------------------------------------------
+static long percentile(const struct load_stats_t *stats,
+                       const double fraction)
+{
+    long wanted = (long)(fraction * stats->moves);
+    long seen = 0;
+
+    for (long usec = 0; usec < LATENCY_BINS; ++usec) {
+        seen += stats->latency[usec];
+        if (seen > wanted) {
+            return usec;
+        }
+    }
+
+    return LATENCY_BINS;
+
+}//end percentile
+
+
+// **************************************************************************
+// *********************************  MAIN **********************************
+// **************************************************************************
+int main(int argc, char *argv[])
+{
+    static struct load_stats_t stats;
+    struct rlimit limit;
+    int sessions = DEFAULT_SESSIONS;
+    int games = DEFAULT_GAMES;
+    bool scaling = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "p:c:g:S")) != -1) {
+        switch (opt) {
+        case 'p':
+            Path = optarg;
+            break;
+        case 'c':
+            sessions = atoi(optarg);
+            break;
+        case 'g':
+            games = atoi(optarg);
+            break;
+        case 'S':
+            scaling = true;
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-p path] [-c sessions] [-g games] "
+                    "[-S]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if ((sessions < 1) || (games < 1)) {
+        fprintf(stderr, "%s: need at least 1 session and 1 game\n",
+                argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Every session takes a file descriptor
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+    scoretab_init();
+    Epoll_fd = epoll_create1(0);
+
+    printf("%8s %8s %10s %11s %7s %7s %7s %7s %7s\n", "sessions", "games",
+           "moves", "moves/s", "p50 us", "p90 us", "p99 us", "p99.9",
+           "max us");
+    for (int s = scaling ? 1 : sessions; ; ) {
+        long longest = LATENCY_BINS;
+
+        if (!run_load(s, games, &stats)) {
+            return EXIT_FAILURE;
+        }
+        while ((longest > 0) && (stats.latency[longest - 1] == 0)) {
+            --longest;
+        }
+        printf("%8i %8li %10li %11.0f %7li %7li %7li %7li %7li\n",
+               stats.sessions, stats.games, stats.moves,
+               stats.moves / stats.seconds, percentile(&stats, 0.50),
+               percentile(&stats, 0.90), percentile(&stats, 0.99),
+               percentile(&stats, 0.999), longest - 1);
+        if (s >= sessions) {
+            break;
+        }
+        s = (s * SCALE_STEP < sessions) ? s * SCALE_STEP : sessions;
+    }
+    printf("Mean score of the bots: %.1f\n",
+           (double)stats.points / stats.games);
+
+    return EXIT_SUCCESS;
+
+}// end main
+
+// end bots.c
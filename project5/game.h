@@ -0,0 +1,59 @@
+// -------------------------------------------------------------------
+// File: game.h
+//
+// Name: Jonathan Goohs
+//
+// Description: This header defines the state of one YAHTZEE game: its
+//     scorecard, its dice, where it is in the turn, its random stream,
+//     and the record of its moves. The SCORE and PLAY modules keep no
+//     state of their own; every call is given the game it works on. A
+//     game_t holds no pointers, so games can be copied, and thousands
+//     of them packed in an array, e.g. for simulation or for serving
+//     many players.
+// -------------------------------------------------------------------
+#ifndef GAME_H
+#define GAME_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "rng.h"
+
+#define NUMBER_OF_DICE       5
+#define NUMBER_OF_SIDES      6
+#define NUMBER_OF_ENTRIES   13  // Does not count the subtotals and totals
+#define GAME_LOG_SIZE      154  // longest record of a game; see gamelog.h
+
+// An entry in a scorecard
+struct game_entry_t {
+    unsigned char value;
+    bool          used;
+};
+
+// The structure for tracking a single die
+struct game_die_t {
+    unsigned char value;     // The value facing up
+    bool          keep;      // Whether to keep or roll
+};
+
+// One game
+struct game_t {
+    // The scorecard (SCORE module); row 0 is not used
+    struct game_entry_t score[NUMBER_OF_ENTRIES + 1];
+    short               left_score;    // total of the upper section
+    short               right_score;   // total of the lower section
+    short               bonus;         // upper section bonus, if earned
+
+    // The dice and the turn (PLAY module)
+    struct game_die_t   dice[NUMBER_OF_DICE];
+    uint32_t            dice_counts;   // packed counts and total
+    unsigned char       dice_faces;    // faces showing, 1 bit each
+    unsigned char       num_turns;     // # of turns the user has taken
+    unsigned char       num_rolls;     // # of rolls in this turn
+    struct rng_t        rng;           // the random stream of the dice
+
+    // The moves so far, as the GAMELOG module records them
+    unsigned char       log_used;
+    unsigned char       log[GAME_LOG_SIZE];
+};
+
+#endif // GAME_H
@@ -0,0 +1,530 @@
+// ----------------------------------------------------------------------
+// File: gamelog.c
+//
+// Name: Jonathan Goohs
+//
+// Description: This is the implementation of the GAMELOG module of the
+//     YAHTZEE game (see gamelog.h for the format).
+//
+//     While a game is played, the PLAY module has each move recorded
+//     into the game's own game_t, so recording costs a few stores and
+//     no system calls. A whole game is then appended to the log at once:
+//     gamelog_add() buffers whole games, and every write() of the
+//     buffer holds whole games only. The log is opened O_APPEND, so
+//     several processes or threads can append to the same log, and a
+//     reader never sees half a game unless a writer died in a write().
+//
+//     Replaying a game needs only its start record: with the random
+//     stream restored, the same keeps and items give the same dice.
+//     The dice are recorded anyway, so a replay can check itself, and
+//     statistics can be worked out without replaying.
+//
+//     The reader maps the log read-only. Each start record has the
+//     length of its game, so gamelog_index() finds the games in a log
+//     by hopping from one to the next.
+// ----------------------------------------------------------------------
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "score.h"
+#include "gamelog.h"
+
+#define DIE_BITS          3
+#define DIE_MASK          ((1u << DIE_BITS) - 1)
+#define DICE_BYTES        2
+#define STATE_WORDS       4
+#define STATE_BYTES       (STATE_WORDS * sizeof(uint64_t))
+#define START_BYTES       (2 + STATE_BYTES + DICE_BYTES)
+#define MOVE_BYTES        (1 + DICE_BYTES)
+#define LOG_MODE          0644
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     put_dice
+// Inputs
+//     game
+//         A game with room in its record.
+//     over
+//         Whether to record no dice, for the end of the game.
+// Outputs
+//     game
+//         Its dice are added to its record.
+// ---------------------------------------------------------------------
+static void put_dice(struct game_t *game, const bool over)
+{
+    unsigned int packed = 0;
+
+    if (!over) {
+        for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+            packed |= (unsigned int)game->dice[i].value << (DIE_BITS * i);
+        }
+    }
+    game->log[game->log_used++] = packed & 0xff;
+    game->log[game->log_used++] = packed >> 8;
+
+}//end put_dice
+
+
+// ---------------------------------------------------------------------
+// Function
+//     get_dice
+// Inputs
+//     record
+//         Two bytes of packed dice.
+// Outputs
+//     values
+//         The dice.
+// ---------------------------------------------------------------------
+static void get_dice(const unsigned char *record, unsigned char values[])
+{
+    unsigned int packed = record[0] | (record[1] << 8);
+
+    for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+        values[i] = (packed >> (DIE_BITS * i)) & DIE_MASK;
+    }
+
+}//end get_dice
+
+
+// ---------------------------------------------------------------------
+// Function
+//     write_all
+// Inputs
+//     fd, data, size
+//         What to write where.
+// Outputs
+//     function result
+//         SUCCESS, or !SUCCESS if it could not all be written.
+// ---------------------------------------------------------------------
+static int write_all(const int fd, const unsigned char *data, size_t size)
+{
+    while (size > 0) {
+        ssize_t result = write(fd, data, size);
+
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return !SUCCESS;
+        }
+        data += result;
+        size -= result;
+    }
+
+    return SUCCESS;
+
+}//end write_all
+
+
+// **************************************************************************
+// *************************** EXTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     gamelog_start
+// Inputs
+//     game
+//         A new game, with its first roll.
+//     rng
+//         The game's random stream from before that roll.
+// Outputs
+//     game
+//         Its record is started over.
+// ---------------------------------------------------------------------
+void gamelog_start(struct game_t *game, const struct rng_t *rng)
+{
+    game->log_used = 0;
+    game->log[game->log_used++] = GAMELOG_START;
+    game->log[game->log_used++] = 0;        // the length, once known
+    for (int w = 0; w < STATE_WORDS; ++w) {
+        for (int b = 0; b < (int)sizeof(uint64_t); ++b) {
+            game->log[game->log_used++] = rng->s[w] >> (8 * b);
+        }
+    }
+    put_dice(game, false);
+
+}//end gamelog_start
+
+
+// ---------------------------------------------------------------------
+// Function
+//     gamelog_roll
+// Inputs
+//     game
+//         A game whose dice have just been rolled.
+// Outputs
+//     game
+//         The dice that were kept, and the roll, are recorded.
+// ---------------------------------------------------------------------
+void gamelog_roll(struct game_t *game)
+{
+    unsigned char keep = 0;
+
+    if (game->log_used + MOVE_BYTES > GAME_LOG_SIZE) {
+        return;
+    }
+    for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+        keep |= game->dice[i].keep << i;
+    }
+    game->log[game->log_used++] = keep;
+    put_dice(game, false);
+
+}//end gamelog_roll
+
+
+// ---------------------------------------------------------------------
+// Function
+//     gamelog_score
+// Inputs
+//     game
+//         A game that has just scored, and rolled the next turn's dice.
+//     item
+//         Where it scored.
+//     over
+//         Whether that was the last turn.
+// Outputs
+//     game
+//         The item, and the next turn's dice, are recorded.
+// ---------------------------------------------------------------------
+void gamelog_score(struct game_t *game, const int item, const bool over)
+{
+    if (game->log_used + MOVE_BYTES > GAME_LOG_SIZE) {
+        return;
+    }
+    game->log[game->log_used++] = GAMELOG_SCORE + item;
+    put_dice(game, over);
+
+}//end gamelog_score
+
+
+// ---------------------------------------------------------------------
+// Function
+//     gamelog_open
+// Inputs
+//     path
+//         The log to append to; it is made if it does not exist.
+// Outputs
+//     log
+//         Ready for gamelog_add().
+//     function result
+//         SUCCESS, or !SUCCESS if the log can't be opened, or is not a
+//         log of this version.
+// ---------------------------------------------------------------------
+int gamelog_open(struct gamelog_t *log, const char *path)
+{
+    unsigned char header[GAMELOG_HEADER] = GAMELOG_MAGIC;
+    unsigned char found[GAMELOG_HEADER];
+    int fd;
+
+    // Only the writer that makes the log gives it its header
+    header[sizeof(GAMELOG_MAGIC) - 1] = GAMELOG_VERSION;
+    fd = open(path, O_WRONLY | O_CREAT | O_EXCL, LOG_MODE);
+    if (fd >= 0) {
+        write_all(fd, header, sizeof(header));
+        close(fd);
+    }
+
+    log->used = 0;
+    log->fd = open(path, O_RDWR | O_APPEND);
+    if (log->fd < 0) {
+        return !SUCCESS;
+    }
+    if ((pread(log->fd, found, sizeof(found), 0) != sizeof(found)) ||
+        (memcmp(found, header, sizeof(header)) != 0)) {
+        close(log->fd);
+        log->fd = -1;
+        return !SUCCESS;
+    }
+
+    return SUCCESS;
+
+}//end gamelog_open
+
+
+// ---------------------------------------------------------------------
+// Function
+//     gamelog_add
+// Inputs
+//     log
+//         An open log.
+//     game
+//         A game that is over, or is being given up.
+// Outputs
+//     log
+//         The game is added; it is written once the buffer is full, or
+//         at gamelog_flush().
+// ---------------------------------------------------------------------
+void gamelog_add(struct gamelog_t *log, const struct game_t *game)
+{
+    unsigned char *record;
+
+    if ((log->fd < 0) || (game->log_used == 0)) {
+        return;
+    }
+    if (log->used + game->log_used + 1 > GAMELOG_BUFFER) {
+        gamelog_flush(log);
+    }
+
+    record = log->buffer + log->used;
+    memcpy(record, game->log, game->log_used);
+    log->used += game->log_used;
+    if (game->num_turns <= NUMBER_OF_ENTRIES) {
+        // Given up before the last turn
+        log->buffer[log->used++] = GAMELOG_QUIT;
+    }
+    record[1] = log->buffer + log->used - record;
+
+}//end gamelog_add
+
+
+// ---------------------------------------------------------------------
+// Function
+//     gamelog_flush
+// Inputs
+//     log
+//         An open log.
+// Outputs
+//     log
+//         The games added so far are written, in one write().
+// ---------------------------------------------------------------------
+void gamelog_flush(struct gamelog_t *log)
+{
+    if ((log->fd >= 0) && (log->used > 0)) {
+        if (write_all(log->fd, log->buffer, log->used) != SUCCESS) {
+            perror("gamelog");
+        }
+    }
+    log->used = 0;
+
+}//end gamelog_flush
+
+
+// ---------------------------------------------------------------------
+// Function
+//     gamelog_close
+// Inputs
+//     log
+//         An open log.
+// Outputs
+//     log
+//         Flushed and closed.
+// ---------------------------------------------------------------------
+void gamelog_close(struct gamelog_t *log)
+{
+    gamelog_flush(log);
+    if (log->fd >= 0) {
+        close(log->fd);
+    }
+    log->fd = -1;
+
+}//end gamelog_close
+
+
+// ---------------------------------------------------------------------
+// Function
+//     gamelog_map
+// Inputs
+//     path
+//         A log.
+// Outputs
+//     map
+//         The log, mapped read-only.
+//     function result
+//         SUCCESS, or !SUCCESS if it can't be read, or is not a log of
+//         this version.
+// ---------------------------------------------------------------------
+int gamelog_map(struct gamelog_map_t *map, const char *path)
+{
+    struct stat status;
+    void *data;
+    int fd = open(path, O_RDONLY);
+
+    map->data = NULL;
+    map->size = 0;
+    if (fd < 0) {
+        return !SUCCESS;
+    }
+    if ((fstat(fd, &status) < 0) || (status.st_size < GAMELOG_HEADER)) {
+        close(fd);
+        return !SUCCESS;
+    }
+    data = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return !SUCCESS;
+    }
+    map->data = data;
+    map->size = status.st_size;
+
+    if ((memcmp(map->data, GAMELOG_MAGIC, sizeof(GAMELOG_MAGIC) - 1) != 0) ||
+        (map->data[sizeof(GAMELOG_MAGIC) - 1] != GAMELOG_VERSION)) {
+        gamelog_unmap(map);
+        return !SUCCESS;
+    }
+
+    // It is read front to back
+    madvise(data, map->size, MADV_SEQUENTIAL);
+
+    return SUCCESS;
+
+}//end gamelog_map
+
+
+// ---------------------------------------------------------------------
+// Function
+//     gamelog_unmap
+// Inputs
+//     map
+//         A mapped log.
+// Outputs
+//     map
+//         Unmapped.
+// ---------------------------------------------------------------------
+void gamelog_unmap(struct gamelog_map_t *map)
+{
+    if (map->data != NULL) {
+        munmap((void *)map->data, map->size);
+    }
+    map->data = NULL;
+    map->size = 0;
+
+}//end gamelog_unmap
+
+
+// ---------------------------------------------------------------------
+// Function
+//     gamelog_index
+// Inputs
+//     map
+//         A mapped log.
+// Outputs
+//     offsets
+//         Where each game starts, unless NULL.
+//     function result
+//         The number of games. A damaged game, and all after it, are
+//         left out.
+// ---------------------------------------------------------------------
+long gamelog_index(const struct gamelog_map_t *map, size_t offsets[])
+{
+    size_t offset = GAMELOG_HEADER;
+    long games = 0;
+
+    while ((offset + START_BYTES <= map->size) &&
+           (map->data[offset] == GAMELOG_START) &&
+           (map->data[offset + 1] >= START_BYTES) &&
+           (offset + map->data[offset + 1] <= map->size)) {
+        if (offsets != NULL) {
+            offsets[games] = offset;
+        }
+        ++games;
+        offset += map->data[offset + 1];
+    }
+
+    return games;
+
+}//end gamelog_index
+
+
+// ---------------------------------------------------------------------
+// Function
+//     gamelog_game
+// Inputs
+//     map
+//         A mapped log.
+//     offset
+//         Where a game starts, from gamelog_index().
+// Outputs
+//     game
+//         The game's start: its random stream and first roll, and where
+//         its moves are.
+//     function result
+//         SUCCESS, or !SUCCESS if there is no game there.
+// ---------------------------------------------------------------------
+int gamelog_game(const struct gamelog_map_t *map, const size_t offset,
+                 struct gamelog_game_t *game)
+{
+    const unsigned char *record = map->data + offset;
+
+    if ((offset + START_BYTES > map->size) ||
+        (record[0] != GAMELOG_START) || (record[1] < START_BYTES) ||
+        (offset + record[1] > map->size)) {
+        return !SUCCESS;
+    }
+
+    for (int w = 0; w < STATE_WORDS; ++w) {
+        game->rng.s[w] = 0;
+        for (int b = 0; b < (int)sizeof(uint64_t); ++b) {
+            game->rng.s[w] |= (uint64_t)record[2 + w * 8 + b] << (8 * b);
+        }
+    }
+    get_dice(record + 2 + STATE_BYTES, game->dice);
+    game->moves = record + START_BYTES;
+    game->end   = record + record[1];
+
+    return SUCCESS;
+
+}//end gamelog_game
+
+
+// ---------------------------------------------------------------------
+// Function
+//     gamelog_move
+// Inputs
+//     record
+//         A move record of a game.
+//     end
+//         The end of the game's records.
+// Outputs
+//     move
+//         What the record says.
+//     function result
+//         The next record, or end when the game's records are used up
+//         or damaged (move->type is then GAMELOG_BAD_MOVE if there was
+//         something there).
+// ---------------------------------------------------------------------
+const unsigned char *gamelog_move(const unsigned char *record,
+                                  const unsigned char *end,
+                                  struct gamelog_move_t *move)
+{
+    unsigned char op;
+
+    move->type = GAMELOG_BAD_MOVE;
+    if (record >= end) {
+        return end;
+    }
+    op = record[0];
+    if (op == GAMELOG_QUIT) {
+        move->type = GAMELOG_QUIT_MOVE;
+        return record + 1;
+    }
+    if ((record + MOVE_BYTES > end) ||
+        ((op > GAMELOG_KEEPS) &&
+         ((op <= GAMELOG_SCORE) || (op > GAMELOG_SCORE + CHANCE)))) {
+        return end;
+    }
+
+    if (op <= GAMELOG_KEEPS) {
+        move->type = GAMELOG_ROLL_MOVE;
+        move->keep = op;
+    } else {
+        move->type = GAMELOG_SCORE_MOVE;
+        move->item = op - GAMELOG_SCORE;
+    }
+    get_dice(record + 1, move->dice);
+
+    return record + MOVE_BYTES;
+
+}//end gamelog_move
+
+// end gamelog.c
@@ -0,0 +1,100 @@
+// -------------------------------------------------------------------
+// File: gamelog.h
+//
+// Name: Jonathan Goohs
+//
+// Description: This is the header file for the GAMELOG module of the
+//     YAHTZEE game. It records every move of a game in a few bytes, and
+//     appends finished games to a binary log, from which ./replay plays
+//     them again and ./logstats works out statistics.
+//
+//     A log is an 8-byte header ("YZLG" and the version), then games.
+//     A game is a start record, then one record per move:
+//
+//         START  GAMELOG_START, length of the whole game in bytes,
+//                the 32-byte random stream as the game began, dice
+//         roll   the dice kept (bit i for die i, 0-31), dice after
+//         score  GAMELOG_SCORE + item, dice of the next turn (0 once
+//                the game is over)
+//         quit   GAMELOG_QUIT, when the game was given up
+//
+//     Dice are 2 bytes, 3 bits a die. Numbers are little-endian.
+// -------------------------------------------------------------------
+#ifndef GAMELOG_H
+#define GAMELOG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "game.h"
+
+#define GAMELOG_FILE      "yahtzee.log"
+#define GAMELOG_MAGIC     "YZLG"
+#define GAMELOG_VERSION   1
+#define GAMELOG_HEADER    8             // bytes of magic and version
+
+#define GAMELOG_SCORE     0x20          // + item
+#define GAMELOG_QUIT      0x3f
+#define GAMELOG_START     0xf0
+#define GAMELOG_KEEPS     0x1f          // roll records are 0 thru this
+#define GAMELOG_BUFFER    (64 * 1024)   // bytes of games kept for a write
+
+// What a move record says
+enum gamelog_move_type_t {
+    GAMELOG_ROLL_MOVE,
+    GAMELOG_SCORE_MOVE,
+    GAMELOG_QUIT_MOVE,
+    GAMELOG_BAD_MOVE
+};
+
+struct gamelog_move_t {
+    enum gamelog_move_type_t type;
+    unsigned int             keep;      // roll: dice kept, bit i for die i
+    int                      item;      // score: the item
+    unsigned char            dice[NUMBER_OF_DICE];   // the dice after
+};
+
+// A game in a mapped log
+struct gamelog_game_t {
+    struct rng_t         rng;           // the random stream as it began
+    unsigned char        dice[NUMBER_OF_DICE];       // the first roll
+    const unsigned char *moves;         // its move records,
+    const unsigned char *end;           // up to here
+};
+
+// A log being written
+struct gamelog_t {
+    int           fd;
+    int           used;
+    unsigned char buffer[GAMELOG_BUFFER];
+};
+
+// A log mapped for reading
+struct gamelog_map_t {
+    const unsigned char *data;
+    size_t               size;
+};
+
+// Recording, for the PLAY module
+extern void gamelog_start(struct game_t *game, const struct rng_t *rng);
+extern void gamelog_roll(struct game_t *game);
+extern void gamelog_score(struct game_t *game, const int item,
+                          const bool over);
+
+// Writing
+extern int  gamelog_open(struct gamelog_t *log, const char *path);
+extern void gamelog_add(struct gamelog_t *log, const struct game_t *game);
+extern void gamelog_flush(struct gamelog_t *log);
+extern void gamelog_close(struct gamelog_t *log);
+
+// Reading
+extern int  gamelog_map(struct gamelog_map_t *map, const char *path);
+extern void gamelog_unmap(struct gamelog_map_t *map);
+extern long gamelog_index(const struct gamelog_map_t *map, size_t offsets[]);
+extern int  gamelog_game(const struct gamelog_map_t *map, const size_t offset,
+                         struct gamelog_game_t *game);
+extern const unsigned char *gamelog_move(const unsigned char *record,
+                                         const unsigned char *end,
+                                         struct gamelog_move_t *move);
+
+#endif
@@ -0,0 +1,346 @@
+// ----------------------------------------------------------------------
+// File: keys.c
+//
+// Name: Jonathan Goohs
+//
+// Description: This is the implementation of the KEYS module of the
+//     YAHTZEE game. In canonical mode the terminal hands over a line at
+//     a time, so every action needed Enter, and the Enter itself came
+//     back as one more key to redraw the screen for. keys_init() puts
+//     the terminal in non-canonical mode with no echo: read() returns
+//     as soon as a key is pressed, and the game draws what was typed
+//     itself.
+//
+//     Keys are read with read() into a buffer of the module's own,
+//     waiting in poll(). An arrow key comes as ESC [ A (or ESC O A in
+//     the terminal's application mode), all in one read as a rule; a
+//     lone ESC is the Escape key if nothing follows it within
+//     ESCAPE_WAIT_MS. Ctrl-C still interrupts the game: the terminal
+//     is put back as it was at exit and on SIGINT, SIGTERM and SIGHUP.
+//
+//     When stdin is not a terminal (a script) the keys are read the
+//     same way, just without changing the terminal.
+// ----------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <termios.h>
+#include <unistd.h>
+#include "keys.h"
+
+#define BUFFER_SIZE       64
+#define ESCAPE_WAIT_MS    50        // for the rest of an escape sequence
+#define WAIT_FOREVER      (-1)
+#define CSI               '['       // ESC [ ...
+#define SS3               'O'       // ESC O ..., application mode
+#define CSI_FINAL_LOW     0x40      // a CSI sequence ends with @ thru ~
+#define CSI_FINAL_HIGH    0x7e
+#define CTRL_H            0x08
+
+// Signals after which the terminal is put back
+static const int Signals[] = { SIGINT, SIGTERM, SIGHUP };
+
+
+// **************************************************************************
+// **************************** GLOBAL VARIABLES ****************************
+// **************************************************************************
+
+static bool           Raw = false;      // the terminal is in our mode
+static struct termios Saved;            // as it was before
+
+// Keys read but not handed out yet
+static unsigned char Buffer[BUFFER_SIZE];
+static int           Head = 0;
+static int           Tail = 0;
+static bool          Ended = false;     // read() found the end of input
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     restore
+// Inputs
+//     sig
+//         The signal.
+// Outputs
+//     none
+// Description
+//     The signal handler: puts the terminal back, then lets the signal
+//     do what it would have done. Only async-signal-safe calls.
+// ---------------------------------------------------------------------
+static void restore(int sig)
+{
+    if (Raw) {
+        tcsetattr(STDIN_FILENO, TCSADRAIN, &Saved);
+    }
+    signal(sig, SIG_DFL);
+    raise(sig);
+
+}//end restore
+
+
+// ---------------------------------------------------------------------
+// Function
+//     fill
+// Inputs
+//     wait_ms
+//         How long to wait for input, or WAIT_FOREVER.
+// Outputs
+//     function result
+//         Whether there are keys in the buffer.
+// Description
+//     Reads whatever input is there into the buffer, once any is.
+// ---------------------------------------------------------------------
+static bool fill(const int wait_ms)
+{
+    struct pollfd input = { STDIN_FILENO, POLLIN, 0 };
+    ssize_t got;
+
+    if (Head < Tail) {
+        return true;
+    }
+    Head = Tail = 0;
+    while (!Ended) {
+        int ready = poll(&input, 1, wait_ms);
+
+        if ((ready < 0) && (errno == EINTR)) {
+            continue;
+        }
+        if (ready <= 0) {
+            return false;       // nothing came in time
+        }
+        got = read(STDIN_FILENO, Buffer, sizeof(Buffer));
+        if ((got < 0) && (errno == EINTR)) {
+            continue;
+        }
+        if (got <= 0) {
+            Ended = true;
+            break;
+        }
+        Tail = got;
+        return true;
+    }
+
+    return false;
+
+}//end fill
+
+
+// ---------------------------------------------------------------------
+// Function
+//     next_byte
+// Inputs
+//     wait_ms
+//         How long to wait for it.
+// Outputs
+//     function result
+//         The next byte of input, or -1 if none came.
+// ---------------------------------------------------------------------
+static int next_byte(const int wait_ms)
+{
+    return fill(wait_ms) ? Buffer[Head++] : -1;
+
+}//end next_byte
+
+
+// ---------------------------------------------------------------------
+// Function
+//     escape_sequence
+// Inputs
+//     none
+// Outputs
+//     function result
+//         The key of the escape sequence after an ESC.
+// ---------------------------------------------------------------------
+static int escape_sequence(void)
+{
+    int ch = next_byte(ESCAPE_WAIT_MS);
+
+    if (ch < 0) {
+        return KEYS_ESCAPE;     // just the Escape key
+    }
+    if ((ch != CSI) && (ch != SS3)) {
+        return KEYS_UNKNOWN;    // Alt and a key
+    }
+
+    // Skip any parameters, e.g. ESC [ 1 ; 5 A for Ctrl-Up
+    do {
+        ch = next_byte(ESCAPE_WAIT_MS);
+    } while ((ch >= 0) && ((ch < CSI_FINAL_LOW) || (ch > CSI_FINAL_HIGH)));
+
+    switch (ch) {
+    case 'A':
+        return KEYS_UP;
+    case 'B':
+        return KEYS_DOWN;
+    case 'C':
+        return KEYS_RIGHT;
+    case 'D':
+        return KEYS_LEFT;
+    default:
+        return KEYS_UNKNOWN;
+    }
+
+}//end escape_sequence
+
+
+// **************************************************************************
+// *************************** EXTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     keys_init
+// Inputs
+//     none
+// Outputs
+//     none
+// Description
+//     If stdin is a terminal, turns off its line editing and echo until
+//     keys_reset(), at exit, or a signal that ends the game. Keys typed
+//     ahead are kept.
+// ---------------------------------------------------------------------
+void keys_init(void)
+{
+    struct termios raw;
+
+    if (Raw || !isatty(STDIN_FILENO) ||
+        (tcgetattr(STDIN_FILENO, &Saved) < 0)) {
+        return;
+    }
+
+    raw = Saved;
+    raw.c_lflag &= ~(ICANON | ECHO);
+    raw.c_iflag &= ~ICRNL;              // Enter is \r; see keys_get()
+    raw.c_cc[VMIN]  = 1;
+    raw.c_cc[VTIME] = 0;
+    if (tcsetattr(STDIN_FILENO, TCSANOW, &raw) < 0) {
+        return;
+    }
+    Raw = true;
+
+    atexit(keys_reset);
+    for (int s = 0; s < (int)(sizeof(Signals) / sizeof(Signals[0])); ++s) {
+        signal(Signals[s], restore);
+    }
+
+}//end keys_init
+
+
+// ---------------------------------------------------------------------
+// Function
+//     keys_reset
+// Inputs
+//     none
+// Outputs
+//     none
+// Description
+//     Puts the terminal back as it was before keys_init().
+// ---------------------------------------------------------------------
+void keys_reset(void)
+{
+    if (Raw) {
+        tcsetattr(STDIN_FILENO, TCSADRAIN, &Saved);
+        Raw = false;
+    }
+
+}//end keys_reset
+
+
+// ---------------------------------------------------------------------
+// Function
+//     keys_raw
+// Inputs
+//     none
+// Outputs
+//     function result
+//         Whether the terminal is in key-at-a-time mode, i.e. does not
+//         echo the keys.
+// ---------------------------------------------------------------------
+bool keys_raw(void)
+{
+    return Raw;
+
+}//end keys_raw
+
+
+// ---------------------------------------------------------------------
+// Function
+//     keys_get
+// Inputs
+//     none
+// Outputs
+//     function result
+//         The next key: a character, one of the KEYS_ codes, or
+//         KEYS_EOF at the end of the input.
+// Description
+//     Waits for a key. Enter comes as KEYS_ENTER whether the terminal
+//     sends \r, \n or \r\n, and Backspace as KEYS_BACKSPACE whether it
+//     sends DEL or Ctrl-H.
+// ---------------------------------------------------------------------
+int keys_get(void)
+{
+    int ch = next_byte(WAIT_FOREVER);
+
+    switch (ch) {
+    case -1:
+        return KEYS_EOF;
+    case KEYS_ESCAPE:
+        return escape_sequence();
+    case '\r':
+        if (fill(0) && (Buffer[Head] == '\n')) {
+            ++Head;
+        }
+        return KEYS_ENTER;
+    case CTRL_H:
+        return KEYS_BACKSPACE;
+    default:
+        return ch;
+    }
+
+}//end keys_get
+
+
+// ---------------------------------------------------------------------
+// Function
+//     keys_eof
+// Inputs
+//     none
+// Outputs
+//     function result
+//         Whether every key has been read and the input has ended.
+// ---------------------------------------------------------------------
+bool keys_eof(void)
+{
+    return Ended && (Head >= Tail);
+
+}//end keys_eof
+
+
+// ---------------------------------------------------------------------
+// Function
+//     keys_rewind
+// Inputs
+//     none
+// Outputs
+//     none
+// Description
+//     Starts the input over from its beginning, when it is a file (a
+//     script played more than once).
+// ---------------------------------------------------------------------
+void keys_rewind(void)
+{
+    lseek(STDIN_FILENO, 0, SEEK_SET);
+    Head = Tail = 0;
+    Ended = false;
+
+}//end keys_rewind
+
+// end keys.c
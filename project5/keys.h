@@ -0,0 +1,34 @@
+// -------------------------------------------------------------------
+// File: keys.h
+//
+// Name: Jonathan Goohs
+//
+// Description: This is the header file for the KEYS module of the
+//     YAHTZEE game. It reads the keyboard a key at a time, without
+//     waiting for Enter and without the terminal echoing, and turns
+//     the escape sequences of the arrow keys into single key codes.
+// -------------------------------------------------------------------
+#ifndef KEYS_H
+#define KEYS_H
+
+#include <stdbool.h>
+
+// Key codes other than characters
+#define KEYS_EOF        (-1)            // the input is used up
+#define KEYS_ENTER      '\n'
+#define KEYS_ESCAPE     0x1b
+#define KEYS_BACKSPACE  0x7f
+#define KEYS_UP         0x101
+#define KEYS_DOWN       0x102
+#define KEYS_RIGHT      0x103
+#define KEYS_LEFT       0x104
+#define KEYS_UNKNOWN    0x1ff           // an escape sequence not known
+
+extern void keys_init(void);
+extern void keys_reset(void);
+extern bool keys_raw(void);
+extern int  keys_get(void);
+extern bool keys_eof(void);
+extern void keys_rewind(void);
+
+#endif
@@ -0,0 +1,323 @@
+// ----------------------------------------------------------------------
+// File: logstats.c
+//
+// Name: Jonathan Goohs
+//
+// Description: This works out statistics of the games in a YAHTZEE
+//     game log (see gamelog.h): how often each scorecard item is
+//     chosen, what it scores and on which turn, and how the games end.
+//
+//     The log records the dice after every move, so the score of each
+//     move is looked up in the SCORETAB from the dice it was made with,
+//     without replaying the game. The log is mapped read-only, indexed
+//     once, and its games are split over worker threads, each of which
+//     keeps statistics of its own; they are merged after all the
+//     workers are done, as in ./sim.
+//
+// Syntax: ./logstats [-t threads] log
+//     -t  number of worker threads (default 1)
+//
+// Resources:
+// 1. mmap man page
+// 2. pthread_create man page
+// ----------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include "gamelog.h"
+#include "score.h"
+#include "scoretab.h"
+
+#define DEFAULT_THREADS   1
+#define MAX_THREADS       256
+#define CACHE_LINE        64
+#define NSEC_PER_SEC      1000000000L
+#define BYTES_PER_MB      (1024.0 * 1024.0)
+#define PERCENT           100.0
+
+// Short names of the items, for the report
+static const char *Item_names[CHANCE + 1] = {
+    "", "Aces", "Twos", "Threes", "Fours", "Fives", "Sixes",
+    "3 of a Kind", "4 of a Kind", "Full House", "Sm. Straight",
+    "Lg. Straight", "YAHTZEE", "Chance"
+};
+
+
+// **************************************************************************
+// ****************************  DEFINED TYPES   ****************************
+// **************************************************************************
+
+// The statistics of many games. Each worker has its own, and they are
+// merged when all the workers are done.
+struct log_stats_t {
+    unsigned long games;
+    unsigned long finished;                 // games played to the end
+    unsigned long given_up;
+    unsigned long damaged;                  // games with a bad record
+    unsigned long bonuses;                  // finished games with the bonus
+    unsigned long points;                   // of the finished games
+    unsigned long turns;                    // turns scored
+    unsigned long rerolls;
+    unsigned long chosen[CHANCE + 1];       // # times each item is scored
+    unsigned long item_points[CHANCE + 1];
+    unsigned long zeros[CHANCE + 1];        // # times it scored nothing
+    unsigned long item_turns[CHANCE + 1];   // sum of the turns it was on
+};
+
+// A worker thread; aligned so workers never share a cache line
+struct log_worker_t {
+    pthread_t          thread;
+    long               first;       // the games this worker reads
+    long               games;
+    struct log_stats_t stats;
+} __attribute__((aligned(CACHE_LINE)));
+
+
+// **************************************************************************
+// **************************** GLOBAL VARIABLES ****************************
+// **************************************************************************
+
+static struct log_worker_t  Workers[MAX_THREADS];
+static struct gamelog_map_t Map;
+static size_t              *Offsets;
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     count_game
+// Inputs
+//     offset
+//         Where the game starts in the log.
+// Outputs
+//     stats
+//         The game is added to them.
+// ---------------------------------------------------------------------
+static void count_game(const size_t offset, struct log_stats_t *stats)
+{
+    struct gamelog_game_t game;
+    struct gamelog_move_t move;
+    const unsigned char *record;
+    unsigned char dice[NUMBER_OF_DICE];     // the dice of the next move
+    int upper = 0;
+    int points = 0;
+    int turn = 1;
+
+    ++stats->games;
+    if (gamelog_game(&Map, offset, &game) != SUCCESS) {
+        ++stats->damaged;
+        return;
+    }
+
+    memcpy(dice, game.dice, sizeof(dice));
+    for (record = game.moves; record < game.end; ) {
+        record = gamelog_move(record, game.end, &move);
+
+        if (move.type == GAMELOG_ROLL_MOVE) {
+            ++stats->rerolls;
+        } else if (move.type == GAMELOG_SCORE_MOVE) {
+            int score = scoretab_score(scoretab_key(dice), move.item);
+
+            ++stats->turns;
+            ++stats->chosen[move.item];
+            stats->item_points[move.item] += score;
+            stats->zeros[move.item] += (score == 0);
+            stats->item_turns[move.item] += turn++;
+            points += score;
+            if (move.item <= SIXES) {
+                upper += score;
+            }
+        } else if (move.type == GAMELOG_QUIT_MOVE) {
+            ++stats->given_up;
+            return;
+        } else {
+            ++stats->damaged;
+            return;
+        }
+        memcpy(dice, move.dice, sizeof(dice));
+    }
+
+    if (turn <= NUMBER_OF_ENTRIES) {
+        ++stats->damaged;
+        return;
+    }
+    if (upper >= LEFT_BONUS_SUBTOTAL) {
+        ++stats->bonuses;
+        points += BONUS_VALUE;
+    }
+    ++stats->finished;
+    stats->points += points;
+
+}//end count_game
+
+
+// ---------------------------------------------------------------------
+// Function
+//     run_worker
+// Inputs
+//     arg
+//         The worker.
+// Outputs
+//     function result (always NULL)
+// Description
+//     The thread function: counts the worker's share of the games.
+// ---------------------------------------------------------------------
+static void *run_worker(void *arg)
+{
+    struct log_worker_t *worker = arg;
+
+    for (long g = worker->first; g < worker->first + worker->games; ++g) {
+        count_game(Offsets[g], &worker->stats);
+    }
+
+    return NULL;
+
+}//end run_worker
+
+
+// ---------------------------------------------------------------------
+// Function
+//     merge
+// Inputs
+//     part
+//         One worker's statistics.
+// Outputs
+//     stats
+//         The part is added to them.
+// ---------------------------------------------------------------------
+static void merge(const struct log_stats_t *part, struct log_stats_t *stats)
+{
+    stats->games    += part->games;
+    stats->finished += part->finished;
+    stats->given_up += part->given_up;
+    stats->damaged  += part->damaged;
+    stats->bonuses  += part->bonuses;
+    stats->points   += part->points;
+    stats->turns    += part->turns;
+    stats->rerolls  += part->rerolls;
+    for (int item = ACES; item <= CHANCE; ++item) {
+        stats->chosen[item]      += part->chosen[item];
+        stats->item_points[item] += part->item_points[item];
+        stats->zeros[item]       += part->zeros[item];
+        stats->item_turns[item]  += part->item_turns[item];
+    }
+
+}//end merge
+
+
+// ---------------------------------------------------------------------
+// Function
+//     report
+// Inputs
+//     stats
+//         The merged statistics.
+// Outputs
+//     none
+// ---------------------------------------------------------------------
+static void report(const struct log_stats_t *stats)
+{
+    double finished = stats->finished ? stats->finished : 1;
+
+    printf("Games %lu: finished %lu, given up %lu, damaged %lu\n",
+           stats->games, stats->finished, stats->given_up, stats->damaged);
+    printf("Finished games: mean score %.2f, bonus %.2f%%\n",
+           stats->points / finished, PERCENT * stats->bonuses / finished);
+    printf("Rerolls per turn %.3f\n\n",
+           stats->turns ? (double)stats->rerolls / stats->turns : 0.0);
+
+    printf("%-14s %10s %7s %7s %7s\n", "Item", "chosen", "mean",
+           "zero %", "turn");
+    for (int item = ACES; item <= CHANCE; ++item) {
+        double n = stats->chosen[item] ? stats->chosen[item] : 1;
+
+        printf("%-14s %10lu %7.2f %7.2f %7.2f\n", Item_names[item],
+               stats->chosen[item], stats->item_points[item] / n,
+               PERCENT * stats->zeros[item] / n,
+               stats->item_turns[item] / n);
+    }
+
+}//end report
+
+
+// **************************************************************************
+// *********************************  MAIN  *********************************
+// **************************************************************************
+
+int main(int argc, char *argv[])
+{
+    struct log_stats_t stats;
+    struct timespec start;
+    struct timespec stop;
+    int threads = DEFAULT_THREADS;
+    long games;
+    double seconds;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:")) != -1) {
+        switch (opt) {
+        case 't':
+            threads = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-t threads] log\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if ((optind != argc - 1) || (threads < 1) || (threads > MAX_THREADS)) {
+        fprintf(stderr, "Usage: %s [-t threads] log\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (gamelog_map(&Map, argv[optind]) != SUCCESS) {
+        fprintf(stderr, "%s: %s is not a game log\n", argv[0], argv[optind]);
+        return EXIT_FAILURE;
+    }
+
+    scoretab_init();
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    games = gamelog_index(&Map, NULL);
+    Offsets = malloc((games + 1) * sizeof(*Offsets));
+    if (Offsets == NULL) {
+        perror("malloc");
+        return EXIT_FAILURE;
+    }
+    gamelog_index(&Map, Offsets);
+
+    for (int t = 0; t < threads; ++t) {
+        Workers[t].games = games / threads + (t < games % threads);
+        Workers[t].first = (t == 0) ? 0
+                                    : Workers[t - 1].first + Workers[t - 1].games;
+        if (pthread_create(&Workers[t].thread, NULL, run_worker,
+                           &Workers[t]) != 0) {
+            perror("pthread_create");
+            return EXIT_FAILURE;
+        }
+    }
+    memset(&stats, 0, sizeof(stats));
+    for (int t = 0; t < threads; ++t) {
+        pthread_join(Workers[t].thread, NULL);
+        merge(&Workers[t].stats, &stats);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    seconds = (stop.tv_sec - start.tv_sec) +
+              (double)(stop.tv_nsec - start.tv_nsec) / NSEC_PER_SEC;
+
+    report(&stats);
+    printf("\n%zu bytes read in %.3f s on %d threads: %.0f games/s, "
+           "%.1f MB/s\n", Map.size, seconds, threads, games / seconds,
+           Map.size / BYTES_PER_MB / seconds);
+
+    free(Offsets);
+    gamelog_unmap(&Map);
+
+    return EXIT_SUCCESS;
+
+}//end main
+
+// end logstats.c
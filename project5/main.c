@@ -5,35 +5,242 @@
 //
 // Description: This is the main program for a simple Yahtzee game.
 //
-// Syntax: ./yahtzee [any other user inputs are ignored]
+// Syntax: ./yahtzee [--verify | --bench | --seed n | --players seats [n] |
+//                    --script file [games]]
+//     --verify checks the score lookup table, the packed dice state,
+//     the batch scoring kernels and the roll table against the rules of
+//     the game, and
+//     --bench times the ways of scoring and rolling the dice, instead
+//     of playing. --seed plays
+//     the game with the dice of seed n; the seed of every game is shown
+//     at the end, so the same dice can be played again. Any other user
+//     inputs are ignored. If ./solve has written yahtzee.ev in the
+//     current directory, the menu shows what optimal play is expected
+//     to score, and if ./rolls has written yahtzee.rolls, the advice
+//     shows the chance of a YAHTZEE. Every game played, finished or
+//     not, is added to yahtzee.log in the current directory (see
+//     ./replay). Keys act as soon as they are hit, without Enter (see
+//     keys.c).
+//
+//     --players plays one game with 2 to 8 players, from the dice of
+//     seed n if it is given: seats has a letter for each player, h for
+//     a user at the terminal (taking turns at the keyboard) or a for
+//     the computer, e.g. "hah". The computers plan their turns while
+//     the users play theirs (see players.c).
+//
+//     --script plays the game with the keys in file instead of the
+//     user's, through the same code, as many times as games (default
+//     1), from a fixed seed. Nothing is drawn: what would be sent to
+//     the terminal is only counted. At the end it prints the bytes
+//     sent, and how long each phase of the interactions took (see
+//     phase.c), so rendering can be told apart from the game logic.
+//     Scripted games are not logged.
 // ----------------------------------------------------------------------
 
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "batch.h"
+#include "gamelog.h"
+#include "keys.h"
+#include "phase.h"
 #include "play.h"
+#include "players.h"
+#include "rng.h"
+#include "rolltab.h"
 #include "screen.h"
 #include "score.h"
+#include "scoretab.h"
+#include "solver.h"
+
+#define VERIFY_OPTION "--verify"
+#define BENCH_OPTION  "--bench"
+#define SEED_OPTION   "--seed"
+#define SCRIPT_OPTION "--script"
+#define PLAYERS_OPTION "--players"
+#define SCRIPT_SEED   1
+
+// The one game played at the terminal, and the log it goes in
+static struct game_t    Game;
+static struct gamelog_t Log;
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     run_script
+// Inputs
+//     path
+//         The keys to play with.
+//     games
+//         How many games to play with them.
+// Outputs
+//     function result
+//         EXIT_SUCCESS, or EXIT_FAILURE if the keys can't be read.
+// Description
+//     Plays the games with the script on stdin, each from the start of
+//     the script, with the screen going to the sink, and reports the
+//     output and the phase timings. A game ends early if the script
+//     runs out.
+// ---------------------------------------------------------------------
+static int run_script(const char *path, const int games)
+{
+    unsigned long long bytes;
+    unsigned long long writes;
+    int finished = 0;
+    long points = 0;
+
+    if (freopen(path, "r", stdin) == NULL) {
+        perror(path);
+        return EXIT_FAILURE;
+    }
+
+    screen_init_sink();
+    phase_enable();
+    rng_seed(&Game.rng, SCRIPT_SEED, 0);
+    for (int g = 0; g < games; ++g) {
+        unsigned int used;
+        int upper;
+        int total;
+
+        keys_rewind();
+        play_new_game(&Game);
+        play_yahtzee(&Game);
+        score_state(&Game, &used, &upper, &total);
+        finished += play_over(&Game);
+        points += total;
+    }
+    screen_reset();
+    screen_sink_counts(&bytes, &writes);
+
+    printf("%i game%s of %s, %i finished, mean score %.1f\n", games,
+           (games == 1) ? "" : "s", path, finished,
+           (double)points / games);
+    printf("Screen output: %llu bytes in %llu writes, %.0f bytes/write\n\n",
+           bytes, writes, writes ? (double)bytes / writes : 0.0);
+    phase_report();
+
+    return EXIT_SUCCESS;
+
+}//end run_script
+
+
+// ---------------------------------------------------------------------
+// Function
+//     run_players
+// Inputs
+//     seats
+//         One letter per player: h for a user, a for the computer.
+//     seed
+//         The seed of the dice.
+// Outputs
+//     function result
+//         EXIT_SUCCESS, or EXIT_FAILURE if the seats are not valid.
+// Description
+//     Plays one game with several players at the terminal, then shows
+//     the standings and adds every player's game to the log.
+// ---------------------------------------------------------------------
+static int run_players(const char *seats, const unsigned long long seed)
+{
+    if (players_start(seats, seed) != SUCCESS) {
+        fprintf(stderr, "%s takes %i to %i seats, each %c (a user) or "
+                "%c (the computer), e.g. %c%c%c\n", PLAYERS_OPTION,
+                PLAYERS_MIN, PLAYERS_MAX, PLAYERS_HUMAN, PLAYERS_AI,
+                PLAYERS_HUMAN, PLAYERS_AI, PLAYERS_AI);
+        return EXIT_FAILURE;
+    }
+
+    screen_init();
+    keys_init();
+    screen_echo(!keys_raw());
+    players_play();
+    players_stop();
+    keys_reset();
+    screen_reset();
+
+    players_report();
+    if (gamelog_open(&Log, GAMELOG_FILE) == SUCCESS) {
+        for (int s = 0; s < players_count(); ++s) {
+            gamelog_add(&Log, players_game(s));
+        }
+        gamelog_close(&Log);
+    }
+    printf("Seed %llu (play these dice again with %s %s %llu)\n",
+           seed, PLAYERS_OPTION, seats, seed);
+
+    return EXIT_SUCCESS;
+
+}//end run_players
 
 
 // **************************************************************************
 // *********************************  MAIN **********************************
 // **************************************************************************
-int main(void)
+int main(int argc, char *argv[])
 {
+    unsigned long long seed = time(NULL) * getpid();
+
+    // Build the score lookup table before anything is scored
+    scoretab_init();
+
+    // Map the optimal play table, if ./solve has written one, and the
+    // reroll chances, if ./rolls has
+    solver_load(SOLVER_FILE);
+    play_load_rolls(ROLLTAB_FILE);
+
+    if ((argc > 1) && (strcmp(argv[1], VERIFY_OPTION) == 0)) {
+        int errors = play_verify_scores();
+
+        printf("Scoring: %i difference%s from the rules\n",
+               errors, (errors == 1) ? "" : "s");
+        return (errors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+    } else if ((argc > 1) && (strcmp(argv[1], BENCH_OPTION) == 0)) {
+        play_benchmark();
+        rng_benchmark();
+        batch_benchmark();
+        return EXIT_SUCCESS;
+    } else if ((argc > 2) && (strcmp(argv[1], SCRIPT_OPTION) == 0)) {
+        int games = (argc > 3) ? atoi(argv[3]) : 1;
+
+        return run_script(argv[2], (games > 0) ? games : 1);
+    } else if ((argc > 2) && (strcmp(argv[1], PLAYERS_OPTION) == 0)) {
+        if (argc > 3) {
+            seed = strtoull(argv[3], NULL, 0);
+        }
+        return run_players(argv[2], seed);
+    } else if ((argc > 2) && (strcmp(argv[1], SEED_OPTION) == 0)) {
+        seed = strtoull(argv[2], NULL, 0);
+    }
 
-    // Initialize the screen module
+    // Initialize the screen module, and read the keys as they are hit
     screen_init();
+    keys_init();
+    screen_echo(!keys_raw());
 
-    // Initialize the score module
-    score_reset();
+    // Start a game with a clear score card and its own dice stream
+    rng_seed(&Game.rng, seed, 0);
+    play_new_game(&Game);
 
     // Play the game
-    play_yahtzee();
+    play_yahtzee(&Game);
 
-    // Reset the screen as it was before game started
+    // Reset the terminal and the screen as they were before game started
+    keys_reset();
     screen_reset();
 
     // Display the final score sheet
-    score_display_final();
+    score_display_final(&Game);
+    if (gamelog_open(&Log, GAMELOG_FILE) == SUCCESS) {
+        gamelog_add(&Log, &Game);
+        gamelog_close(&Log);
+    }
+    printf("Seed %llu (play these dice again with %s %llu)\n",
+           seed, SEED_OPTION, seed);
 
     return EXIT_SUCCESS;
 
@@ -0,0 +1,199 @@
+// ----------------------------------------------------------------------
+// File: phase.c
+//
+// Name: Jonathan Goohs
+//
+// Description: This is the implementation of the PHASE module of the
+//     YAHTZEE game. Every timing of a phase is kept, in nanoseconds, so
+//     phase_report() can give exact percentiles; a scripted run has a
+//     few thousand interactions, not millions. The timings nest:
+//     assign_score includes the score card and the screen it draws.
+// ----------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include "phase.h"
+
+#define FIRST_SAMPLES     1024
+#define NSEC_PER_SEC      1000000000ull
+#define NSEC_PER_USEC     1000.0
+#define NSEC_PER_MSEC     1e6
+#define PERCENT           100.0
+
+// Percentiles reported
+static const double Percentiles[] = { 50, 90, 99 };
+
+// ****  DEFINED TYPES ****
+
+// The timings of one phase
+struct phase_samples_t {
+    uint64_t *ns;
+    long      count;
+    long      size;             // room in ns
+};
+
+
+// **************************************************************************
+// **************************** GLOBAL VARIABLES ****************************
+// **************************************************************************
+
+static bool Enabled = false;
+static struct phase_samples_t Samples[PHASES];
+static const char *Names[PHASES] = {
+    "roll_dice", "assign_score", "score_display", "screen_present"
+};
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     compare
+// Inputs
+//     a, b
+//         Two timings.
+// Outputs
+//     function result
+//         Their order, for qsort().
+// ---------------------------------------------------------------------
+static int compare(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+
+    return (x > y) - (x < y);
+
+}//end compare
+
+
+// **************************************************************************
+// *************************** EXTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     phase_enable
+// Inputs
+//     none
+// Outputs
+//     none
+// Description
+//     Starts timing the phases.
+// ---------------------------------------------------------------------
+void phase_enable(void)
+{
+    Enabled = true;
+
+}//end phase_enable
+
+
+// ---------------------------------------------------------------------
+// Function
+//     phase_begin
+// Inputs
+//     none
+// Outputs
+//     function result
+//         The time a phase begins, for phase_end().
+// ---------------------------------------------------------------------
+uint64_t phase_begin(void)
+{
+    struct timespec now;
+
+    if (!Enabled) {
+        return 0;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec * NSEC_PER_SEC + now.tv_nsec;
+
+}//end phase_begin
+
+
+// ---------------------------------------------------------------------
+// Function
+//     phase_end
+// Inputs
+//     phase
+//         The phase that is over.
+//     start
+//         When it began, from phase_begin().
+// Outputs
+//     none
+// Description
+//     Keeps the time the phase took.
+// ---------------------------------------------------------------------
+void phase_end(const enum phase_t phase, const uint64_t start)
+{
+    struct phase_samples_t *samples = &Samples[phase];
+
+    if (!Enabled) {
+        return;
+    }
+    if (samples->count == samples->size) {
+        long size = samples->size ? 2 * samples->size : FIRST_SAMPLES;
+        uint64_t *ns = realloc(samples->ns, size * sizeof(*ns));
+
+        if (ns == NULL) {
+            return;
+        }
+        samples->ns = ns;
+        samples->size = size;
+    }
+    samples->ns[samples->count++] = phase_begin() - start;
+
+}//end phase_end
+
+
+// ---------------------------------------------------------------------
+// Function
+//     phase_report
+// Inputs
+//     none
+// Outputs
+//     none
+// Description
+//     Prints how often each phase ran, the percentiles and the longest
+//     of its times, and its total time.
+// ---------------------------------------------------------------------
+void phase_report(void)
+{
+    const int percentiles = sizeof(Percentiles) / sizeof(Percentiles[0]);
+
+    printf("%-15s %8s", "phase", "count");
+    for (int p = 0; p < percentiles; ++p) {
+        printf("   p%-2g us", Percentiles[p]);
+    }
+    printf(" %9s %9s\n", "max us", "total ms");
+
+    for (int phase = 0; phase < PHASES; ++phase) {
+        struct phase_samples_t *samples = &Samples[phase];
+        uint64_t total = 0;
+
+        printf("%-15s %8ld", Names[phase], samples->count);
+        if (samples->count == 0) {
+            printf("\n");
+            continue;
+        }
+        qsort(samples->ns, samples->count, sizeof(samples->ns[0]),
+              compare);
+        for (long i = 0; i < samples->count; ++i) {
+            total += samples->ns[i];
+        }
+        for (int p = 0; p < percentiles; ++p) {
+            long rank = Percentiles[p] * (samples->count - 1) / PERCENT;
+
+            printf(" %9.1f", samples->ns[rank] / NSEC_PER_USEC);
+        }
+        printf(" %9.1f %9.2f\n",
+               samples->ns[samples->count - 1] / NSEC_PER_USEC,
+               total / NSEC_PER_MSEC);
+    }
+
+}//end phase_report
+
+// end phase.c
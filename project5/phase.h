@@ -0,0 +1,31 @@
+// -------------------------------------------------------------------
+// File: phase.h
+//
+// Name: Jonathan Goohs
+//
+// Description: This is the header file for the PHASE module of the
+//     YAHTZEE game. It times the phases of each interaction (rolling,
+//     scoring, drawing the score card, sending the screen) so a
+//     scripted run can show where the time goes. Timing is off unless
+//     phase_enable() is called, and then costs a test per phase.
+// -------------------------------------------------------------------
+#ifndef PHASE_H
+#define PHASE_H
+
+#include <stdint.h>
+
+// The phases timed
+enum phase_t {
+    PHASE_ROLL_DICE,
+    PHASE_ASSIGN_SCORE,
+    PHASE_SCORE_DISPLAY,
+    PHASE_PRESENT,
+    PHASES
+};
+
+extern void     phase_enable(void);
+extern uint64_t phase_begin(void);
+extern void     phase_end(const enum phase_t phase, const uint64_t start);
+extern void     phase_report(void);
+
+#endif
@@ -8,6 +8,10 @@
 //     a score. The one glaring shortcoming (other than the user
 //     interface) is the inability to support the "Joker Rule" where a
 //     user can get more than one Yahtzee in a game.
+//
+//     All the state of a game is in the game_t passed to each function,
+//     so play_new_game(), play_roll() and play_score() can also drive
+//     any number of games without a user, e.g. in the simulator.
 // ----------------------------------------------------------------------
 
 #include <stdio.h>
@@ -16,22 +20,36 @@
 #include <errno.h>
 #include <time.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <ctype.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 #include "screen.h"
 #include "score.h"
+#include "scoretab.h"
+#include "solver.h"
+#include "advisor.h"
+#include "batch.h"
+#include "gamelog.h"
+#include "keys.h"
+#include "phase.h"
 #include "play.h"
+#include "reroll.h"
+#include "rolltab.h"
 
-#define MAX_INPUT       80
+#define ITEM_DIGITS     2    // the longest item number typed
 #define BASE_10         10
 #define CHOOSE_DICE_ROW 1
 #define CHOOSE_DICE_COL 1
-#define MENU_ROW        15
+#define MENU_ROW        14
 #define MENU_COL        1
+#define STATUS_ROW      24   // the last row, e.g. the other players
+#define STATUS_COL      1
 
-#define NUMBER_OF_DICE       5
-#define NUMBER_OF_SIDES      6
 #define MAX_ROLLS            3
 #define MAX_TURNS            13
 #define MAX_FULLHOUSE_MATCH  3
@@ -41,32 +59,65 @@
 #define MAX_SMSTRAIGHT_MATCH 2
 #define MAX_LGSTRAIGHT_MATCH 1
 
+// Packed dice state: one 4-bit count per face in the low 24 bits of
+// game->dice_counts (ACES in bits 0-3), the total of the dice in the top 8,
+// and one presence bit per face in game->dice_faces (ACES in bit 0). The
+// counts are laid out as scoretab_counts_key() wants them.
+#define COUNT_BITS    SCORETAB_COUNT_BITS
+#define COUNT_FIELDS  0x00FFFFFFu
+#define COUNT_ONES    0x00111111u     // 1 in every count
+#define COUNT_HIGHS   0x00888888u     // high bit of every count
+#define COUNT_MAX     0xFu
+#define TOTAL_SHIFT   24
+#define FACE_BIT(f)   (1u << ((f) - 1))
+#define DIE_BITS(f)   ((1u << (COUNT_BITS * ((f) - 1))) + \
+                       ((uint32_t)(f) << TOTAL_SHIFT))
+
+// game->dice_faces patterns of the straights
+#define FACES_SM_LOW  0x0Fu           // 1 2 3 4
+#define FACES_SM_MID  0x1Eu           // 2 3 4 5
+#define FACES_SM_HIGH 0x3Cu           // 3 4 5 6
+#define FACES_LG_LOW  0x1Fu           // 1 2 3 4 5
+#define FACES_LG_HIGH 0x3Eu           // 2 3 4 5 6
+
+#define BENCH_PASSES  200
+#define NSEC_PER_SEC  1000000000L
+#define NSEC_PER_USEC 1000.0
+#define ALL_DICE      ((1u << NUMBER_OF_DICE) - 1)
+#define VERIFY_BATCH  1000          // hands per batch; not a multiple of
+                                    // the lanes, so tails are checked
+#define VERIFY_CHANCE 1e-6          // rounding allowed in the roll table
+#define PERCENT       100.0
+
+// The advice is worked out on every keypress of choose_dice, so it has
+// to fit well inside a screen refresh
+#define ADVICE_BUDGET_US 1000
+#define KEEP_TEXT        32
+
+// Short item names for the advice
+static const char *Item_names[] = {
+    "", "Aces", "Twos", "Threes", "Fours", "Fives", "Sixes",
+    "3 of a Kind", "4 of a Kind", "Full House", "Sm. Straight",
+    "Lg. Straight", "YAHTZEE", "Chance"
+};
+
 // Menu selections
 #define CHOOSE 'C'
 #define ROLL   'R'
 #define SCORE  'S'
 #define QUIT   'Q'
 #define RETURN 'R'
-
-
-// **************************************************************************
-// ****************************  DEFINED TYPES   ****************************
-// **************************************************************************
-
-// The structure for tracking a single die
-struct die_t {
-    unsigned char value;     // The value facing up
-    bool          keep;      // Whether to keep or roll
-};
+#define TOGGLE ' '
 
 
 // **************************************************************************
 // **************************** GLOBAL VARIABLES ****************************
 // **************************************************************************
 
-static struct die_t Dice[NUMBER_OF_DICE]; // All the dice
-static unsigned int Num_turns;            // # of turns user has taken
-static unsigned int Num_rolls;            // # of rolls the user has taken
+// The reroll probability tables (see rolltab.h), when a file is mapped:
+// Roll_chances[rerolls - 1][keep][key]
+static const float (*Roll_chances)[REROLL_KEEPS][ROLLTAB_ROW] = NULL;
+static void *Rolls_mapping = NULL;
 
 
 // **************************************************************************
@@ -77,7 +128,8 @@ static unsigned int Num_rolls;            // # of rolls the user has taken
 // Function
 //     show_dice
 // Inputs
-//     none
+//     game
+//         The game.
 // Outputs
 //     none
 // Description
@@ -86,26 +138,25 @@ static unsigned int Num_rolls;            // # of rolls the user has taken
 //     For those dice that the user wants to re-roll, they are displayed
 //     in white.
 // ---------------------------------------------------------------------
-static void show_dice()
+static void show_dice(const struct game_t *game)
 {
     int i;
 
     // First show the selected dice (if any) not to be rolled
     screen_text_color(BLACK_TEXT);
     for (i = 0; i < NUMBER_OF_DICE; ++i) {
-        if (Dice[i].keep) {
-            printf("%i ", Dice[i].value);
+        if (game->dice[i].keep) {
+            screen_printf("%i ", game->dice[i].value);
         }
     }
 
     // Now show the dice that will be rolled (if any)
     screen_text_color(WHITE_TEXT);
     for (i = 0; i < NUMBER_OF_DICE; ++i) {
-        if (!(Dice[i].keep)) {
-            printf("%i ", Dice[i].value);
+        if (!(game->dice[i].keep)) {
+            screen_printf("%i ", game->dice[i].value);
         }
     }
-    fflush(stdout);
 
 }//end show_dice
 
@@ -114,21 +165,34 @@ static void show_dice()
 // Function
 //     display_menu
 // Inputs
-//     none
+//     game
+//         The game.
 // Outputs
 //     none
 // Description
-//     This function shows the menu to the user.
+//     This function shows the menu to the user, with the expected
+//     final score of optimal play when the solver table is loaded.
 // ---------------------------------------------------------------------
-static void display_menu(void)
+static void display_menu(const struct game_t *game)
 {
+    unsigned int used;
+    int upper;
+    int total;
+
     screen_cursor(MENU_ROW, MENU_COL);
-    printf("Turn %u out of %u\n", Num_turns, MAX_TURNS);
-    printf("Roll %u out of %u\n\n", Num_rolls, MAX_ROLLS);
-    printf("Menu: %c = Choose the dice to keep or roll\n", CHOOSE);
-    printf("      %c = Roll the dice\n", ROLL);
-    printf("      %c = Enter a score\n", SCORE);
-    printf("      %c = Quit\n", QUIT);
+    screen_printf("Turn %u out of %u", game->num_turns, MAX_TURNS);
+    if (solver_loaded()) {
+        // What optimal play from this scorecard is worth on average
+        score_state(game, &used, &upper, &total);
+        screen_printf("      Best play expects a final score of %.1f",
+                      total + solver_value(used, upper));
+    }
+    screen_printf("\n");
+    screen_printf("Roll %u out of %u\n\n", game->num_rolls, MAX_ROLLS);
+    screen_printf("Menu: %c = Choose the dice to keep or roll\n", CHOOSE);
+    screen_printf("      %c = Roll the dice\n", ROLL);
+    screen_printf("      %c = Enter a score\n", SCORE);
+    screen_printf("      %c = Quit\n", QUIT);
 
 }//end display_menu
 
@@ -137,6 +201,8 @@ static void display_menu(void)
 // Function
 //     how_many_of
 // Inputs
+//     game
+//         The game.
 //     die
 //         This is the die value to be searched for.
 // Outputs
@@ -147,12 +213,12 @@ static void display_menu(void)
 //     current dice are "3 4 5 5 1", and the input is 5, this function
 //     will return 2.
 // ---------------------------------------------------------------------
-static int how_many_of(const int die)
+static int how_many_of(const struct game_t *game, const int die)
 {
     int count = 0;
 
     for (int i=0; i < NUMBER_OF_DICE; ++i) {
-        if (Dice[i].value == die) {
+        if (game->dice[i].value == die) {
             ++count;
         }
     }
@@ -166,19 +232,20 @@ static int how_many_of(const int die)
 // Function
 //     total_of_dice
 // Inputs
-//     none
+//     game
+//         The game.
 // Outputs
 //     Function result
 // Description
 //     This function looks at all the "face up" values of each die and
 //     returns their current total.
 // ---------------------------------------------------------------------
-static int total_of_dice(void)
+static int total_of_dice(const struct game_t *game)
 {
     int score = 0;
 
     for (int i=0; i < NUMBER_OF_DICE; ++i) {
-        score += Dice[i].value;
+        score += game->dice[i].value;
     }
 
     return score;
@@ -190,14 +257,15 @@ static int total_of_dice(void)
 // Function
 //     max_dice_matching
 // Inputs
-//     none
+//     game
+//         The game.
 // Outputs
 //     function result
 // Description
 //     This function determines the highest number of matching die. For
 //     example, if the dice were "4 2 1 4 4", the result would be 3.
 // ---------------------------------------------------------------------
-static int max_dice_matching(void)
+static int max_dice_matching(const struct game_t *game)
 {
     int count;
     int max = 0;
@@ -206,7 +274,7 @@ static int max_dice_matching(void)
     for (int i=ACES; i <= NUMBER_OF_SIDES; ++i) {
         count = 0;
         for (int j=0; j < NUMBER_OF_DICE; ++j) {
-            if (Dice[j].value == i) {
+            if (game->dice[j].value == i) {
                 ++count;
             }
         }
@@ -224,22 +292,23 @@ static int max_dice_matching(void)
 // Function
 //     is_full_house
 // Inputs
-//     none
+//     game
+//         The game.
 // Outputs
 //     function result
 // Description
 //     This function determins whether the current dice values represent
 //     a full house (or not), returning true or false.
 // ---------------------------------------------------------------------
-static bool is_full_house(void)
+static bool is_full_house(const struct game_t *game)
 {
     bool result = false;
 
     // If we have a 3-of-a-kind, then verify other dice are 2-of-a-kind
-    if (max_dice_matching() == MAX_FULLHOUSE_MATCH) {
+    if (max_dice_matching(game) == MAX_FULLHOUSE_MATCH) {
         // Is there a two-of-a-kind?
         for (int number=1; number <= NUMBER_OF_SIDES; ++number) {
-            if (how_many_of(number) == MIN_FULLHOUSE_MATCH) {
+            if (how_many_of(game, number) == MIN_FULLHOUSE_MATCH) {
                 result = true;
                 break;
             }
@@ -253,179 +322,527 @@ static bool is_full_house(void)
 
 // ---------------------------------------------------------------------
 // Function
-//     assign_score
+//     set_die
 // Inputs
+//     game
+//         The game.
+//     die
+//         The index of the die to change.
+//     value
+//         The new value facing up.
+// Outputs
 //     none
+// Description
+//     This function changes the value of one die and keeps the packed
+//     dice state in step: the old face is taken out of the counts (and
+//     out of the presence mask once its count drops to zero), and the
+//     new face is put in. The die must hold a valid value already.
+// ---------------------------------------------------------------------
+static void set_die(struct game_t *game, const int die,
+                    const unsigned char value)
+{
+    unsigned char old = game->dice[die].value;
+
+    game->dice_counts -= DIE_BITS(old);
+    if (((game->dice_counts >> (COUNT_BITS * (old - 1))) & COUNT_MAX)
+        == 0) {
+        game->dice_faces &= ~FACE_BIT(old);
+    }
+    game->dice_counts += DIE_BITS(value);
+    game->dice_faces  |= FACE_BIT(value);
+    game->dice[die].value = value;
+
+}//end set_die
+
+
+// ---------------------------------------------------------------------
+// Function
+//     set_dice
+// Inputs
+//     game
+//         The game.
+//     values
+//         The values of all the dice.
+// Outputs
+//     none
+// Description
+//     This function sets every die, marks them all as rollable, and
+//     rebuilds the packed dice state from scratch.
+// ---------------------------------------------------------------------
+static void set_dice(struct game_t *game, const unsigned char values[])
+{
+    game->dice_counts = 0;
+    game->dice_faces  = 0;
+    for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+        game->dice[i].value = values[i];
+        game->dice[i].keep  = false;
+        game->dice_counts  += DIE_BITS(values[i]);
+        game->dice_faces   |= FACE_BIT(values[i]);
+    }
+
+}//end set_dice
+
+
+// ---------------------------------------------------------------------
+// Function
+//     has_kind
+// Inputs
+//     game
+//         The game.
+//     number
+//         The number of matching dice wanted (1 thru 5).
+// Outputs
+//     function result
+// Description
+//     Returns true if at least "number" dice show the same face. Adding
+//     8 - number to every 4-bit count sets its high bit exactly when the
+//     count is at least "number"; no count can carry into the next.
+// ---------------------------------------------------------------------
+static bool has_kind(const struct game_t *game, const unsigned int number)
+{
+    return (((game->dice_counts & COUNT_FIELDS) +
+             (8 - number) * COUNT_ONES) & COUNT_HIGHS) != 0;
+
+}//end has_kind
+
+
+// ---------------------------------------------------------------------
+// Function
+//     packed_score
+// Inputs
+//     game
+//         The game.
+//     item
+//         The scorecard item (ACES thru CHANCE).
+// Outputs
+//     function result
+// Description
+//     This function returns the same score as scan_score(), but works
+//     from the packed dice state instead of scanning the dice: a count
+//     is a shift and a mask, n-of-a-kind is has_kind(), and the number
+//     of different faces (the popcount of the presence mask) together
+//     with mask tests gives full house, the straights and Yahtzee.
+// ---------------------------------------------------------------------
+static int packed_score(const struct game_t *game, const int item)
+{
+    int score = 0;
+    int faces = __builtin_popcount(game->dice_faces);
+    int total = game->dice_counts >> TOTAL_SHIFT;
+
+    switch (item) {
+    case ACES: case TWOS: case THREES: case FOURS: case FIVES: case SIXES:
+        score = ((game->dice_counts >> (COUNT_BITS * (item - 1))) &
+                 COUNT_MAX) * item;
+        break;
+    case KIND3:
+        if (has_kind(game, MIN_3KIND_MATCH)) {
+            score = total;
+        }
+        break;
+    case KIND4:
+        if (has_kind(game, MIN_4KIND_MATCH)) {
+            score = total;
+        }
+        break;
+    case FULL_HOUSE:
+        // Two faces, and not four of one: 3 + 2
+        if ((faces == 2) && !has_kind(game, MIN_4KIND_MATCH)) {
+            score = SCORE_FULL_HOUSE;
+        }
+        break;
+    case STRAIGHT_SM:
+        if (((game->dice_faces & FACES_SM_LOW)  == FACES_SM_LOW) ||
+            ((game->dice_faces & FACES_SM_MID)  == FACES_SM_MID) ||
+            ((game->dice_faces & FACES_SM_HIGH) == FACES_SM_HIGH)) {
+            score = SCORE_STRAIGHT_SM;
+        }
+        break;
+    case STRAIGHT_LG:
+        if ((game->dice_faces == FACES_LG_LOW) ||
+            (game->dice_faces == FACES_LG_HIGH)) {
+            score = SCORE_STRAIGHT_LG;
+        }
+        break;
+    case YAHTZEE:
+        if (faces == 1) {
+            score = SCORE_YAHTZEE;
+        }
+        break;
+    case CHANCE:
+        score = total;
+        break;
+    }
+
+    return score;
+
+}//end packed_score
+
+
+// ---------------------------------------------------------------------
+// Function
+//     scan_score
+// Inputs
+//     game
+//         The game.
+//     item
+//         The scorecard item (ACES thru CHANCE).
+// Outputs
+//     function result
+// Description
+//     This function applies the rules of the game to the current dice
+//     and returns the score they get in the given item, which is zero
+//     when the dice do not match the item. It scans the dice for every
+//     question it asks, which makes it slow but obviously right, so it
+//     is the reference that the SCORETAB table and packed_score() are
+//     verified against.
+// ---------------------------------------------------------------------
+static int scan_score(const struct game_t *game, const int item)
+{
+    int score = 0;
+    if ((item >= ACES) && (item <= SIXES)) {
+        for (int i=0; i < NUMBER_OF_DICE; ++i) {
+            // The item is in the upper section.
+            // Add up the die with that number (if any)
+            score = how_many_of(game, item) * item;
+        }
+    } else if (item == KIND3) {
+        if (max_dice_matching(game) >= MIN_3KIND_MATCH) {
+            score = total_of_dice(game);
+        }
+    } else if (item == KIND4) {
+        if (max_dice_matching(game) >= MIN_4KIND_MATCH) {
+            score = total_of_dice(game);
+        }
+    } else if ((item == FULL_HOUSE) && (is_full_house(game))) {
+        score = SCORE_FULL_HOUSE;
+    } else if (item == STRAIGHT_SM) {
+        if (max_dice_matching(game) > MAX_SMSTRAIGHT_MATCH) {
+            // A small straight can't have more than two dice matching
+            ; // do nothing; score is already zero
+        } else if ((how_many_of(game, THREES) == 0) ||
+                   (how_many_of(game, FOURS) == 0)) {
+            // A small straight always has at least a 3 and 4
+            ; // do nothing; score is already zero
+        } else if ((how_many_of(game, ACES) > 0) &&
+                   (how_many_of(game, TWOS) > 0)) {
+            // A straight with 1, 2, 3, 4
+            score = SCORE_STRAIGHT_SM;
+        } else if ((how_many_of(game, TWOS) > 0) &&
+                   (how_many_of(game, FIVES) > 0)) {
+            // A straight with 2, 3, 4, 5
+            score = SCORE_STRAIGHT_SM;
+        } else if ((how_many_of(game, FIVES) > 0) &&
+                   (how_many_of(game, SIXES) > 0)) {
+            // A straight with 3, 4, 5, 6
+            score = SCORE_STRAIGHT_SM;
+        }
+    } else if (item == STRAIGHT_LG) {
+        // Verify we have a large straight
+        if (max_dice_matching(game) > MAX_LGSTRAIGHT_MATCH) {
+            // A large straight has no duplicates
+            ; // do nothing; the score is already zero
+        } else if ((how_many_of(game, TWOS) == 0) ||
+                   (how_many_of(game, THREES) == 0) ||
+                   (how_many_of(game, FOURS) == 0)) {
+            // A large straight always has 2, 3, 4
+            ; // do nothing; the score is already zero
+        } else if ((how_many_of(game, ACES) == 1) &&
+                   (how_many_of(game, FIVES) == 1)) {
+            // A large straight of 1, 2, 3, 4, 5
+            score = SCORE_STRAIGHT_LG;
+        } else if ((how_many_of(game, FIVES) == 1) &&
+                   (how_many_of(game, SIXES) == 1)) {
+            // A large straight of 2, 3, 4, 5, 6
+            score = SCORE_STRAIGHT_LG;
+        }
+    } else if (item == YAHTZEE) {
+        if (max_dice_matching(game) == NUMBER_OF_DICE) {
+            score = SCORE_YAHTZEE;
+        }
+    } else if (item == CHANCE) {
+        score = total_of_dice(game);
+    }
+
+    return score;
+
+}//end scan_score
+
+
+// ---------------------------------------------------------------------
+// Function
+//     show_status
+// Inputs
+//     status
+//         A line to show at the bottom of the screen, or NULL.
+// Outputs
+//     none
+// ---------------------------------------------------------------------
+static void show_status(const char *status)
+{
+    if (status != NULL) {
+        screen_cursor(STATUS_ROW, STATUS_COL);
+        screen_printf("%s", status);
+    }
+
+}//end show_status
+
+
+// ---------------------------------------------------------------------
+// Function
+//     get_key
+// Inputs
+//     none
+// Outputs
+//     function result
+//         The next key the user hits (see keys.h), letters in upper case.
+// ---------------------------------------------------------------------
+static int get_key(void)
+{
+    int key = keys_get();
+
+    return (key <= UCHAR_MAX) ? toupper(key) : key;
+
+}//end get_key
+
+
+// ---------------------------------------------------------------------
+// Function
+//     assign_score
+// Inputs
+//     game
+//         The game.
+//     status
+//         A line for the bottom of the screen, or NULL.
 // Outputs
 //     none
 // Description
 //     This function prompts the user to select an from the scorecard to
-//     apply the current state of the dice. It must determine whether
-//     the selected entry matches the current state of the dice. If yes,
-//     then the score is determined. If not, then zero is applied to
-//     that item.
+//     apply the current state of the dice, and scores it with
+//     play_score(), which also starts the next turn. The digits are
+//     drawn as they are typed, and Backspace takes one back; Escape
+//     goes back to the menu, unless the turn has no rolls left.
 // ---------------------------------------------------------------------
-static void assign_score(void)
+static void assign_score(struct game_t *game, const char *status)
 {
-    int  item;
-    int  score;
-    int  result = SUCCESS;
-    char input[MAX_INPUT];
-    char *last_char = NULL;
+    char input[ITEM_DIGITS + 1];
+    int  used = 0;              // digits typed so far
+    int  key;
+    bool redraw = true;
+    uint64_t start = phase_begin();
 
     while (true) {
-        // Repeat the loop until the user enters something other than
-        // the RETURN key.
-        do {
-            // Show the score card and the current dice
+        if (redraw) {
+            // Show the score card, the current dice and what is typed
+            input[used] = '\0';
             screen_clear();
-            score_display();
-            printf("\nDice: ");
-            show_dice();
+            show_status(status);
+            score_display(game);
+            screen_printf("\nDice: ");
+            show_dice(game);
 
             // Prompt the user to pick an item in the score card
-            printf("\n\nSelect the item number to place your score: ");
-            fflush(stdout);
-            fgets(input, MAX_INPUT, stdin);
-        } while (input[0] == '\n');
-
-        // get rid of the trailing '\n'
-        input[strlen(input)] = '\0';
-
-        // Convert the input string to a number.
-        errno = 0;
-        item = strtol(input, &last_char, BASE_10);
-        if ((last_char == NULL) && (*last_char != '\0')) {
-            continue;
-        } else if (errno != 0) {
-            continue;
+            screen_printf("\n\nSelect the item number to place your score: "
+                          "%s", input);
+            screen_present();
         }
 
-        // Now try to enter the appropriate score in the requested place.
-        // If, for example, the user selects "Full House", but the roll
-        // isn't a Full House, then it's assumed the user wants to put
-        // a zero in that spot for a strategic reason. A potential
-        // future enhancemet would be to prompt "Are you sure?".
-        score = 0;
-        if ((item >= ACES) && (item <= SIXES)) {
-            for (int i=0; i < NUMBER_OF_DICE; ++i) {
-                // The item is in the upper section.
-                // Add up the die with that number (if any)
-                score = how_many_of(item) * item;
-            }
-        } else if (item == KIND3) {
-            if (max_dice_matching() >= MIN_3KIND_MATCH) {
-                score = total_of_dice();
-            }
-        } else if (item == KIND4) {
-            if (max_dice_matching() >= MIN_4KIND_MATCH) {
-                score = total_of_dice();
-            }
-        } else if ((item == FULL_HOUSE) && (is_full_house())) {
-            score = SCORE_FULL_HOUSE;
-        } else if (item == STRAIGHT_SM) {
-            if (max_dice_matching() > MAX_SMSTRAIGHT_MATCH) {
-                // A small straight can't have more than two dice matching
-                ; // do nothing; score is already zero
-            } else if ((how_many_of(THREES) == 0) ||
-                       (how_many_of(FOURS) == 0)) {
-                // A small straight always has at least a 3 and 4
-                ; // do nothing; score is already zero
-            } else if ((how_many_of(ACES) > 0) &&
-                       (how_many_of(TWOS) > 0)) {
-                // A straight with 1, 2, 3, 4
-                score = SCORE_STRAIGHT_SM;
-            } else if ((how_many_of(TWOS) > 0) &&
-                       (how_many_of(FIVES) > 0)) {
-                // A straight with 2, 3, 4, 5
-                score = SCORE_STRAIGHT_SM;
-            } else if ((how_many_of(THREES) > 0) &&
-                       (how_many_of(SIXES) > 0)) {
-                // A straight with 3, 4, 5, 6
-                score = SCORE_STRAIGHT_SM;
+        // Keys that change nothing leave the screen as it is
+        key = get_key();
+        redraw = true;
+        if ((key == KEYS_EOF) ||
+            ((key == KEYS_ESCAPE) && (game->num_rolls < MAX_ROLLS))) {
+            // Out of input, or the user changed their mind: leave the
+            // turn as it is
+            break;
+        } else if ((key == KEYS_ENTER) && (used > 0)) {
+            // Try to set the score and leave the loop.
+            // Future enhancement: show the reason the request failed.
+            used = 0;
+            if (play_score(game, strtol(input, NULL, BASE_10)) == SUCCESS) {
+                break;
             }
-        } else if (item == STRAIGHT_LG) {
-            // Verify we have a large straight
-            if (max_dice_matching() > MAX_LGSTRAIGHT_MATCH) {
-                // A large straight has no duplicates
-                ; // do nothing; the score is already zero
-            } else if ((how_many_of(TWOS) == 0) ||
-                       (how_many_of(THREES) == 0) ||
-                       (how_many_of(FOURS) == 0)) {
-                // A large straight always has 2, 3, 4
-                ; // do nothing; the score is already zero
-            } else if ((how_many_of(ACES) == 1) &&
-                       (how_many_of(FIVES) == 1)) {
-                // A large straight of 1, 2, 3, 4, 5
-                score = SCORE_STRAIGHT_LG;
-            } else if ((how_many_of(TWOS) == 1) &&
-                       (how_many_of(SIXES) == 1)) {
-                // A large straight of 2, 3, 4, 5, 6
-                score = SCORE_STRAIGHT_LG;
+        } else if ((key == KEYS_BACKSPACE) && (used > 0)) {
+            --used;
+        } else if ((key <= UCHAR_MAX) && isdigit(key) &&
+                   (used < ITEM_DIGITS)) {
+            input[used++] = key;
+        } else {
+            redraw = false;
+        }
+    }
+    phase_end(PHASE_ASSIGN_SCORE, start);
+
+}//end assign_score
+
+
+// ---------------------------------------------------------------------
+// Function
+//     show_advice
+// Inputs
+//     game
+//         The game.
+// Outputs
+//     none
+// Description
+//     This function shows the best ways to keep the current dice, with
+//     the final score each is expected to lead to, marks the one the
+//     user has selected (if it is among them), and shows the best item
+//     to score the dice in right away. It also shows how long working
+//     out the advice took, against ADVICE_BUDGET_US.
+// ---------------------------------------------------------------------
+static void show_advice(const struct game_t *game)
+{
+    struct advice_t keeps[ADVISOR_TOP];
+    struct advice_t items[1];
+    unsigned char values[NUMBER_OF_DICE];
+    unsigned char chosen[NUMBER_OF_DICE];
+    struct timespec start;
+    struct timespec stop;
+    unsigned int used;
+    int upper;
+    int total;
+    int count;
+    int selected = 0;
+    int rerolls = MAX_ROLLS - game->num_rolls;
+    double usec;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    score_state(game, &used, &upper, &total);
+    for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+        values[i] = game->dice[i].value;
+        if (game->dice[i].keep) {
+            chosen[selected++] = game->dice[i].value;
+        }
+    }
+    advisor_turn(used, upper, total);
+    count = advisor_keeps(values, rerolls, keeps, ADVISOR_TOP);
+    advisor_items(values, items, 1);
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    usec = ((stop.tv_sec - start.tv_sec) * NSEC_PER_SEC +
+            (stop.tv_nsec - start.tv_nsec)) / NSEC_PER_USEC;
+
+    screen_printf("\nAdvice, %i reroll%s left%s:\n", rerolls,
+                  (rerolls == 1) ? "" : "s",
+                  solver_loaded() ? "" : " (best for this turn only)");
+    for (int k = 0; k < count; ++k) {
+        char text[KEEP_TEXT] = "Reroll all";
+        unsigned char kept[NUMBER_OF_DICE];
+        int size = 0;
+        int used_text = 0;
+
+        for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+            if (keeps[k].keep & (1u << i)) {
+                kept[size++] = values[i];
             }
-        } else if (item == YAHTZEE) {
-            if (max_dice_matching() == NUMBER_OF_DICE) {
-                score = SCORE_YAHTZEE;
+        }
+        if (keeps[k].keep == ALL_DICE) {
+            snprintf(text, sizeof(text), "Keep all");
+        } else if (size > 0) {
+            used_text = snprintf(text, sizeof(text), "Keep die #");
+            for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+                if (keeps[k].keep & (1u << i)) {
+                    used_text += snprintf(text + used_text,
+                                          sizeof(text) - used_text,
+                                          " %i", i + 1);
+                }
             }
-        } else if (item == CHANCE) {
-            score = total_of_dice();
         }
-
-        // Try to set the score and leave the loop.
-        // Future enhancement: show the reason the request failed.
-        result = score_set(item, score);
-        if (result == SUCCESS) {
-            break;
+        screen_printf("  %i. %-22s expects %5.1f%s\n", k + 1, text,
+                      keeps[k].value,
+                      (reroll_keep_of(kept, size) ==
+                       reroll_keep_of(chosen, selected)) ? "  <- your choice"
+                                                         : "");
+    }
+    screen_printf("  Or score now in %s, which expects %.1f\n",
+                  Item_names[items[0].item], items[0].value);
+    if (Roll_chances != NULL) {
+        const float *chances = play_roll_chances(reroll_keep_of(chosen,
+                                                                selected),
+                                                 rerolls);
+        double yahtzee = 0;
+
+        for (int key = 0; key < SCORETAB_KEYS; ++key) {
+            if (scoretab_score(key, YAHTZEE) > 0) {
+                yahtzee += chances[key];
+            }
         }
+        screen_printf("  A YAHTZEE from your choice, played for a kind: "
+                      "%.2f%%\n", PERCENT * yahtzee);
     }
+    screen_printf("  (advice took %.1f us; budget %i us%s)\n", usec,
+                  ADVICE_BUDGET_US,
+                  (usec > ADVICE_BUDGET_US) ? ", OVER" : "");
 
-}//end assign_score
+}//end show_advice
 
 
 // ---------------------------------------------------------------------
 // Function
 //     choose_dice
 // Inputs
-//     none
+//     game
+//         The game.
+//     status
+//         A line for the bottom of the screen, or NULL.
 // Outputs
 //     none
 // Description
 //     The user is presented the current state of the dice, and allows
-//     the user to choose which dice to roll, and which to keep. A
-//     side-effect is to change the state of the dice.
+//     the user to choose which dice to roll, and which to keep, with
+//     advice on the best choices. A side-effect is to change the state
+//     of the dice. A die is changed with its number, or with the arrow
+//     keys and Space; Escape returns as 'R' does.
 // ---------------------------------------------------------------------
-static void choose_dice(void)
+static void choose_dice(struct game_t *game, const char *status)
 {
     int die;
-    char ch;
-    bool done = false;
-
-    while (!done) {
-        screen_clear();
-        screen_cursor(CHOOSE_DICE_ROW, CHOOSE_DICE_COL);
+    int key;
+    int selected = 0;           // the die marked with '>'
+    bool redraw = true;
 
-        printf("Die #   Keep   Roll\n");
-        printf("-----   ----   ----\n");
-        for (int i = 0; i < NUMBER_OF_DICE; ++i) {
-            if (Dice[i].keep) {
-                printf("    %i   %i\n", i+1, Dice[i].value);
-            } else {
-                printf("    %i          %i\n", i+1, Dice[i].value);
+    while (true) {
+        if (redraw) {
+            screen_clear();
+            show_status(status);
+            screen_cursor(CHOOSE_DICE_ROW, CHOOSE_DICE_COL);
+
+            screen_printf("Die #   Keep   Roll\n");
+            screen_printf("-----   ----   ----\n");
+            for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+                screen_printf("%s", (i == selected) ? "  > " : "    ");
+                if (game->dice[i].keep) {
+                    screen_printf("%i   %i\n", i+1, game->dice[i].value);
+                } else {
+                    screen_printf("%i          %i\n", i+1,
+                                  game->dice[i].value);
+                }
             }
-        }
+            show_advice(game);
 
-        // Get what the user wants to switch
-        printf("\n\nEnter the die # to change (1 thru 5), or 'R' to return: ");
-        ch = getc(stdin);
-        if (isdigit(ch)) {
-            die = ch - '1';
+            // Get what the user wants to switch
+            screen_printf("\n\nPress the die # to change (1 thru 5), or "
+                          "Space for the one at '>',\nor 'R' to return: ");
+            screen_present();
+        }
 
+        // Keys that change nothing leave the screen as it is
+        key = get_key();
+        redraw = true;
+        if ((key == KEYS_EOF) || (key == RETURN) || (key == KEYS_ESCAPE)) {
+            break;
+        } else if ((key >= '1') && (key < '1' + NUMBER_OF_DICE)) {
             // Switch whether to keep or roll
-            if ((die >= 0) && (die < NUMBER_OF_DICE)) {
-                Dice[die].keep = !(Dice[die].keep);
-            }
-        } else if (toupper(ch) == RETURN) {
-            done = true;
+            die = key - '1';
+            game->dice[die].keep = !(game->dice[die].keep);
+            selected = die;
+        } else if (key == TOGGLE) {
+            game->dice[selected].keep = !(game->dice[selected].keep);
+        } else if (key == KEYS_UP) {
+            selected = (selected + NUMBER_OF_DICE - 1) % NUMBER_OF_DICE;
+        } else if (key == KEYS_DOWN) {
+            selected = (selected + 1) % NUMBER_OF_DICE;
+        } else {
+            redraw = false;
         }
     }
 
@@ -436,20 +853,28 @@ static void choose_dice(void)
 // Function
 //     roll_dice
 // Inputs
-//     none
+//     game
+//         The game.
 // Outputs
 //     none
 // Description
 //     This function "rolls the dice" selected by the user by assigning
-//     random values to those dice the user didn't keep.
+//     random values to those dice the user didn't keep. The values come
+//     from the game's own random stream, so games do not share state.
 // ---------------------------------------------------------------------
-static void roll_dice(void)
+static void roll_dice(struct game_t *game)
 {
+    unsigned char values[NUMBER_OF_DICE];
+    int rolled = 0;
+    uint64_t start = phase_begin();
+
+    rng_dice(&game->rng, values, NUMBER_OF_DICE);
     for (int i = 0; i < NUMBER_OF_DICE; ++i) {
-        if (Dice[i].keep == false) {
-            Dice[i].value = (random() % NUMBER_OF_SIDES) + 1;
+        if (game->dice[i].keep == false) {
+            set_die(game, i, values[rolled++]);
         }
     }
+    phase_end(PHASE_ROLL_DICE, start);
 
 }//end roll_dice
 
@@ -458,7 +883,8 @@ static void roll_dice(void)
 // Function
 //     init_dice
 // Inputs
-//     none
+//     game
+//         The game.
 // Outputs
 //     none
 // Description
@@ -466,12 +892,12 @@ static void roll_dice(void)
 //     marking them as rollable. This is typically done as the first roll
 //     of a turn.
 // ---------------------------------------------------------------------
-static void init_dice(void)
+static void init_dice(struct game_t *game)
 {
-    for (int i = 0; i < NUMBER_OF_DICE; ++i) {
-        Dice[i].value = (random() % NUMBER_OF_SIDES) + 1;
-        Dice[i].keep  = false;
-    }
+    unsigned char values[NUMBER_OF_DICE];
+
+    rng_dice(&game->rng, values, NUMBER_OF_DICE);
+    set_dice(game, values);
 
 }//end init_dice
 
@@ -479,70 +905,609 @@ static void init_dice(void)
 // ************************************************************************
 // *************************  EXTERNAL FUNCTIONS **************************
 // ************************************************************************
-void play_yahtzee(void)
+
+// ---------------------------------------------------------------------
+// Function
+//     play_new_game
+// Inputs
+//     game
+//         A game whose random stream is seeded, with rng_seed() or by
+//         an earlier game.
+// Outputs
+//     game
+//         A fresh game: a clear scorecard, the first turn, and the
+//         first roll of the dice.
+// Description
+//     Everything about a game lives in its game_t, so any number of
+//     games can be played at once, e.g. from an array. The game's log
+//     record starts with the random stream as it was before the first
+//     roll, which is all it takes to replay the game.
+// ---------------------------------------------------------------------
+void play_new_game(struct game_t *game)
 {
-    char ch = '\n';
+    struct rng_t start = game->rng;
 
-    // Initialize globals
-    Num_turns = 1;
-    Num_rolls = 1;
+    score_reset(game);
+    game->num_turns = 1;
+    game->num_rolls = 1;
+    init_dice(game);
+    gamelog_start(game, &start);
 
-    // initialize the PRNG and the dice
-    srandom(time(NULL)*getpid());
-    init_dice();
+}//end play_new_game
 
-    // This loop continues until the user has taken all their turns or
-    // the user quits the game.
-    while (true) {
-        // Is the game over?
-        if (Num_turns > MAX_TURNS) {
-            break;
+
+// ---------------------------------------------------------------------
+// Function
+//     play_roll
+// Inputs
+//     game
+//         A game with rolls left in the turn.
+// Outputs
+//     none
+// Description
+//     Rolls the dice not marked to keep, using up a roll, and records
+//     the move in the game's log record.
+// ---------------------------------------------------------------------
+void play_roll(struct game_t *game)
+{
+    roll_dice(game);
+    ++game->num_rolls;
+    gamelog_roll(game);
+
+}//end play_roll
+
+
+// ---------------------------------------------------------------------
+// Function
+//     play_score
+// Inputs
+//     game
+//         A game that is not over.
+//     item
+//         The scorecard item to put the dice in.
+// Outputs
+//     function result
+//         SUCCESS, or !SUCCESS if the item does not exist or is used.
+// Description
+//     Enters the score of the dice in the item and starts the next
+//     turn. If, for example, the user selects "Full House", but the
+//     roll isn't a Full House, then it's assumed the user wants to put
+//     a zero in that spot for a strategic reason. The move is recorded
+//     in the game's log record.
+// ---------------------------------------------------------------------
+int play_score(struct game_t *game, const int item)
+{
+    int result = score_set(game, item,
+                           scoretab_score(play_dice_key(game), item));
+
+    if (result == SUCCESS) {
+        game->num_rolls = 1;
+        ++game->num_turns;
+        init_dice(game);
+        gamelog_score(game, item, play_over(game));
+    }
+
+    return result;
+
+}//end play_score
+
+
+// ---------------------------------------------------------------------
+// Function
+//     play_over
+// Inputs
+//     game
+//         A game.
+// Outputs
+//     function result
+// Description
+//     Returns true once every turn has been played.
+// ---------------------------------------------------------------------
+bool play_over(const struct game_t *game)
+{
+    return game->num_turns > MAX_TURNS;
+
+}//end play_over
+
+
+// ---------------------------------------------------------------------
+// Function
+//     play_rolls_left
+// Inputs
+//     game
+//         A game.
+// Outputs
+//     function result
+// Description
+//     Returns how many more times the dice can be rolled this turn.
+// ---------------------------------------------------------------------
+int play_rolls_left(const struct game_t *game)
+{
+    return MAX_ROLLS - game->num_rolls;
+
+}//end play_rolls_left
+
+
+// ---------------------------------------------------------------------
+// Function
+//     play_dice_key
+// Inputs
+//     game
+//         The game whose dice are looked at.
+// Outputs
+//     function result
+// Description
+//     Returns the SCORETAB key of the multiset of the current dice. It
+//     comes from the packed counts kept by set_die() and set_dice(), so
+//     the dice are not scanned.
+// ---------------------------------------------------------------------
+int play_dice_key(const struct game_t *game)
+{
+    return scoretab_counts_key(game->dice_counts & COUNT_FIELDS);
+
+}//end play_dice_key
+
+
+// ---------------------------------------------------------------------
+// Function
+//     play_turn
+// Inputs
+//     game
+//         A game that is not over.
+//     status
+//         A line to show at the bottom of the screen, e.g. the other
+//         players' scores, or NULL.
+// Outputs
+//     function result
+//         Whether the turn was played out; false if the user quit or
+//         the input is used up.
+// Description
+//     Plays one turn of the game with the user at the terminal, until
+//     a score is entered. Keys are acted on as they are hit (see
+//     keys.h), and the screen is drawn again only when a key changes
+//     it.
+// ---------------------------------------------------------------------
+bool play_turn(struct game_t *game, const char *status)
+{
+    int turn = game->num_turns;
+    int key;
+
+    // This loop continues until the user has scored the turn or quits
+    while (game->num_turns == turn) {
+        // Is the input used up?
+        if (keys_eof()) {
+            return false;
         }
 
-        if (Num_rolls == MAX_ROLLS) {
+        if (game->num_rolls == MAX_ROLLS) {
             // The user has used all the rolls for the turn and
             // is forced to enter a score.
-            assign_score();
-            Num_rolls = 1;
-            ++Num_turns;
-            init_dice();
+            assign_score(game, status);
+            continue;
+        }
+
+        // Display the score and the dice
+        screen_clear();
+        show_status(status);
+        score_display(game);
+        display_menu(game);
+        screen_printf("\nDice (black to keep): ");
+        show_dice(game);
+
+        // Prompt the user for an action to take, and then do it. Any
+        // other key (Enter, say) changes nothing, so the screen is not
+        // drawn again for it.
+        screen_printf("\nAction: ");
+        screen_present();
+        do {
+            key = get_key();
+        } while ((key != QUIT) && (key != CHOOSE) && (key != ROLL) &&
+                 (key != SCORE) && (key != KEYS_EOF));
+
+        // Do what the user asked
+        if ((key == QUIT) || (key == KEYS_EOF)) {
+            return false;
+        } else if (key == CHOOSE) {
+            choose_dice(game, status);
+        } else if (key == ROLL) {
+            play_roll(game);
         } else {
-            while (ch == '\n') {
-                // Display the score and the dice
-                screen_clear();
-                score_display();
-                display_menu();
-                printf("\nDice (black to keep): ");
-                show_dice();
-
-                // Prompt the user for an action to take, and then do it.
-                printf("\nAction: ");
-                ch = getc(stdin);
-            }
+            assign_score(game, status);
+        }
+    }
+
+    return true;
+
+}//end play_turn
+
+
+// ---------------------------------------------------------------------
+// Function
+//     play_yahtzee
+// Inputs
+//     game
+//         A game from play_new_game().
+// Outputs
+//     none
+// Description
+//     Plays the game with the user at the terminal, a turn at a time,
+//     until it is over or the user quits.
+// ---------------------------------------------------------------------
+void play_yahtzee(struct game_t *game)
+{
+    while (!play_over(game) && play_turn(game, NULL)) {
+        ;
+    }
+
+}//end play_yahtzee
+
+
+// ---------------------------------------------------------------------
+// Function
+//     play_load_rolls
+// Inputs
+//     path
+//         A table file written by ./rolls.
+// Outputs
+//     function result
+//         SUCCESS, or !SUCCESS if the file is missing or not a table of
+//         this version and shape (a message says which).
+// Description
+//     Maps the reroll probability tables read-only and shared, so all
+//     the games running on the machine use one copy of them in the
+//     page cache; pages are read from the file as they are first used.
+// ---------------------------------------------------------------------
+int play_load_rolls(const char *path)
+{
+    struct rolltab_header_t header;
+    struct stat info;
+    void *map;
+    int fd;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return !SUCCESS;
+    }
+    if ((fstat(fd, &info) != 0) || ((size_t)info.st_size != ROLLTAB_SIZE)) {
+        fprintf(stderr, "%s: not a roll table of the right size\n", path);
+        close(fd);
+        return !SUCCESS;
+    }
+    map = mmap(NULL, ROLLTAB_SIZE, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror(path);
+        return !SUCCESS;
+    }
+
+    memcpy(&header, map, sizeof(header));
+    if ((memcmp(header.magic, ROLLTAB_MAGIC, sizeof(header.magic)) != 0) ||
+        (header.version != ROLLTAB_VERSION) ||
+        (header.rerolls != ROLLTAB_REROLLS) ||
+        (header.keeps != REROLL_KEEPS) || (header.keys != SCORETAB_KEYS) ||
+        (header.row != ROLLTAB_ROW) || (header.offset != sizeof(header))) {
+        fprintf(stderr, "%s: wrong roll table version\n", path);
+        munmap(map, ROLLTAB_SIZE);
+        return !SUCCESS;
+    }
 
-            // Do what the user asked
-            if (toupper(ch) == QUIT) {
+    play_unload_rolls();
+    reroll_init();
+    Rolls_mapping = map;
+    Roll_chances  = (const void *)((const char *)map + header.offset);
+
+    return SUCCESS;
+
+}//end play_load_rolls
+
+
+// ---------------------------------------------------------------------
+// Function
+//     play_unload_rolls
+// Inputs
+//     none
+// Outputs
+//     none
+// ---------------------------------------------------------------------
+void play_unload_rolls(void)
+{
+    if (Rolls_mapping != NULL) {
+        munmap(Rolls_mapping, ROLLTAB_SIZE);
+        Rolls_mapping = NULL;
+        Roll_chances  = NULL;
+    }
+
+}//end play_unload_rolls
+
+
+// ---------------------------------------------------------------------
+// Function
+//     play_roll_chances
+// Inputs
+//     keep
+//         The dice kept, a REROLL keep number.
+//     rerolls
+//         1 or 2, the rerolls left.
+// Outputs
+//     function result
+//         The chance of every final roll, by SCORETAB key, or NULL if no
+//         table is mapped.
+// ---------------------------------------------------------------------
+const float *play_roll_chances(const int keep, const int rerolls)
+{
+    if (Roll_chances == NULL) {
+        return NULL;
+    }
+
+    return Roll_chances[rerolls - 1][keep];
+
+}//end play_roll_chances
+
+
+// ---------------------------------------------------------------------
+// Function
+//     play_verify_scores
+// Inputs
+//     none
+// Outputs
+//     function result
+// Description
+//     This function checks the SCORETAB module against the rules of the
+//     game in scan_score(): every ordered roll must map to the multiset
+//     of its dice, and every item of every multiset must have the same
+//     score in the table as by the rules. The packed dice state is
+//     checked the same way: changing one die at a time with set_die()
+//     must give the same state as building it from scratch, and
+//     packed_score() must agree with the rules. Every BATCH kernel the
+//     CPU supports must also score every ordered roll by the rules, and
+//     a mapped roll table must have the REROLL module's chances.
+//     Each difference is printed, and the number of differences is
+//     returned (zero when all is correct). It uses dice of its own,
+//     not those of a game.
+// ---------------------------------------------------------------------
+int play_verify_scores(void)
+{
+    struct game_t test;
+    struct game_t *game = &test;
+    unsigned char values[NUMBER_OF_DICE];
+    unsigned char sorted[NUMBER_OF_DICE];
+    static unsigned char batch_dice[NUMBER_OF_DICE][SCORETAB_ROLLS];
+    static unsigned char batch_scores[SCORETAB_ITEMS][SCORETAB_ROLLS];
+    uint32_t counts;
+    unsigned int faces;
+    int errors = 0;
+
+    scoretab_init();
+
+    // Walk every ordered roll changing the dice one at a time, and
+    // compare the packed state with one rebuilt from the same dice, and
+    // the key it gives with the key of the roll
+    memset(values, ACES, sizeof(values));
+    set_dice(game, values);
+    for (int index = 0; index < SCORETAB_ROLLS; ++index) {
+        int rest = index;
+
+        for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+            set_die(game, i, rest % NUMBER_OF_SIDES + 1);
+            rest /= NUMBER_OF_SIDES;
+            values[i] = game->dice[i].value;
+        }
+        counts = game->dice_counts;
+        faces  = game->dice_faces;
+        set_dice(game, values);
+        if ((counts != game->dice_counts) || (faces != game->dice_faces)) {
+            printf("Roll %i %i %i %i %i: packed state %08x/%02x, "
+                   "expected %08x/%02x\n", values[0], values[1],
+                   values[2], values[3], values[4], counts, faces,
+                   game->dice_counts, game->dice_faces);
+            ++errors;
+        }
+        if (play_dice_key(game) != scoretab_key(values)) {
+            printf("Roll %i %i %i %i %i: packed key %i, expected %i\n",
+                   values[0], values[1], values[2], values[3], values[4],
+                   play_dice_key(game), scoretab_key(values));
+            ++errors;
+        }
+    }
+
+    // Every ordered roll maps to the multiset of its dice
+    for (int index = 0; index < SCORETAB_ROLLS; ++index) {
+        int counts[NUMBER_OF_SIDES + 1] = { 0 };
+        int rest = index;
+
+        for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+            values[i] = rest % NUMBER_OF_SIDES + 1;
+            rest /= NUMBER_OF_SIDES;
+            ++counts[values[i]];
+        }
+        scoretab_dice(scoretab_key(values), sorted);
+        for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+            --counts[sorted[i]];
+        }
+        for (int face = ACES; face <= NUMBER_OF_SIDES; ++face) {
+            if (counts[face] != 0) {
+                printf("Roll %i %i %i %i %i has the wrong key %i\n",
+                       values[0], values[1], values[2], values[3],
+                       values[4], scoretab_key(values));
+                ++errors;
                 break;
-            } else if (toupper(ch) == CHOOSE) {
-                choose_dice();
-            } else if (toupper(ch) == ROLL) {
-                roll_dice();
-                ++Num_rolls;
-            } else if (toupper(ch) == SCORE) {
-                assign_score();
-                Num_rolls = 1;
-                ++Num_turns;
-                init_dice();
-            } else {
-                // Bad selection. Do nothing and loop back to prompt again
-                ;
             }
         }
+    }
 
-        // Reset the selection to nothing
-        ch = '\n';
+    // Every item of every multiset scores the same as by the rules
+    for (int key = 0; key < SCORETAB_KEYS; ++key) {
+        scoretab_dice(key, values);
+        set_dice(game, values);
+        for (int item = ACES; item <= CHANCE; ++item) {
+            if (scan_score(game, item) != scoretab_score(key, item)) {
+                printf("Dice %i %i %i %i %i item %2i: rules say %2i, "
+                       "table says %2i\n", values[0], values[1],
+                       values[2], values[3], values[4], item,
+                       scan_score(game, item), scoretab_score(key, item));
+                ++errors;
+            }
+            if (scan_score(game, item) != packed_score(game, item)) {
+                printf("Dice %i %i %i %i %i item %2i: rules say %2i, "
+                       "packed says %2i\n", values[0], values[1],
+                       values[2], values[3], values[4], item,
+                       scan_score(game, item), packed_score(game, item));
+                ++errors;
+            }
+        }
     }
 
-}//end play_yahtzee
+    // Every ordered roll scores the same in a batch as by the rules
+    for (int index = 0; index < SCORETAB_ROLLS; ++index) {
+        int rest = index;
+
+        for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+            batch_dice[i][index] = rest % NUMBER_OF_SIDES + 1;
+            rest /= NUMBER_OF_SIDES;
+        }
+    }
+    for (int kernel = 0; kernel < BATCH_KERNELS; ++kernel) {
+        if (!batch_supported(kernel)) {
+            continue;
+        }
+        memset(batch_scores, 0xff, sizeof(batch_scores));
+        for (int first = 0; first < SCORETAB_ROLLS; first += VERIFY_BATCH) {
+            const unsigned char *dice[NUMBER_OF_DICE];
+            unsigned char *scores[SCORETAB_ITEMS];
+            int hands = SCORETAB_ROLLS - first;
+
+            for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+                dice[i] = batch_dice[i] + first;
+            }
+            for (int item = 0; item < SCORETAB_ITEMS; ++item) {
+                scores[item] = batch_scores[item] + first;
+            }
+            batch_score(kernel, dice, scores,
+                        (hands < VERIFY_BATCH) ? hands : VERIFY_BATCH);
+        }
+        for (int index = 0; index < SCORETAB_ROLLS; ++index) {
+            for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+                values[i] = batch_dice[i][index];
+            }
+            set_dice(game, values);
+            for (int item = ACES; item <= CHANCE; ++item) {
+                if (scan_score(game, item) != batch_scores[item][index]) {
+                    printf("Dice %i %i %i %i %i item %2i: rules say %2i, "
+                           "%s batch says %2i\n", values[0], values[1],
+                           values[2], values[3], values[4], item,
+                           scan_score(game, item), batch_name(kernel),
+                           batch_scores[item][index]);
+                    ++errors;
+                }
+            }
+        }
+    }
+
+    // The mapped roll table agrees with the REROLL module's outcomes
+    for (int keep = 0; (Roll_chances != NULL) && (keep < REROLL_KEEPS);
+         ++keep) {
+        const float *table = play_roll_chances(keep, 1);
+        const short *keys;
+        const float *chances;
+        int outcomes = reroll_outcomes(keep, &keys, &chances);
+        float expected[ROLLTAB_ROW] = { 0 };
+
+        for (int i = 0; i < outcomes; ++i) {
+            expected[keys[i]] += chances[i];
+        }
+        for (int key = 0; key < ROLLTAB_ROW; ++key) {
+            float difference = table[key] - expected[key];
+
+            if ((difference > VERIFY_CHANCE) ||
+                (difference < -VERIFY_CHANCE)) {
+                printf("Keep %i roll %i: rerolling gives %.7f, roll table "
+                       "says %.7f\n", keep, key, expected[key], table[key]);
+                ++errors;
+            }
+        }
+    }
+
+    return errors;
+
+}//end play_verify_scores
+
+
+// ---------------------------------------------------------------------
+// Function
+//     play_benchmark
+// Inputs
+//     none
+// Outputs
+//     none
+// Description
+//     This function times scoring every item of every ordered roll,
+//     BENCH_PASSES times over, by scanning the dice (the old way), from
+//     the packed dice state, and from the SCORETAB table, and prints
+//     the cost of one item evaluation for each. Loading the dice is
+//     timed on its own and taken out of the figures. The sums of the
+//     scores are printed so the work cannot be optimized away, and
+//     must be the same for every method.
+// ---------------------------------------------------------------------
+void play_benchmark(void)
+{
+    struct game_t test;
+    struct game_t *game = &test;
+    static unsigned char rolls[SCORETAB_ROLLS][NUMBER_OF_DICE];
+    static const char *names[] = { "load only", "scan", "packed", "table" };
+    const int methods = sizeof(names) / sizeof(names[0]);
+    struct timespec start;
+    struct timespec stop;
+    long nsec[methods];
+    long sum[methods];
+    double evals = (double)BENCH_PASSES * SCORETAB_ROLLS * CHANCE;
+
+    scoretab_init();
+    for (int index = 0; index < SCORETAB_ROLLS; ++index) {
+        int rest = index;
+
+        for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+            rolls[index][i] = rest % NUMBER_OF_SIDES + 1;
+            rest /= NUMBER_OF_SIDES;
+        }
+    }
+
+    for (int method = 0; method < methods; ++method) {
+        sum[method] = 0;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int pass = 0; pass < BENCH_PASSES; ++pass) {
+            for (int index = 0; index < SCORETAB_ROLLS; ++index) {
+                set_dice(game, rolls[index]);
+                if (method == 0) {
+                    sum[method] += game->dice_faces;
+                    continue;
+                }
+                for (int item = ACES; item <= CHANCE; ++item) {
+                    if (method == 1) {
+                        sum[method] += scan_score(game, item);
+                    } else if (method == 2) {
+                        sum[method] += packed_score(game, item);
+                    } else {
+                        sum[method] += scoretab_score(
+                            scoretab_key(rolls[index]), item);
+                    }
+                }
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &stop);
+        nsec[method] = (stop.tv_sec - start.tv_sec) * NSEC_PER_SEC +
+                       (stop.tv_nsec - start.tv_nsec);
+    }
+
+    printf("%i passes x %i rolls x %i items\n", BENCH_PASSES,
+           SCORETAB_ROLLS, CHANCE);
+    printf("%-10s %10s %12s %12s\n", "method", "ms", "ns/item", "sum");
+    for (int method = 0; method < methods; ++method) {
+        printf("%-10s %10.1f %12.2f %12li\n", names[method],
+               nsec[method] / 1e6,
+               (method == 0) ? 0.0 : (nsec[method] - nsec[0]) / evals,
+               sum[method]);
+    }
+
+}//end play_benchmark
 
 // end play.c
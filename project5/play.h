@@ -10,6 +10,21 @@
 #ifndef PLAY_H
 #define PLAY_H
 
-extern void play_yahtzee(void);
+#include <stdbool.h>
+#include "game.h"
+
+extern void play_new_game(struct game_t *game);
+extern void play_roll(struct game_t *game);
+extern int  play_score(struct game_t *game, const int item);
+extern bool play_over(const struct game_t *game);
+extern int  play_rolls_left(const struct game_t *game);
+extern int  play_dice_key(const struct game_t *game);
+extern bool play_turn(struct game_t *game, const char *status);
+extern void play_yahtzee(struct game_t *game);
+extern int  play_load_rolls(const char *path);
+extern void play_unload_rolls(void);
+extern const float *play_roll_chances(const int keep, const int rerolls);
+extern int  play_verify_scores(void);
+extern void play_benchmark(void);
 
 #endif // PLAY_H
@@ -0,0 +1,536 @@
+// ----------------------------------------------------------------------
+// File: players.c
+//
+// Name: Jonathan Goohs
+//
+// Description: This is the implementation of the PLAYERS module of the
+//     YAHTZEE game. Every seat has a game_t of its own, so each player
+//     has their own scorecard (SCORE module) and their own stream of
+//     dice, and a turn is played with the same PLAY module as the
+//     solitaire game. A user's turn is played at the terminal with
+//     play_turn(), with the standings shown at the bottom of the
+//     screen.
+//
+//     The computer plays a turn by expected value with the SOLVER
+//     module, as ./sim -o does: optimally from ./solve's table when it
+//     is loaded, or else by the best expected score of the turn alone.
+//     Working that out takes a solver_turn() and a few lookups, which
+//     the user would notice, so every computer seat has a worker
+//     thread that plans its next turn ahead: while the users are still
+//     deciding, the worker plays the turn out on a copy of the seat's
+//     game and keeps the result. When the seat's turn comes it is
+//     taken from the copy at once.
+//
+//     A computer's turn depends on nothing but its own scorecard, dice
+//     and random stream, so the other players' moves never spoil a
+//     plan. The only shared state a plan is made from is the seat's
+//     game, which has a version: the plan records the version it was
+//     made from, taking the turn bumps it, and a plan of an older
+//     version is never used. The worker then starts on the next turn.
+// ----------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "play.h"
+#include "players.h"
+#include "reroll.h"
+#include "score.h"
+#include "scoretab.h"
+#include "solver.h"
+
+#define CACHE_LINE        64
+#define NO_VERSION        (~0ul)
+#define STATUS_SIZE       96        // the standings, on one screen row
+#define NAME_SIZE         8
+#define NSEC_PER_SEC      1000000000L
+#define NSEC_PER_USEC     1e3
+#define NSEC_PER_MSEC     1e6
+#define PERCENT           100.0
+
+
+// **************************************************************************
+// ****************************  DEFINED TYPES   ****************************
+// **************************************************************************
+
+// A seat at the game; aligned so the computers' workers never share a
+// cache line. Only the main thread changes game; the lock guards it
+// against the seat's worker reading it, and guards the rest.
+struct players_seat_t {
+    struct game_t   game;
+    bool            ai;
+    int             number;         // from 1, for the standings
+
+    // The computer's worker and its plan of the next turn
+    pthread_t       thread;
+    pthread_mutex_t lock;
+    pthread_cond_t  changed;        // a new version, a plan, or stop
+    unsigned long   version;        // of game
+    unsigned long   planned;        // the version plan was made from
+    struct game_t   plan;           // game after the next turn
+    bool            stop;
+
+    // How well planning ahead worked
+    unsigned long   turns;          // turns taken
+    unsigned long   ready;          // ... with the plan already made
+    unsigned long   plans;          // plans made
+    double          wait_ns;        // the main thread waited for plans
+    double          plan_ns;        // the worker took to make them
+} __attribute__((aligned(CACHE_LINE)));
+
+
+// **************************************************************************
+// **************************** GLOBAL VARIABLES ****************************
+// **************************************************************************
+
+static struct players_seat_t Seats[PLAYERS_MAX];
+static int  Count = 0;              // # seats taken
+static bool Quit  = false;          // a user quit the game
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     elapsed
+// Inputs
+//     start
+//         A time from CLOCK_MONOTONIC.
+// Outputs
+//     function result
+//         The nanoseconds since then.
+// ---------------------------------------------------------------------
+static double elapsed(const struct timespec *start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) * NSEC_PER_SEC +
+           (now.tv_nsec - start->tv_nsec);
+
+}//end elapsed
+
+
+// ---------------------------------------------------------------------
+// Function
+//     keep_dice
+// Inputs
+//     keep
+//         The REROLL keep chosen by the solver.
+// Outputs
+//     game
+//         The dice that make up the keep are kept, one die per kept
+//         value, and the others are to be rolled.
+// ---------------------------------------------------------------------
+static void keep_dice(const int keep, struct game_t *game)
+{
+    unsigned char kept[NUMBER_OF_DICE];
+    int count = reroll_size(keep);
+
+    reroll_dice(keep, kept);
+    for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+        game->dice[i].keep = false;
+        for (int k = 0; k < count; ++k) {
+            if (kept[k] == game->dice[i].value) {
+                game->dice[i].keep = true;
+                kept[k] = 0;             // each kept value is used once
+                break;
+            }
+        }
+    }
+
+}//end keep_dice
+
+
+// ---------------------------------------------------------------------
+// Function
+//     ai_turn
+// Inputs
+//     game
+//         A game at the start of a turn.
+// Outputs
+//     game
+//         The game after the computer has played the turn.
+// Description
+//     Rerolls for the best expected final score while that means
+//     rolling anything, then scores in the best item.
+// ---------------------------------------------------------------------
+static void ai_turn(struct game_t *game)
+{
+    struct solver_turn_t plan;       // the solver's values of the turn
+    unsigned int used;
+    int upper;
+    int total;
+
+    score_state(game, &used, &upper, &total);
+    solver_turn(used, upper, &plan);
+    for (int left = play_rolls_left(game); left > 0; --left) {
+        int keep = solver_best_keep(&plan, play_dice_key(game), left);
+
+        if (reroll_size(keep) == NUMBER_OF_DICE) {
+            break;
+        }
+        keep_dice(keep, game);
+        play_roll(game);
+    }
+    play_score(game, solver_best_item(used, upper, play_dice_key(game)));
+
+}//end ai_turn
+
+
+// ---------------------------------------------------------------------
+// Function
+//     run_ai
+// Inputs
+//     arg
+//         A computer's seat.
+// Outputs
+//     function result (always NULL)
+// Description
+//     The worker thread of a computer: whenever the seat's game has a
+//     version with no plan, plays the next turn out on a copy of it
+//     and keeps the result as the plan, unless the game has changed in
+//     the meantime.
+// ---------------------------------------------------------------------
+static void *run_ai(void *arg)
+{
+    struct players_seat_t *seat = arg;
+    struct game_t game;
+    struct timespec start;
+    unsigned long version;
+
+    pthread_mutex_lock(&seat->lock);
+    while (!seat->stop) {
+        if ((seat->planned == seat->version) || play_over(&seat->game)) {
+            pthread_cond_wait(&seat->changed, &seat->lock);
+            continue;
+        }
+        game = seat->game;
+        version = seat->version;
+        pthread_mutex_unlock(&seat->lock);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        ai_turn(&game);
+
+        pthread_mutex_lock(&seat->lock);
+        ++seat->plans;
+        seat->plan_ns += elapsed(&start);
+        if (seat->version == version) {
+            seat->plan = game;
+            seat->planned = version;
+            pthread_cond_broadcast(&seat->changed);
+        }
+    }
+    pthread_mutex_unlock(&seat->lock);
+
+    return NULL;
+
+}//end run_ai
+
+
+// ---------------------------------------------------------------------
+// Function
+//     take_ai_turn
+// Inputs
+//     seat
+//         A computer's seat.
+// Outputs
+//     none
+// Description
+//     Plays the computer's turn from its plan, waiting for the plan if
+//     the worker has not finished it yet, and lets the worker start on
+//     the next one.
+// ---------------------------------------------------------------------
+static void take_ai_turn(struct players_seat_t *seat)
+{
+    struct timespec start;
+
+    pthread_mutex_lock(&seat->lock);
+    if (seat->planned == seat->version) {
+        ++seat->ready;
+    } else {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        while (seat->planned != seat->version) {
+            pthread_cond_wait(&seat->changed, &seat->lock);
+        }
+        seat->wait_ns += elapsed(&start);
+    }
+    ++seat->turns;
+    seat->game = seat->plan;
+    ++seat->version;
+    pthread_cond_broadcast(&seat->changed);
+    pthread_mutex_unlock(&seat->lock);
+
+}//end take_ai_turn
+
+
+// ---------------------------------------------------------------------
+// Function
+//     total_of
+// Inputs
+//     seat
+// Outputs
+//     function result
+//         The seat's grand total so far.
+// ---------------------------------------------------------------------
+static int total_of(const struct players_seat_t *seat)
+{
+    unsigned int used;
+    int upper;
+    int total;
+
+    score_state(&seat->game, &used, &upper, &total);
+    return total;
+
+}//end total_of
+
+
+// ---------------------------------------------------------------------
+// Function
+//     standings
+// Inputs
+//     turn
+//         The seat whose turn it is.
+// Outputs
+//     status
+//         Every player's total on one line, the player to move marked.
+// ---------------------------------------------------------------------
+static void standings(const int turn, char status[])
+{
+    int used = 0;
+
+    for (int s = 0; s < Count; ++s) {
+        used += snprintf(status + used, STATUS_SIZE - used, "%c%s%d %d ",
+                         (s == turn) ? '>' : ' ',
+                         Seats[s].ai ? "AI" : "P", Seats[s].number,
+                         total_of(&Seats[s]));
+    }
+
+}//end standings
+
+
+// **************************************************************************
+// *************************** EXTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     players_start
+// Inputs
+//     seats
+//         One letter per seat: PLAYERS_HUMAN or PLAYERS_AI.
+//     seed
+//         The seed of the dice; every seat has its own stream of it.
+// Outputs
+//     function result
+//         SUCCESS, or !SUCCESS if the seats are not valid or a worker
+//         can't be started.
+// Description
+//     Seats the players with new games, and starts the computers'
+//     workers, which begin planning their first turns right away.
+// ---------------------------------------------------------------------
+int players_start(const char *seats, const uint64_t seed)
+{
+    int count = strlen(seats);
+
+    if ((count < PLAYERS_MIN) || (count > PLAYERS_MAX)) {
+        return !SUCCESS;
+    }
+    for (int s = 0; s < count; ++s) {
+        if ((seats[s] != PLAYERS_HUMAN) && (seats[s] != PLAYERS_AI)) {
+            return !SUCCESS;
+        }
+    }
+
+    // The solver's tables are built once, before any worker uses them
+    reroll_init();
+
+    Quit = false;
+    for (Count = 0; Count < count; ++Count) {
+        struct players_seat_t *seat = &Seats[Count];
+
+        memset(seat, 0, sizeof(*seat));
+        seat->ai = (seats[Count] == PLAYERS_AI);
+        seat->number = Count + 1;
+        seat->planned = NO_VERSION;
+        rng_seed(&seat->game.rng, seed, Count);
+        play_new_game(&seat->game);
+        if (!seat->ai) {
+            continue;
+        }
+
+        pthread_mutex_init(&seat->lock, NULL);
+        pthread_cond_init(&seat->changed, NULL);
+        if (pthread_create(&seat->thread, NULL, run_ai, seat) != 0) {
+            // this seat has no thread to stop, only the seats before it
+            pthread_cond_destroy(&seat->changed);
+            pthread_mutex_destroy(&seat->lock);
+            players_stop();
+            return !SUCCESS;
+        }
+    }
+
+    return SUCCESS;
+
+}//end players_start
+
+
+// ---------------------------------------------------------------------
+// Function
+//     players_play
+// Inputs
+//     none
+// Outputs
+//     none
+// Description
+//     Plays rounds of turns, each seat in order, until every game is
+//     over or a user quits.
+// ---------------------------------------------------------------------
+void players_play(void)
+{
+    char status[STATUS_SIZE];
+    bool over = false;
+
+    while (!over && !Quit) {
+        over = true;
+        for (int s = 0; (s < Count) && !Quit; ++s) {
+            struct players_seat_t *seat = &Seats[s];
+
+            if (play_over(&seat->game)) {
+                continue;
+            }
+            over = false;
+            if (seat->ai) {
+                take_ai_turn(seat);
+            } else {
+                standings(s, status);
+                Quit = !play_turn(&seat->game, status);
+            }
+        }
+    }
+
+}//end players_play
+
+
+// ---------------------------------------------------------------------
+// Function
+//     players_stop
+// Inputs
+//     none
+// Outputs
+//     none
+// Description
+//     Stops the computers' workers; the games stay for the report.
+// ---------------------------------------------------------------------
+void players_stop(void)
+{
+    for (int s = 0; s < Count; ++s) {
+        struct players_seat_t *seat = &Seats[s];
+
+        if (!seat->ai || seat->stop) {
+            continue;
+        }
+        pthread_mutex_lock(&seat->lock);
+        seat->stop = true;
+        pthread_cond_broadcast(&seat->changed);
+        pthread_mutex_unlock(&seat->lock);
+        pthread_join(seat->thread, NULL);
+        pthread_cond_destroy(&seat->changed);
+        pthread_mutex_destroy(&seat->lock);
+    }
+
+}//end players_stop
+
+
+// ---------------------------------------------------------------------
+// Function
+//     players_count
+// Inputs
+//     none
+// Outputs
+//     function result
+//         The number of seats.
+// ---------------------------------------------------------------------
+int players_count(void)
+{
+    return Count;
+
+}//end players_count
+
+
+// ---------------------------------------------------------------------
+// Function
+//     players_game
+// Inputs
+//     seat
+//         From 0.
+// Outputs
+//     function result
+//         The seat's game.
+// ---------------------------------------------------------------------
+const struct game_t *players_game(const int seat)
+{
+    return &Seats[seat].game;
+
+}//end players_game
+
+
+// ---------------------------------------------------------------------
+// Function
+//     players_report
+// Inputs
+//     none
+// Outputs
+//     none
+// Description
+//     Prints the final standings, and how often the computers' turns
+//     were planned before they were due.
+// ---------------------------------------------------------------------
+void players_report(void)
+{
+    unsigned long turns = 0;
+    unsigned long ready = 0;
+    unsigned long plans = 0;
+    double wait_ns = 0;
+    double plan_ns = 0;
+    int best = 0;
+
+    for (int s = 0; s < Count; ++s) {
+        if (total_of(&Seats[s]) > best) {
+            best = total_of(&Seats[s]);
+        }
+    }
+    printf("%-8s %5s %5s %7s\n", "Player", "Turns", "Bonus", "Total");
+    for (int s = 0; s < Count; ++s) {
+        const struct players_seat_t *seat = &Seats[s];
+        char name[NAME_SIZE];
+
+        snprintf(name, sizeof(name), "%s%d", seat->ai ? "AI" : "P",
+                 seat->number);
+        printf("%-8s %5d %5d %7d%s\n", name, seat->game.num_turns - 1,
+               seat->game.bonus, total_of(seat),
+               (total_of(seat) == best) ? "  wins" : "");
+
+        turns   += seat->turns;
+        ready   += seat->ready;
+        plans   += seat->plans;
+        wait_ns += seat->wait_ns;
+        plan_ns += seat->plan_ns;
+    }
+
+    if (turns > 0) {
+        printf("Computer turns: %lu, %lu (%.0f%%) planned before they "
+               "were due; waited %.2f ms in all\n", turns, ready,
+               PERCENT * ready / turns, wait_ns / NSEC_PER_MSEC);
+        printf("Planning took %.0f us a turn on the workers\n",
+               plans ? plan_ns / plans / NSEC_PER_USEC : 0.0);
+    }
+
+}//end players_report
+
+// end players.c
@@ -0,0 +1,30 @@
+// -------------------------------------------------------------------
+// File: players.h
+//
+// Name: Jonathan Goohs
+//
+// Description: This is the header file for the PLAYERS module of the
+//     YAHTZEE game. It seats 2 to 8 players at one game, each with a
+//     scorecard and dice of their own; a seat is played by a user at
+//     the terminal or by the computer. The players take their turns
+//     in order, and the highest grand total wins.
+// -------------------------------------------------------------------
+#ifndef PLAYERS_H
+#define PLAYERS_H
+
+#include <stdint.h>
+#include "game.h"
+
+#define PLAYERS_MIN      2
+#define PLAYERS_MAX      8
+#define PLAYERS_HUMAN   'h'     // the seats, e.g. "hah"
+#define PLAYERS_AI      'a'
+
+extern int  players_start(const char *seats, const uint64_t seed);
+extern void players_play(void);
+extern void players_stop(void);
+extern int  players_count(void);
+extern const struct game_t *players_game(const int seat);
+extern void players_report(void);
+
+#endif
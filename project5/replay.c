@@ -0,0 +1,293 @@
+// ----------------------------------------------------------------------
+// File: replay.c
+//
+// Name: Jonathan Goohs
+//
+// Description: This plays the games of a YAHTZEE game log (see
+//     gamelog.h) again, move by move, with the same PLAY and SCORE
+//     modules as the game itself.
+//
+//     Each game starts from the random stream recorded in its start
+//     record, so replaying the recorded keeps and items must roll the
+//     very dice that were recorded. Every roll is checked against the
+//     log, and a game whose dice differ is reported as a mismatch: the
+//     log is damaged, or the rules or the dice have changed since it
+//     was written.
+//
+// Syntax: ./replay [-g game] [-q] log
+//     -g  show this game (counting from 1) move by move
+//     -q  quiet: only the summary and the mismatches
+//
+// Resources:
+// 1. mmap man page
+// ----------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "gamelog.h"
+#include "play.h"
+#include "score.h"
+#include "scoretab.h"
+
+#define NSEC_PER_SEC      1000000000L
+
+// Short names of the items, for showing a game
+static const char *Item_names[CHANCE + 1] = {
+    "", "Aces", "Twos", "Threes", "Fours", "Fives", "Sixes",
+    "3 of a Kind", "4 of a Kind", "Full House", "Sm. Straight",
+    "Lg. Straight", "YAHTZEE", "Chance"
+};
+
+
+// **************************************************************************
+// ****************************  DEFINED TYPES   ****************************
+// **************************************************************************
+
+// How a replayed game ended
+enum replay_end_t {
+    REPLAY_FINISHED,
+    REPLAY_GIVEN_UP,
+    REPLAY_MISMATCH
+};
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     same_dice
+// Inputs
+//     game
+//         The game being replayed.
+//     values
+//         The dice recorded in the log.
+// Outputs
+//     function result
+//         Whether the game rolled the recorded dice.
+// ---------------------------------------------------------------------
+static bool same_dice(const struct game_t *game, const unsigned char values[])
+{
+    for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+        if (game->dice[i].value != values[i]) {
+            return false;
+        }
+    }
+
+    return true;
+
+}//end same_dice
+
+
+// ---------------------------------------------------------------------
+// Function
+//     show_dice
+// Inputs
+//     game
+//         The game being shown.
+// Outputs
+//     none
+// Description
+//     Prints the dice, with the kept ones in brackets.
+// ---------------------------------------------------------------------
+static void show_dice(const struct game_t *game)
+{
+    for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+        printf(game->dice[i].keep ? " [%d]" : "  %d ", game->dice[i].value);
+    }
+    printf("\n");
+
+}//end show_dice
+
+
+// ---------------------------------------------------------------------
+// Function
+//     replay_game
+// Inputs
+//     map
+//         The mapped log.
+//     offset
+//         Where the game starts.
+//     show
+//         Whether to print the game move by move.
+// Outputs
+//     game
+//         The game as replayed.
+//     moves
+//         The number of moves replayed.
+//     function result
+//         How the game ended.
+// ---------------------------------------------------------------------
+static enum replay_end_t replay_game(const struct gamelog_map_t *map,
+                                     const size_t offset, const bool show,
+                                     struct game_t *game, long *moves)
+{
+    struct gamelog_game_t start;
+    struct gamelog_move_t move;
+    const unsigned char *record;
+
+    *moves = 0;
+    if (gamelog_game(map, offset, &start) != SUCCESS) {
+        return REPLAY_MISMATCH;
+    }
+
+    // The same stream rolls the same first dice
+    game->rng = start.rng;
+    play_new_game(game);
+    if (show) {
+        printf("Turn  1 roll 1:");
+        show_dice(game);
+    }
+    if (!same_dice(game, start.dice)) {
+        return REPLAY_MISMATCH;
+    }
+
+    for (record = start.moves; record < start.end; ++*moves) {
+        record = gamelog_move(record, start.end, &move);
+
+        if (move.type == GAMELOG_ROLL_MOVE) {
+            if (play_over(game) || (play_rolls_left(game) == 0)) {
+                return REPLAY_MISMATCH;
+            }
+            for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+                game->dice[i].keep = (move.keep >> i) & 1;
+            }
+            play_roll(game);
+            if (show) {
+                printf("Turn %2d roll %d:", game->num_turns, game->num_rolls);
+                show_dice(game);
+            }
+            if (!same_dice(game, move.dice)) {
+                return REPLAY_MISMATCH;
+            }
+        } else if (move.type == GAMELOG_SCORE_MOVE) {
+            int before = game->score[move.item].value;
+
+            if (play_over(game) || (play_score(game, move.item) != SUCCESS)) {
+                return REPLAY_MISMATCH;
+            }
+            if (show) {
+                printf("%15s %-14s %3d\n", "score",
+                       Item_names[move.item],
+                       game->score[move.item].value - before);
+                if (!play_over(game)) {
+                    printf("Turn %2d roll 1:", game->num_turns);
+                    show_dice(game);
+                }
+            }
+            if (!play_over(game) && !same_dice(game, move.dice)) {
+                return REPLAY_MISMATCH;
+            }
+        } else if (move.type == GAMELOG_QUIT_MOVE) {
+            return play_over(game) ? REPLAY_MISMATCH : REPLAY_GIVEN_UP;
+        } else {
+            return REPLAY_MISMATCH;
+        }
+    }
+
+    return play_over(game) ? REPLAY_FINISHED : REPLAY_MISMATCH;
+
+}//end replay_game
+
+
+// **************************************************************************
+// *********************************  MAIN  *********************************
+// **************************************************************************
+
+int main(int argc, char *argv[])
+{
+    static const char *ends[] = { "finished", "given up", "MISMATCH" };
+    struct gamelog_map_t map;
+    struct game_t game;
+    struct timespec start;
+    struct timespec stop;
+    size_t *offsets;
+    long shown = 0;
+    bool quiet = false;
+    long games;
+    long counts[REPLAY_MISMATCH + 1] = { 0 };
+    long total_moves = 0;
+    double points = 0;
+    double seconds;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "g:q")) != -1) {
+        switch (opt) {
+        case 'g':
+            shown = atol(optarg);
+            break;
+        case 'q':
+            quiet = true;
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-g game] [-q] log\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (optind != argc - 1) {
+        fprintf(stderr, "Usage: %s [-g game] [-q] log\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (gamelog_map(&map, argv[optind]) != SUCCESS) {
+        fprintf(stderr, "%s: %s is not a game log\n", argv[0], argv[optind]);
+        return EXIT_FAILURE;
+    }
+
+    scoretab_init();
+    games = gamelog_index(&map, NULL);
+    offsets = malloc((games + 1) * sizeof(*offsets));
+    if (offsets == NULL) {
+        perror("malloc");
+        return EXIT_FAILURE;
+    }
+    gamelog_index(&map, offsets);
+    memset(&game, 0, sizeof(game));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long g = 0; g < games; ++g) {
+        long moves;
+        bool show = (g + 1 == shown);
+        enum replay_end_t end;
+        unsigned int used;
+        int upper;
+        int total;
+
+        if (show) {
+            printf("Game %ld\n", g + 1);
+        }
+        end = replay_game(&map, offsets[g], show, &game, &moves);
+        score_state(&game, &used, &upper, &total);
+        ++counts[end];
+        total_moves += moves;
+        if (end == REPLAY_FINISHED) {
+            points += total;
+        }
+        if (show || (end == REPLAY_MISMATCH) || !quiet) {
+            printf("Game %ld: %s after %ld moves, %d points\n", g + 1,
+                   ends[end], moves, total);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    seconds = (stop.tv_sec - start.tv_sec) +
+              (double)(stop.tv_nsec - start.tv_nsec) / NSEC_PER_SEC;
+
+    printf("Replayed %ld games (%ld moves) from %zu bytes in %.3f s "
+           "(%.0f games/s)\n", games, total_moves, map.size, seconds,
+           games / seconds);
+    printf("Finished %ld, mean score %.2f; given up %ld; mismatches %ld\n",
+           counts[REPLAY_FINISHED],
+           counts[REPLAY_FINISHED] ? points / counts[REPLAY_FINISHED] : 0.0,
+           counts[REPLAY_GIVEN_UP], counts[REPLAY_MISMATCH]);
+
+    free(offsets);
+    gamelog_unmap(&map);
+
+    return (counts[REPLAY_MISMATCH] == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+}//end main
+
+// end replay.c
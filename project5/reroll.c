@@ -0,0 +1,489 @@
+// ----------------------------------------------------------------------
+// File: reroll.c
+//
+// Name: Jonathan Goohs
+//
+// Description: This is the implementation of the REROLL module of the
+//     YAHTZEE game. A "keep" is the multiset of dice held back before a
+//     reroll; there are 462 of them, from keeping nothing to keeping all
+//     five dice. They are numbered by size, so every keep of five dice
+//     (which is just a roll) comes after every smaller keep.
+//
+//     The tables built here let the expected value of every keep be
+//     worked out in one backward sweep: rolling n dice is rolling one
+//     die and then n-1 more, so the value of a keep is the average of
+//     the values of the six keeps with one more die (its "children").
+//     Each roll also lists the distinct keeps that can be taken from
+//     it, which is where the best keep is chosen.
+//
+//     Finally, every keep has its transition table: the rolls that
+//     rerolling the other dice can end in, and the chance of each. This
+//     prices a single keep directly, without the sweep over all keeps.
+// ----------------------------------------------------------------------
+#include <stdbool.h>
+#include "play.h"
+#include "score.h"
+#include "scoretab.h"
+#include "reroll.h"
+
+#define KEEP_CODES    46656     // 6^6: a count (0 thru 5) per face
+#define ALL_DICE      ((1 << NUMBER_OF_DICE) - 1)
+
+// **************************************************************************
+// **************************** GLOBAL VARIABLES ****************************
+// **************************************************************************
+
+// How many of each face (index 0 is ACES) every keep holds
+static unsigned char Keep_counts[REROLL_KEEPS][NUMBER_OF_SIDES];
+static unsigned char Keep_size[REROLL_KEEPS];
+
+// The keep with one more die of each face; REROLL_NONE for five dice
+static short Keep_child[REROLL_KEEPS][NUMBER_OF_SIDES];
+
+// Keeps of five dice and the SCORETAB roll keys are the same multisets
+static short Keep_roll[REROLL_KEEPS];
+static short Roll_keep[SCORETAB_KEYS];
+
+// The distinct keeps that can be taken from every roll
+static short         Sub_keeps[SCORETAB_KEYS][REROLL_SUBKEEPS];
+static unsigned char Sub_count[SCORETAB_KEYS];
+
+// The chance of every roll of five dice
+static double Roll_probability[SCORETAB_KEYS];
+
+// The keep of every count code
+static short Code_keep[KEEP_CODES];
+
+// The transition tables: the outcomes of keep k are entries
+// Outcome_start[k] thru Outcome_start[k + 1] - 1
+static short Outcome_start[REROLL_KEEPS + 1];
+static short Outcome_key[REROLL_OUTCOMES];
+static float Outcome_probability[REROLL_OUTCOMES];
+
+static bool Tables_ready = false;
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     counts_code
+// Inputs
+//     counts
+//         How many dice show each face (index 0 is ACES).
+// Outputs
+//     function result
+// Description
+//     Returns the counts read as the digits of a base 6 number, which
+//     is the index of the multiset in Code_keep.
+// ---------------------------------------------------------------------
+static int counts_code(const unsigned char counts[])
+{
+    int code = 0;
+
+    for (int face = 0; face < NUMBER_OF_SIDES; ++face) {
+        code = code * NUMBER_OF_SIDES + counts[face];
+    }
+
+    return code;
+
+}//end counts_code
+
+
+// ---------------------------------------------------------------------
+// Function
+//     add_keeps
+// Inputs
+//     counts
+//         The counts chosen so far for faces before "face".
+//     face
+//         The next face to choose a count for.
+//     left
+//         How many dice still have to be placed.
+//     next
+//         The number to give the next keep.
+// Outputs
+//     function result
+//         The number to give the keep after the last one added.
+// Description
+//     Adds every keep whose counts start with "counts" and hold exactly
+//     "left" more dice, in increasing order of their count codes.
+// ---------------------------------------------------------------------
+static int add_keeps(unsigned char counts[], const int face, const int left,
+                     int next)
+{
+    if (face == NUMBER_OF_SIDES - 1) {
+        counts[face] = left;
+        for (int f = 0; f < NUMBER_OF_SIDES; ++f) {
+            Keep_counts[next][f] = counts[f];
+            Keep_size[next] += counts[f];
+        }
+        Code_keep[counts_code(counts)] = next;
+        return next + 1;
+    }
+
+    for (int count = 0; count <= left; ++count) {
+        counts[face] = count;
+        next = add_keeps(counts, face + 1, left - count, next);
+    }
+
+    return next;
+
+}//end add_keeps
+
+
+// ---------------------------------------------------------------------
+// Function
+//     arrangements
+// Inputs
+//     keep
+//         A keep number.
+// Outputs
+//     function result
+// Description
+//     Returns the number of different orders its dice can come up in,
+//     n! / (c1! c2! ... c6!) for n dice with c of each face.
+// ---------------------------------------------------------------------
+static int arrangements(const int keep)
+{
+    int ways = 1;
+
+    for (int i = 2; i <= Keep_size[keep]; ++i) {
+        ways *= i;
+    }
+    for (int face = 0; face < NUMBER_OF_SIDES; ++face) {
+        for (int i = 2; i <= Keep_counts[keep][face]; ++i) {
+            ways /= i;
+        }
+    }
+
+    return ways;
+
+}//end arrangements
+
+
+// ---------------------------------------------------------------------
+// Function
+//     add_outcomes
+// Inputs
+//     none
+// Outputs
+//     none
+// Description
+//     Builds the transition tables. The dice rerolled from a keep of n
+//     dice are any keep of 5 - n dice, which comes up with chance
+//     arrangements / 6^(5 - n); added to the kept dice, it is a roll.
+// ---------------------------------------------------------------------
+static void add_outcomes(void)
+{
+    unsigned char counts[NUMBER_OF_SIDES];
+    int next = 0;
+
+    for (int keep = 0; keep < REROLL_KEEPS; ++keep) {
+        int rolled = NUMBER_OF_DICE - Keep_size[keep];
+        double orders = 1;
+
+        for (int i = 0; i < rolled; ++i) {
+            orders *= NUMBER_OF_SIDES;
+        }
+        Outcome_start[keep] = next;
+        for (int extra = 0; extra < REROLL_KEEPS; ++extra) {
+            if (Keep_size[extra] != rolled) {
+                continue;
+            }
+            for (int face = 0; face < NUMBER_OF_SIDES; ++face) {
+                counts[face] = Keep_counts[keep][face] +
+                               Keep_counts[extra][face];
+            }
+            Outcome_key[next] = Keep_roll[Code_keep[counts_code(counts)]];
+            Outcome_probability[next] = arrangements(extra) / orders;
+            ++next;
+        }
+    }
+    Outcome_start[REROLL_KEEPS] = next;
+
+}//end add_outcomes
+
+
+// **************************************************************************
+// *************************** EXTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     reroll_init
+// Inputs
+//     none
+// Outputs
+//     none
+// Description
+//     Builds the tables; SCORETAB is initialized first. Calling this
+//     more than once does nothing.
+// ---------------------------------------------------------------------
+void reroll_init(void)
+{
+    unsigned char counts[NUMBER_OF_SIDES];
+    unsigned char values[NUMBER_OF_DICE];
+    double rolls = 1;
+    int next = 0;
+
+    if (Tables_ready) {
+        return;
+    }
+    scoretab_init();
+
+    // Number the keeps, smallest first
+    for (int size = 0; size <= NUMBER_OF_DICE; ++size) {
+        next = add_keeps(counts, 0, size, next);
+    }
+
+    // Link each keep to the keeps with one more die
+    for (int keep = 0; keep < REROLL_KEEPS; ++keep) {
+        Keep_roll[keep] = REROLL_NONE;
+        for (int face = 0; face < NUMBER_OF_SIDES; ++face) {
+            Keep_child[keep][face] = REROLL_NONE;
+            if (Keep_size[keep] < NUMBER_OF_DICE) {
+                for (int f = 0; f < NUMBER_OF_SIDES; ++f) {
+                    counts[f] = Keep_counts[keep][f] + (f == face);
+                }
+                Keep_child[keep][face] = Code_keep[counts_code(counts)];
+            }
+        }
+    }
+
+    for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+        rolls *= NUMBER_OF_SIDES;
+    }
+
+    for (int key = 0; key < SCORETAB_KEYS; ++key) {
+        // The matching keep of five dice, and the chance of the roll
+        scoretab_dice(key, values);
+        Roll_keep[key] = reroll_keep_of(values, NUMBER_OF_DICE);
+        Keep_roll[Roll_keep[key]] = key;
+        Roll_probability[key] = arrangements(Roll_keep[key]) / rolls;
+
+        // Every subset of the dice, without repeating a multiset
+        Sub_count[key] = 0;
+        for (int mask = 0; mask <= ALL_DICE; ++mask) {
+            unsigned char kept[NUMBER_OF_DICE];
+            int count = 0;
+            int keep;
+            bool seen = false;
+
+            for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+                if (mask & (1 << i)) {
+                    kept[count++] = values[i];
+                }
+            }
+            keep = reroll_keep_of(kept, count);
+            for (int i = 0; i < Sub_count[key]; ++i) {
+                seen |= (Sub_keeps[key][i] == keep);
+            }
+            if (!seen) {
+                Sub_keeps[key][Sub_count[key]++] = keep;
+            }
+        }
+    }
+
+    add_outcomes();
+
+    Tables_ready = true;
+
+}//end reroll_init
+
+
+// ---------------------------------------------------------------------
+// Function
+//     reroll_size
+// Inputs
+//     keep
+//         A keep number (0 thru 461).
+// Outputs
+//     function result
+// Description
+//     Returns the number of dice in the keep.
+// ---------------------------------------------------------------------
+int reroll_size(const int keep)
+{
+    return Keep_size[keep];
+
+}//end reroll_size
+
+
+// ---------------------------------------------------------------------
+// Function
+//     reroll_child
+// Inputs
+//     keep
+//         A keep of fewer than five dice.
+//     face
+//         A die value (1 thru 6).
+// Outputs
+//     function result
+// Description
+//     Returns the keep with one more die showing "face", or REROLL_NONE
+//     if the keep already holds five dice. A child always has a higher
+//     number than its parent.
+// ---------------------------------------------------------------------
+int reroll_child(const int keep, const int face)
+{
+    return Keep_child[keep][face - 1];
+
+}//end reroll_child
+
+
+// ---------------------------------------------------------------------
+// Function
+//     reroll_roll_keep
+// Inputs
+//     key
+//         A SCORETAB roll key.
+// Outputs
+//     function result
+// Description
+//     Returns the keep of all five dice of the roll.
+// ---------------------------------------------------------------------
+int reroll_roll_keep(const int key)
+{
+    return Roll_keep[key];
+
+}//end reroll_roll_keep
+
+
+// ---------------------------------------------------------------------
+// Function
+//     reroll_keep_roll
+// Inputs
+//     keep
+//         A keep number.
+// Outputs
+//     function result
+// Description
+//     Returns the SCORETAB roll key of a keep of five dice, or
+//     REROLL_NONE for a smaller keep.
+// ---------------------------------------------------------------------
+int reroll_keep_roll(const int keep)
+{
+    return Keep_roll[keep];
+
+}//end reroll_keep_roll
+
+
+// ---------------------------------------------------------------------
+// Function
+//     reroll_keep_of
+// Inputs
+//     values
+//         The kept dice, in any order.
+//     count
+//         How many dice are kept (0 thru 5).
+// Outputs
+//     function result
+// Description
+//     Returns the number of the keep holding those dice.
+// ---------------------------------------------------------------------
+int reroll_keep_of(const unsigned char values[], const int count)
+{
+    unsigned char counts[NUMBER_OF_SIDES] = { 0 };
+
+    for (int i = 0; i < count; ++i) {
+        ++counts[values[i] - 1];
+    }
+
+    return Code_keep[counts_code(counts)];
+
+}//end reroll_keep_of
+
+
+// ---------------------------------------------------------------------
+// Function
+//     reroll_dice
+// Inputs
+//     keep
+//         A keep number.
+// Outputs
+//     values
+//         The kept dice in increasing order; reroll_size(keep) of them.
+// Description
+//     This is the inverse of reroll_keep_of().
+// ---------------------------------------------------------------------
+void reroll_dice(const int keep, unsigned char values[])
+{
+    int i = 0;
+
+    for (int face = 0; face < NUMBER_OF_SIDES; ++face) {
+        for (int n = 0; n < Keep_counts[keep][face]; ++n) {
+            values[i++] = face + 1;
+        }
+    }
+
+}//end reroll_dice
+
+
+// ---------------------------------------------------------------------
+// Function
+//     reroll_subkeeps
+// Inputs
+//     key
+//         A SCORETAB roll key.
+// Outputs
+//     keeps
+//         Points to the distinct keeps that can be taken from the roll,
+//         including keeping nothing and keeping everything.
+//     function result
+//         The number of keeps.
+// ---------------------------------------------------------------------
+int reroll_subkeeps(const int key, const short **keeps)
+{
+    *keeps = Sub_keeps[key];
+
+    return Sub_count[key];
+
+}//end reroll_subkeeps
+
+
+// ---------------------------------------------------------------------
+// Function
+//     reroll_probability
+// Inputs
+//     key
+//         A SCORETAB roll key.
+// Outputs
+//     function result
+// Description
+//     Returns the chance of rolling the multiset with five fresh dice.
+// ---------------------------------------------------------------------
+double reroll_probability(const int key)
+{
+    return Roll_probability[key];
+
+}//end reroll_probability
+
+
+// ---------------------------------------------------------------------
+// Function
+//     reroll_outcomes
+// Inputs
+//     keep
+//         A keep number.
+// Outputs
+//     keys, probabilities
+//         Point to the rolls that keeping the dice and rerolling the
+//         others can end in, and the chance of each (they add to 1).
+//     function result
+//         The number of outcomes: 1 for a keep of five dice, 252 for
+//         keeping nothing.
+// ---------------------------------------------------------------------
+int reroll_outcomes(const int keep, const short **keys,
+                    const float **probabilities)
+{
+    *keys          = &Outcome_key[Outcome_start[keep]];
+    *probabilities = &Outcome_probability[Outcome_start[keep]];
+
+    return Outcome_start[keep + 1] - Outcome_start[keep];
+
+}//end reroll_outcomes
+
+// end reroll.c
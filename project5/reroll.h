@@ -0,0 +1,31 @@
+// -------------------------------------------------------------------
+// File: reroll.h
+//
+// Name: Jonathan Goohs
+//
+// Description: This is the header file for the REROLL module of the
+//     YAHTZEE game. It numbers every multiset of kept dice (zero to
+//     five dice) and links them, so the value of a keep can be worked
+//     out from the rolls it may turn into.
+// -------------------------------------------------------------------
+#ifndef REROLL_H
+#define REROLL_H
+
+#define REROLL_KEEPS      462   // # multisets of zero to five dice
+#define REROLL_SUBKEEPS    32   // at most 2^5 ways to keep from a roll
+#define REROLL_OUTCOMES  4368   // (keep, resulting roll) pairs
+#define REROLL_NONE       (-1)
+
+extern void   reroll_init(void);
+extern int    reroll_size(const int keep);
+extern int    reroll_child(const int keep, const int face);
+extern int    reroll_roll_keep(const int key);
+extern int    reroll_keep_roll(const int keep);
+extern int    reroll_keep_of(const unsigned char values[], const int count);
+extern void   reroll_dice(const int keep, unsigned char values[]);
+extern int    reroll_subkeeps(const int key, const short **keeps);
+extern double reroll_probability(const int key);
+extern int    reroll_outcomes(const int keep, const short **keys,
+                              const float **probabilities);
+
+#endif
@@ -0,0 +1,431 @@
+// ----------------------------------------------------------------------
+// File: rng.c
+//
+// Name: Jonathan Goohs
+//
+// Description: This is the implementation of the RNG module of the
+//     YAHTZEE game. The generator is xoshiro256** (Blackman & Vigna):
+//     256 bits of state, a period of 2^256 - 1, and a handful of shifts
+//     and rotates per 64-bit word. random() keeps one state for the
+//     whole process behind a lock and can't be replayed per game; here
+//     every game has its own state, seeded from (seed, stream) with
+//     splitmix64, so games on different threads share nothing and a
+//     game can be played again from its seed.
+//
+//     Dice are unbiased: rng_die() uses Lemire's multiply-and-reject,
+//     and rng_dice() takes a byte per die, throwing away bytes of 252
+//     and up (252 is the largest multiple of 6 that fits in a byte).
+//     rng_dice() turns 32 bytes into dice at a time with GCC vector
+//     extensions, which the compiler maps to whatever SIMD the target
+//     has.
+//
+// Resources:
+// 1. https://prng.di.unimi.it/
+// 2. Lemire, "Fast Random Integer Generation in an Interval", 2019
+// ----------------------------------------------------------------------
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "game.h"
+#include "rng.h"
+
+#define GOLDEN_GAMMA    0x9E3779B97F4A7C15ull   // splitmix64 increment
+#define DIE_THRESHOLD   ((1ull << 32) % NUMBER_OF_SIDES)
+#define BYTE_LIMIT      (256 / NUMBER_OF_SIDES * NUMBER_OF_SIDES)
+#define BLOCK_WORDS     4       // words turned into dice at a time
+#define BLOCK_BYTES     (BLOCK_WORDS * sizeof(uint64_t))
+#define BYTE_MASK       0xff
+#define DIV6_MULTIPLIER 171     // b / 6 == (b * 171) >> 10 for any byte b
+#define DIV6_SHIFT      10
+
+#define BENCH_DICE      (1L << 24)      // dice rolled per method and run
+#define BENCH_BUFFER    1024            // dice per rng_dice() call
+#define CACHE_LINE      64
+
+// ****  DEFINED TYPES ****
+
+// 32 bytes of random bits, as 16 lanes of two bytes each. There is no
+// byte multiply in SSE or AVX, so each byte gets a 16-bit lane of its
+// own for the divide by 6.
+typedef uint16_t rng_lanes_t __attribute__((vector_size(BLOCK_BYTES)));
+
+// The ways of rolling that rng_benchmark() compares
+enum bench_method_t {
+    BENCH_RANDOM,               // random(), as the game used to
+    BENCH_RAND_R,               // rand_r(), one state per thread
+    BENCH_RNG_DIE,              // rng_die(), a die at a time
+    BENCH_RNG_DICE,             // rng_dice(), in bulk
+    BENCH_METHODS
+};
+
+// A benchmark thread; aligned so threads never share a cache line
+struct bench_worker_t {
+    pthread_t           thread;
+    enum bench_method_t method;
+    long                dice;   // # dice to roll
+    uint64_t            seed;
+    long                sum;    // of the dice, so the work isn't dropped
+} __attribute__((aligned(CACHE_LINE)));
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     rotl
+// Inputs
+//     x, k
+//         A word, and how many bits to rotate it left (1 to 63).
+// Outputs
+//     function result
+// ---------------------------------------------------------------------
+static inline uint64_t rotl(const uint64_t x, const int k)
+{
+    return (x << k) | (x >> (64 - k));
+
+}//end rotl
+
+
+// ---------------------------------------------------------------------
+// Function
+//     splitmix64
+// Inputs
+//     x
+//         The splitmix64 state.
+// Outputs
+//     x
+//         The next state.
+//     function result
+//         A well mixed word, used to seed the xoshiro state.
+// ---------------------------------------------------------------------
+static uint64_t splitmix64(uint64_t *x)
+{
+    uint64_t z = (*x += GOLDEN_GAMMA);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+
+}//end splitmix64
+
+
+// ---------------------------------------------------------------------
+// Function
+//     take_bytes
+// Inputs
+//     word
+//         Random bits.
+//     count
+//         The most dice wanted.
+// Outputs
+//     values
+//         A die for every byte of the word below BYTE_LIMIT, up to
+//         count of them.
+//     function result
+//         The number of dice made.
+// ---------------------------------------------------------------------
+static int take_bytes(uint64_t word, unsigned char values[], const int count)
+{
+    int made = 0;
+
+    for (int i = 0; (i < (int)sizeof(word)) && (made < count); ++i) {
+        unsigned int byte = word & 0xff;
+
+        if (byte < BYTE_LIMIT) {
+            values[made++] = byte % NUMBER_OF_SIDES + 1;
+        }
+        word >>= 8;
+    }
+
+    return made;
+
+}//end take_bytes
+
+
+// ---------------------------------------------------------------------
+// Function
+//     bench_roll
+// Inputs
+//     arg
+//         The bench_worker_t of the thread.
+// Outputs
+//     function result
+//         NULL
+// Description
+//     The thread function of rng_benchmark(): rolls the worker's dice
+//     with its method and adds them up.
+// ---------------------------------------------------------------------
+static void *bench_roll(void *arg)
+{
+    struct bench_worker_t *worker = arg;
+    unsigned char values[BENCH_BUFFER];
+    unsigned int seed = worker->seed;
+    struct rng_t rng;
+    long sum = 0;
+
+    rng_seed(&rng, worker->seed, 0);
+    switch (worker->method) {
+    case BENCH_RANDOM:
+        for (long i = 0; i < worker->dice; ++i) {
+            sum += random() % NUMBER_OF_SIDES + 1;
+        }
+        break;
+    case BENCH_RAND_R:
+        for (long i = 0; i < worker->dice; ++i) {
+            sum += rand_r(&seed) % NUMBER_OF_SIDES + 1;
+        }
+        break;
+    case BENCH_RNG_DIE:
+        for (long i = 0; i < worker->dice; ++i) {
+            sum += rng_die(&rng);
+        }
+        break;
+    default:
+        for (long i = 0; i < worker->dice; i += BENCH_BUFFER) {
+            rng_dice(&rng, values, BENCH_BUFFER);
+            for (int j = 0; j < BENCH_BUFFER; ++j) {
+                sum += values[j];
+            }
+        }
+        break;
+    }
+    worker->sum = sum;
+
+    return NULL;
+
+}//end bench_roll
+
+
+// ---------------------------------------------------------------------
+// Function
+//     bench_run
+// Inputs
+//     method
+//         How to roll.
+//     threads
+//         How many threads share the BENCH_DICE dice.
+// Outputs
+//     function result
+//         Millions of dice rolled per second, over all the threads.
+// ---------------------------------------------------------------------
+static double bench_run(const enum bench_method_t method, const int threads)
+{
+    struct bench_worker_t workers[threads];
+    struct timespec start;
+    struct timespec stop;
+    double seconds;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int t = 0; t < threads; ++t) {
+        workers[t].method = method;
+        workers[t].dice   = BENCH_DICE / threads;
+        workers[t].seed   = t + 1;
+        if (pthread_create(&workers[t].thread, NULL, bench_roll,
+                           &workers[t]) != 0) {
+            perror("pthread_create");
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int t = 0; t < threads; ++t) {
+        pthread_join(workers[t].thread, NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+
+    seconds = (stop.tv_sec - start.tv_sec) +
+              (stop.tv_nsec - start.tv_nsec) / 1e9;
+    return (BENCH_DICE / threads) * threads / seconds / 1e6;
+
+}//end bench_run
+
+
+// **************************************************************************
+// *************************** EXTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     rng_seed
+// Inputs
+//     seed
+//         The seed, e.g. from --seed.
+//     stream
+//         Which stream of the seed, e.g. a thread or session number.
+// Outputs
+//     rng
+//         A state that always gives the same numbers for the same seed
+//         and stream.
+// ---------------------------------------------------------------------
+void rng_seed(struct rng_t *rng, const uint64_t seed, const uint64_t stream)
+{
+    uint64_t x = stream;
+
+    // Mix the stream in first, so seed s stream 1 is nothing like
+    // seed s+1 stream 0
+    x = seed ^ splitmix64(&x);
+    for (int i = 0; i < 4; ++i) {
+        rng->s[i] = splitmix64(&x);
+    }
+
+}//end rng_seed
+
+
+// ---------------------------------------------------------------------
+// Function
+//     rng_next
+// Inputs
+//     rng
+//         A seeded state.
+// Outputs
+//     rng
+//         The next state.
+//     function result
+//         64 random bits.
+// ---------------------------------------------------------------------
+uint64_t rng_next(struct rng_t *rng)
+{
+    uint64_t *s = rng->s;
+    const uint64_t result = rotl(s[1] * 5, 7) * 9;
+    const uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+
+    return result;
+
+}//end rng_next
+
+
+// ---------------------------------------------------------------------
+// Function
+//     rng_die
+// Inputs
+//     rng
+//         A seeded state.
+// Outputs
+//     function result
+//         A die from 1 to NUMBER_OF_SIDES, each equally likely.
+// Description
+//     Multiplies 32 random bits by 6; the top word is the die. The few
+//     low words below 2^32 mod 6 would make some faces more likely, so
+//     those are drawn again (4 in 2^32 of the time).
+// ---------------------------------------------------------------------
+int rng_die(struct rng_t *rng)
+{
+    uint64_t m;
+
+    do {
+        m = (rng_next(rng) >> 32) * NUMBER_OF_SIDES;
+    } while ((uint32_t)m < DIE_THRESHOLD);
+
+    return (int)(m >> 32) + 1;
+
+}//end rng_die
+
+
+// ---------------------------------------------------------------------
+// Function
+//     rng_dice
+// Inputs
+//     rng
+//         A seeded state.
+//     count
+//         How many dice to roll.
+// Outputs
+//     values
+//         count dice from 1 to NUMBER_OF_SIDES, each equally likely.
+// Description
+//     Each die takes a byte, so one word usually rolls a whole hand.
+//     While 32 or more dice are wanted, four words are turned into 32
+//     dice at once, the even and odd bytes in two vectors; the remainder
+//     by 6 is a multiply and a shift. A byte of 252 and up (about two
+//     blocks in five have one) makes that block fall back to copying
+//     the good bytes.
+// ---------------------------------------------------------------------
+void rng_dice(struct rng_t *rng, unsigned char values[], const int count)
+{
+    int made = 0;
+
+    while (count - made >= (int)BLOCK_BYTES) {
+        uint64_t words[BLOCK_WORDS];
+        uint64_t bad[BLOCK_WORDS];
+        unsigned char bytes[BLOCK_BYTES];
+        rng_lanes_t lanes;
+        rng_lanes_t even;
+        rng_lanes_t odd;
+        rng_lanes_t rejected;
+
+        for (int i = 0; i < BLOCK_WORDS; ++i) {
+            words[i] = rng_next(rng);
+        }
+        memcpy(&lanes, words, sizeof(lanes));
+        even = lanes & BYTE_MASK;
+        odd  = lanes >> 8;
+        rejected = (rng_lanes_t)((even >= BYTE_LIMIT) | (odd >= BYTE_LIMIT));
+        even -= ((even * DIV6_MULTIPLIER) >> DIV6_SHIFT) * NUMBER_OF_SIDES;
+        odd  -= ((odd  * DIV6_MULTIPLIER) >> DIV6_SHIFT) * NUMBER_OF_SIDES;
+        lanes = (even + 1) | ((odd + 1) << 8);
+
+        memcpy(bad, &rejected, sizeof(bad));
+        if ((bad[0] | bad[1] | bad[2] | bad[3]) == 0) {
+            memcpy(&values[made], &lanes, sizeof(lanes));
+            made += BLOCK_BYTES;
+        } else {
+            const unsigned char *random_bytes = (const unsigned char *)words;
+
+            memcpy(bytes, &lanes, sizeof(bytes));
+            for (int i = 0; i < (int)BLOCK_BYTES; ++i) {
+                values[made] = bytes[i];
+                made += (random_bytes[i] < BYTE_LIMIT);
+            }
+        }
+    }
+
+    while (made < count) {
+        made += take_bytes(rng_next(rng), &values[made], count - made);
+    }
+
+}//end rng_dice
+
+
+// ---------------------------------------------------------------------
+// Function
+//     rng_benchmark
+// Inputs
+//     none
+// Outputs
+//     none
+// Description
+//     Times rolling BENCH_DICE dice with random(), rand_r(), rng_die()
+//     and rng_dice(), on one thread and split over 16, and prints
+//     millions of dice per second for each.
+// ---------------------------------------------------------------------
+void rng_benchmark(void)
+{
+    static const char *names[BENCH_METHODS] = {
+        "random", "rand_r", "rng_die", "rng_dice"
+    };
+    static const int threads[] = { 1, 16 };
+
+    printf("\n%li dice, Mdice/s\n", BENCH_DICE);
+    printf("%-10s %12s %12s\n", "method", "1 thread", "16 threads");
+    for (int method = 0; method < BENCH_METHODS; ++method) {
+        printf("%-10s", names[method]);
+        for (int i = 0; i < (int)(sizeof(threads) / sizeof(threads[0]));
+             ++i) {
+            printf(" %12.1f", bench_run(method, threads[i]));
+        }
+        printf("\n");
+    }
+
+}//end rng_benchmark
+
+// end rng.c
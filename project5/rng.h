@@ -0,0 +1,29 @@
+// -------------------------------------------------------------------
+// File: rng.h
+//
+// Name: Jonathan Goohs
+//
+// Description: This is the header file for the RNG module of the
+//     YAHTZEE game: a small xoshiro256** random number generator. Each
+//     game carries its own rng_t, so rolling needs no lock, and the
+//     same seed and stream always give the same dice.
+// -------------------------------------------------------------------
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+// The state of one random stream
+struct rng_t {
+    uint64_t s[4];
+};
+
+extern void     rng_seed(struct rng_t *rng, const uint64_t seed,
+                         const uint64_t stream);
+extern uint64_t rng_next(struct rng_t *rng);
+extern int      rng_die(struct rng_t *rng);
+extern void     rng_dice(struct rng_t *rng, unsigned char values[],
+                         const int count);
+extern void     rng_benchmark(void);
+
+#endif
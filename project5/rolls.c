@@ -0,0 +1,251 @@
+// ----------------------------------------------------------------------
+// File: rolls.c
+//
+// Name: Jonathan Goohs
+//
+// Description: This program works out the reroll probability tables of
+//     the YAHTZEE game (see rolltab.h) and writes them to the file the
+//     game maps at start-up, so no process has to enumerate the rerolls
+//     again and every process shares one copy of the tables.
+//
+//     The one-reroll table comes straight from the REROLL module. The
+//     two-reroll table adds up, over every roll the first reroll can
+//     end in, its chance times the one-reroll row of the dice then
+//     kept. As a check it prints how likely a YAHTZEE is in the three
+//     rolls of a turn played for a kind (4.60%).
+//
+// Syntax: ./rolls [-f file]
+//     -f  table file to write (default yahtzee.rolls)
+// ----------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include "rolltab.h"
+#include "score.h"
+
+#define PERCENT           100.0
+
+// **************************************************************************
+// **************************** GLOBAL VARIABLES ****************************
+// **************************************************************************
+
+// The tables, [rerolls - 1][keep][key], in doubles while they are built
+static double Chances[ROLLTAB_REROLLS][REROLL_KEEPS][SCORETAB_KEYS];
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     next_keep
+// Inputs
+//     keep
+//         The dice kept for the first reroll.
+//     key
+//         The roll it ended in.
+// Outputs
+//     function result
+//         The dice kept for the second reroll: all those of the most
+//         common face of the roll; on a tie, the face kept before, or
+//         else the higher face.
+// ---------------------------------------------------------------------
+static int next_keep(const int keep, const int key)
+{
+    unsigned char kept[NUMBER_OF_DICE];
+    unsigned char values[NUMBER_OF_DICE];
+    int counts[NUMBER_OF_SIDES + 1] = { 0 };
+    int before[NUMBER_OF_SIDES + 1] = { 0 };
+    int best = ACES;
+
+    reroll_dice(keep, kept);
+    for (int i = 0; i < reroll_size(keep); ++i) {
+        ++before[kept[i]];
+    }
+    scoretab_dice(key, values);
+    for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+        ++counts[values[i]];
+    }
+    for (int face = TWOS; face <= SIXES; ++face) {
+        if ((counts[face] > counts[best]) ||
+            ((counts[face] == counts[best]) &&
+             (before[face] >= before[best]))) {
+            best = face;
+        }
+    }
+
+    for (int i = 0; i < counts[best]; ++i) {
+        kept[i] = best;
+    }
+
+    return reroll_keep_of(kept, counts[best]);
+
+}//end next_keep
+
+
+// ---------------------------------------------------------------------
+// Function
+//     build_tables
+// Inputs
+//     none
+// Outputs
+//     none
+// Description
+//     Fills Chances[]: one reroll from the REROLL module's outcomes,
+//     then two rerolls from one.
+// ---------------------------------------------------------------------
+static void build_tables(void)
+{
+    const short *keys;
+    const float *chances;
+    int outcomes;
+
+    for (int keep = 0; keep < REROLL_KEEPS; ++keep) {
+        outcomes = reroll_outcomes(keep, &keys, &chances);
+        for (int i = 0; i < outcomes; ++i) {
+            Chances[0][keep][keys[i]] += chances[i];
+        }
+    }
+
+    for (int keep = 0; keep < REROLL_KEEPS; ++keep) {
+        outcomes = reroll_outcomes(keep, &keys, &chances);
+        for (int i = 0; i < outcomes; ++i) {
+            const double *then = Chances[0][next_keep(keep, keys[i])];
+
+            for (int key = 0; key < SCORETAB_KEYS; ++key) {
+                Chances[1][keep][key] += chances[i] * then[key];
+            }
+        }
+    }
+
+}//end build_tables
+
+
+// ---------------------------------------------------------------------
+// Function
+//     write_tables
+// Inputs
+//     path
+//         The file to write.
+// Outputs
+//     function result
+//         SUCCESS or !SUCCESS.
+// Description
+//     Writes the header and the tables as floats, every row padded, to
+//     a temporary file and renames it over "path", so a reader never
+//     maps half a table.
+// ---------------------------------------------------------------------
+static int write_tables(const char *path)
+{
+    struct rolltab_header_t header;
+    float row[ROLLTAB_ROW];
+    char temp[FILENAME_MAX];
+    FILE *file;
+    bool ok;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ROLLTAB_MAGIC, sizeof(header.magic));
+    header.version = ROLLTAB_VERSION;
+    header.rerolls = ROLLTAB_REROLLS;
+    header.keeps   = REROLL_KEEPS;
+    header.keys    = SCORETAB_KEYS;
+    header.row     = ROLLTAB_ROW;
+    header.offset  = sizeof(header);
+
+    snprintf(temp, sizeof(temp), "%s.tmp", path);
+    file = fopen(temp, "wb");
+    if (file == NULL) {
+        perror(temp);
+        return !SUCCESS;
+    }
+    memset(row, 0, sizeof(row));
+    ok = (fwrite(&header, sizeof(header), 1, file) == 1);
+    for (int r = 0; ok && (r < ROLLTAB_REROLLS); ++r) {
+        for (int keep = 0; ok && (keep < REROLL_KEEPS); ++keep) {
+            for (int key = 0; key < SCORETAB_KEYS; ++key) {
+                row[key] = Chances[r][keep][key];
+            }
+            ok = (fwrite(row, sizeof(row), 1, file) == 1);
+        }
+    }
+    ok = (fclose(file) == 0) && ok;
+    if (!ok || (rename(temp, path) != 0)) {
+        perror(path);
+        unlink(temp);
+        return !SUCCESS;
+    }
+
+    return SUCCESS;
+
+}//end write_tables
+
+
+// **************************************************************************
+// *********************************  MAIN **********************************
+// **************************************************************************
+int main(int argc, char *argv[])
+{
+    const char *path = ROLLTAB_FILE;
+    double yahtzee = 0;
+    double worst = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "f:")) != -1) {
+        switch (opt) {
+        case 'f':
+            path = optarg;
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-f file]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    scoretab_init();
+    reroll_init();
+    build_tables();
+
+    // Every row must add up to 1
+    for (int r = 0; r < ROLLTAB_REROLLS; ++r) {
+        for (int keep = 0; keep < REROLL_KEEPS; ++keep) {
+            double sum = 0;
+
+            for (int key = 0; key < SCORETAB_KEYS; ++key) {
+                sum += Chances[r][keep][key];
+            }
+            if (sum - 1 > worst) {
+                worst = sum - 1;
+            } else if (1 - sum > worst) {
+                worst = 1 - sum;
+            }
+        }
+    }
+
+    // A YAHTZEE in three rolls: the first roll, then two rerolls
+    for (int key = 0; key < SCORETAB_KEYS; ++key) {
+        const double *then = Chances[1][next_keep(0, key)];
+
+        for (int last = 0; last < SCORETAB_KEYS; ++last) {
+            if (scoretab_score(last, YAHTZEE) > 0) {
+                yahtzee += reroll_probability(key) * then[last];
+            }
+        }
+    }
+
+    if (write_tables(path) != SUCCESS) {
+        return EXIT_FAILURE;
+    }
+    printf("Wrote %s: %zu bytes, %i keeps x %i rolls for 1 and 2 "
+           "rerolls\n", path, (size_t)ROLLTAB_SIZE, REROLL_KEEPS,
+           SCORETAB_KEYS);
+    printf("Rows add up to 1 within %.1e; a YAHTZEE in three rolls, "
+           "played for a kind: %.4f%%\n", worst, PERCENT * yahtzee);
+
+    return EXIT_SUCCESS;
+
+} // end main
+
+// end rolls.c
@@ -0,0 +1,51 @@
+// -------------------------------------------------------------------
+// File: rolltab.h
+//
+// Name: Jonathan Goohs
+//
+// Description: This header defines the file of reroll probability
+//     tables that ./rolls writes and the PLAY module maps: for every
+//     keep (REROLL module numbering) and 1 or 2 rerolls left, the
+//     chance of each final roll (SCORETAB key).
+//
+//     With one reroll the chances are exact for any play. With two
+//     they assume the dice are played for a kind: after the first
+//     reroll the dice kept are all those of the most common face (on a
+//     tie, the face kept before, or else the higher one). That is the
+//     play the hints about kinds ask about, e.g. the chance of a
+//     YAHTZEE.
+//
+//     The file is a header of one cache line and then the table,
+//     float [ROLLTAB_REROLLS][REROLL_KEEPS][ROLLTAB_ROW]. Every row is
+//     padded to whole cache lines (the padding is zero), so a row
+//     starts on a cache line once the file is mapped. A file of
+//     another version or shape is not used.
+// -------------------------------------------------------------------
+#ifndef ROLLTAB_H
+#define ROLLTAB_H
+
+#include <stdint.h>
+#include "reroll.h"
+#include "scoretab.h"
+
+#define ROLLTAB_FILE      "yahtzee.rolls"
+#define ROLLTAB_MAGIC     "YZRR"
+#define ROLLTAB_VERSION   1
+#define ROLLTAB_REROLLS   2
+#define ROLLTAB_LINE      64            // bytes in a cache line
+#define ROLLTAB_ROW       256           // SCORETAB_KEYS, padded
+#define ROLLTAB_SIZE      (ROLLTAB_LINE + (size_t)ROLLTAB_REROLLS * \
+                           REROLL_KEEPS * ROLLTAB_ROW * sizeof(float))
+
+// The start of the file
+struct rolltab_header_t {
+    char     magic[4];
+    uint32_t version;
+    uint32_t rerolls;               // ROLLTAB_REROLLS
+    uint32_t keeps;                 // REROLL_KEEPS
+    uint32_t keys;                  // SCORETAB_KEYS
+    uint32_t row;                   // ROLLTAB_ROW
+    uint32_t offset;                // of the table, ROLLTAB_LINE
+} __attribute__((aligned(ROLLTAB_LINE)));
+
+#endif
@@ -4,8 +4,9 @@
 // Name: Al Shaffer & Paul Clark & Jonathan Goohs
 //
 // Description: This is the implementation of the SCORE module of the
-//     YAHTZEE game. It keeps track of the score card, enters new
-//     scores as requested, and displays the score as requested.
+//     YAHTZEE game. It keeps track of the score card of a game (see
+//     game.h), enters new scores as requested, and displays the score
+//     as requested.
 //
 //Resources:
 //1. man console_codes
@@ -13,27 +14,25 @@
 // ----------------------------------------------------------------------
 #include <stdio.h>
 #include <stdbool.h>
+#include "phase.h"
 #include "score.h"
 #include "screen.h"
 
-#define NUMBER_OF_ENTRIES      13  // Does not count the subtotals and totals
 #define LEFT_SECTION_END        6
 #define RIGHT_SECTION_END      13
 #define NOT_SCORED              0
-#define LEFT_BONUS_SUBTOTAL    63
-#define BONUS_VALUE            35
 #define LEFT_SECTION_ROW        0
 #define LEFT_SECTION_COL       11
 #define YAHTZEE_ROW             0
 #define YAHTZEE_COL            38
 #define RIGHT_SECTION_ROW       0
 #define RIGHT_SECTION_COL      62
-#define RIGHT_ITEM_COL         50
+#define RIGHT_ITEM_COL         48   // the scores end in column 80
 #define EQ_SCORE_D_ROW         10
 #define TOTAL_L_SCORE_D_ROW    11
 #define TOTAL_R_SCORE_D_ROW    12
 #define GRAND_T_SCORE_D_ROW    13
-#define SCORE_DISPLAY_COL      53
+#define SCORE_DISPLAY_COL      51
 #define UPPER_SECTION_ROW       1
 #define UPPER_SECTION_COL       2
 #define UPPER_SECTION_ITEM_COL  3
@@ -49,23 +48,10 @@
 #define FINAL_CURSOR_COL        4
 
 
-// **************************************************************************
-// ****************************  DEFINED TYPES   ****************************
-// **************************************************************************
-
-// An entry in a scorecard
-struct entry_t {
-    unsigned int value;
-    bool         used;
-};
-
 // **************************************************************************
 // **************************** GLOBAL VARIABLES ****************************
 // **************************************************************************
 
-// The Scorecard
-static struct entry_t Score[NUMBER_OF_ENTRIES+1]; // row 0 is not used
-
 // The Entry Names in a scorecard
 static char *Entry_names[] = {
     "******** NOT USED *********",
@@ -84,11 +70,6 @@ static char *Entry_names[] = {
     "Chance       (add all dice)"
 };
 
-static int left_score = NOT_SCORED; //initialize to zero and add to it based off of loop value
-static int right_score = NOT_SCORED; //initialize to zero and add to it based off of loop value
-static int bonus = NOT_SCORED;
-static int total_score = NOT_SCORED; //need to save values for added scores for printing
-static int grand_total = NOT_SCORED;
 
 // **************************************************************************
 // *************************** EXTERNAL FUNCTIONS ***************************
@@ -98,18 +79,23 @@ static int grand_total = NOT_SCORED;
 // Function
 //     score_reset
 // Inputs
-//     none
+//     game
+//         The game whose scorecard it is.
 // Outputs
 //     none
 // Description
-//     Initializes all the scorecard entries to zero and unused.
+//     Initializes all the scorecard entries of the game to zero and
+//     unused, and its totals to zero.
 // ---------------------------------------------------------------------
-void score_reset(void)
+void score_reset(struct game_t *game)
 {
-    for (int i =1;i<NUMBER_OF_ENTRIES;i++) {
-        Score[i].value = 0;
-        Score[i].used = false;
+    for (int i =1;i<=NUMBER_OF_ENTRIES;i++) {
+        game->score[i].value = 0;
+        game->score[i].used = false;
     }
+    game->left_score = NOT_SCORED;
+    game->right_score = NOT_SCORED;
+    game->bonus = NOT_SCORED;
 }//end score_reset
 
 
@@ -117,69 +103,69 @@ void score_reset(void)
 // Function
 //     score_display
 // Inputs
-//     none
+//     game
+//         The game whose scorecard it is.
 // Outputs
 //     none
 // Description
 //     Displays the current scorecard using the entire screen.
 // ---------------------------------------------------------------------
-void score_display(void)
+void score_display(const struct game_t *game)
 {
     //all individual scores, total scores, grand total, and the bonus score (which if theres more than 63 you get bonus score)
     
-    total_score = left_score + right_score; //need to save values for added scores for printing
-    grand_total = total_score + bonus; // per game rules
+    int total_score = game->left_score + game->right_score;
+    int grand_total = total_score + game->bonus; // per game rules
+    uint64_t start = phase_begin();
 
     screen_cursor(LEFT_SECTION_ROW,LEFT_SECTION_COL);
     screen_text_color(WHITE_TEXT);
-    printf("LEFT SECTION\n\n\n");
+    screen_printf("LEFT SECTION\n\n\n");
     //print aces through 6
     for (int i=1;i<=LEFT_SECTION_END;i++){
-        if (Score[i].used == false){
-            printf("%d %s %2d\n", i, Entry_names[i], NOT_SCORED);
+        if (game->score[i].used == false){
+            screen_printf("%d %s %2d\n", i, Entry_names[i], NOT_SCORED);
         } else {     //the used bool is true
-            printf("%s %s %2d\n", " ", Entry_names[i], Score[i].value);
+            screen_printf("%s %s %2d\n", " ", Entry_names[i],
+                          game->score[i].value);
         }
     }
-    printf("  ========================== ===\n");
-    printf("  TOTAL SCORE\t\t     %3d\n", left_score);
+    screen_printf("  ========================== ===\n");
+    screen_printf("  TOTAL SCORE\t\t     %3d\n", game->left_score);
 
-    //bonus - assigned 35 points whenever subtotal of left is >= 63
-    if (left_score >= LEFT_BONUS_SUBTOTAL) {
-        bonus = BONUS_VALUE;
-        printf("  BONUS\t\t\t     %3d\n", bonus);
-    } else {
-        printf("  BONUS\t\t\t     %3d\n", bonus);
-    }
+    //bonus - assigned 35 points by score_set whenever subtotal of left is >= 63
+    screen_printf("  BONUS\t\t\t     %3d\n", game->bonus);
 
-    printf("  TOTAL_LEFT\t\t     %3d\n", left_score);
+    screen_printf("  TOTAL_LEFT\t\t     %3d\n", game->left_score);
 
     //middle section
     screen_cursor(YAHTZEE_ROW,YAHTZEE_COL);
-    printf("YAHTZEE!");
+    screen_printf("YAHTZEE!");
 
     //right section
     screen_cursor(RIGHT_SECTION_ROW,RIGHT_SECTION_COL);
-    printf("RIGHT SECTION\n");
+    screen_printf("RIGHT SECTION\n");
     int RIGHT_ITEM_ROW = 3;
     //print 3 of a kind through chance
     for (int i=7;i<=RIGHT_SECTION_END;i++){
         screen_cursor(RIGHT_ITEM_ROW++,RIGHT_ITEM_COL);
-        if (Score[i].used == false){
-            printf("%2d %s %2d\n", i, Entry_names[i], NOT_SCORED);
+        if (game->score[i].used == false){
+            screen_printf("%2d %s %2d\n", i, Entry_names[i], NOT_SCORED);
         } else {     //the used bool is true
-                printf("%s %s %2d\n", "  ", Entry_names[i], Score[i].value);
+                screen_printf("%s %s %2d\n", "  ", Entry_names[i],
+                              game->score[i].value);
             }
         }
     //display totals
     screen_cursor(EQ_SCORE_D_ROW,SCORE_DISPLAY_COL);
-    printf("========================== ===\n");
+    screen_printf("========================== ===\n");
     screen_cursor(TOTAL_L_SCORE_D_ROW,SCORE_DISPLAY_COL);
-    printf("TOTAL LEFT\t\t\t%2d\n", left_score);
+    screen_printf("%-27s%3d\n", "TOTAL LEFT", game->left_score);
     screen_cursor(TOTAL_R_SCORE_D_ROW,SCORE_DISPLAY_COL);
-    printf("TOTAL RIGHT\t\t\t%2d\n", right_score);
+    screen_printf("%-27s%3d\n", "TOTAL RIGHT", game->right_score);
     screen_cursor(GRAND_T_SCORE_D_ROW,SCORE_DISPLAY_COL);
-    printf("GRAND TOTAL\t\t\t%2d\n", grand_total);
+    screen_printf("%-27s%3d\n", "GRAND TOTAL", grand_total);
+    phase_end(PHASE_SCORE_DISPLAY, start);
 
 }//end score_display
 
@@ -188,46 +174,42 @@ void score_display(void)
 // Function
 //     score_display_final
 // Inputs
-//     none
+//     game
+//         The game whose scorecard it is.
 // Outputs
 //     none
 // Description
 //     Displays the final scorecard in a simple format.
 // ---------------------------------------------------------------------
-void score_display_final(void)
+void score_display_final(const struct game_t *game)
 {
     // Add your code here
     //when user hits q or the game is finished, the scorecard will be displayed
     //upper section, lower section, and scores
     screen_clear();
     screen_cursor(0,0);
-    total_score = left_score + right_score; //need to save values for added scores for printing
-    grand_total = total_score  + bonus;
+    int total_score = game->left_score + game->right_score;
+    int grand_total = total_score  + game->bonus;
 
     printf("UPPER SECTION\n");
     screen_cursor(UPPER_SECTION_ROW,UPPER_SECTION_COL);
     int UPPER_SECTION_ITEM = 2;
     for (int i=1;i<=LEFT_SECTION_END;i++){      //start from one to avoid first item
         screen_cursor(UPPER_SECTION_ITEM++,UPPER_SECTION_ITEM_COL);
-        if (Score[i].used == false){
+        if (game->score[i].used == false){
             printf("%s %s %2d\n", "", Entry_names[i], NOT_SCORED);
         } else {
-            int section_value = Score[i].value;
+            int section_value = game->score[i].value;
             printf("%s %s %2d\n", "", Entry_names[i], section_value);
         }
     }
     printf("   ========================== ===\n");
     printf("   TOTAL SCORE\t\t      %3d\n", total_score);
 
-    //bonus - assigned 35points whenever subtotal of left is >= 63
-    if (left_score >= LEFT_BONUS_SUBTOTAL) {
-        bonus = BONUS_VALUE;
-        printf("   BONUS\t\t       %2d\n", bonus);
-    } else {
-        printf("   BONUS\t\t       %2d\n", bonus);
-    }
+    //bonus - assigned 35points by score_set whenever subtotal of left is >= 63
+    printf("   BONUS\t\t       %2d\n", game->bonus);
 
-    printf("   TOTAL_UPPER\t\t      %3d\n", left_score);
+    printf("   TOTAL_UPPER\t\t      %3d\n", game->left_score);
 
     //end upper section
     screen_cursor(LOWER_SECTION_ROW,LOWER_SECTION_COL);
@@ -237,19 +219,19 @@ void score_display_final(void)
     //print 3 of a kind through chance
     for (int i=7;i<=RIGHT_SECTION_END;i++){
         screen_cursor(LOWER_SECTION_ITEM_ROW++, LOWER_SECTION_ITEM_COL);
-        if (Score[i].used == false){
+        if (game->score[i].used == false){
             printf("%s %s %2d\n", "", Entry_names[i], NOT_SCORED);
         } else {        //the used bool is true
-                int section_value = Score[i].value;
+                int section_value = game->score[i].value;
                 printf("%s %s %2d\n", "", Entry_names[i], section_value);
         }
     }
     screen_cursor(EQ_LOWER_S_FINAL_ROW,LOWER_SECTION_FINAL_COL);
     printf("========================== ===\n");
     screen_cursor(TOTAL_UP_FINAL_ROW,LOWER_SECTION_FINAL_COL);
-    printf("TOTAL UPPER\t\t      %3d\n", left_score);
+    printf("TOTAL UPPER\t\t      %3d\n", game->left_score);
     screen_cursor(TOTAL_LOW_FINAL_ROW,LOWER_SECTION_FINAL_COL);
-    printf("TOTAL LOWER\t\t      %3d\n", right_score);
+    printf("TOTAL LOWER\t\t      %3d\n", game->right_score);
     screen_cursor(GRAND_T_FINAL_ROW,LOWER_SECTION_FINAL_COL);
     printf("GRAND TOTAL\t\t      %3d\n", grand_total);
 
@@ -257,10 +239,42 @@ void score_display_final(void)
 }//end score_display_final
 
 
+// ---------------------------------------------------------------------
+// Function
+//     score_state
+// Inputs
+//     game
+//         The game whose scorecard it is.
+// Outputs
+//     used
+//         One bit per item already scored, bit 0 for Aces.
+//     upper
+//         The total of the upper (left) section, without the bonus.
+//     total
+//         The grand total so far, bonus included.
+// Description
+//     Reports the state of the scorecard, e.g. for the solver.
+// ---------------------------------------------------------------------
+void score_state(const struct game_t *game, unsigned int *used,
+                 int *upper, int *total)
+{
+    *used = 0;
+    for (int i = 1; i <= NUMBER_OF_ENTRIES; i++) {
+        if (game->score[i].used) {
+            *used |= 1u << (i - 1);
+        }
+    }
+    *upper = game->left_score;
+    *total = game->left_score + game->right_score + game->bonus;
+}//end score_state
+
+
 // ---------------------------------------------------------------------
 // Function
 //     score_set
 // Inputs
+//     game
+//         The game whose scorecard it is.
 //     item
 //         This is the line in the scorecard to put the score.
 //     score
@@ -275,7 +289,7 @@ void score_display_final(void)
 //     a non-SUCCESS and no change to the card happens. Otherwise, the
 //     requested change occurs, and a SUCCESS is returned.
 // ---------------------------------------------------------------------
-int score_set(const int item, const int score)
+int score_set(struct game_t *game, const int item, const int score)
 {
     //requires user input, so must error check
     //input will be 
@@ -283,7 +297,7 @@ int score_set(const int item, const int score)
     //refer to get input from last project
 
     //check if user item index is valid
-    if (item < 1 || item >= NUMBER_OF_ENTRIES) {
+    if (item < 1 || item > NUMBER_OF_ENTRIES) {
         return !SUCCESS;
     }
     //check if score is negative
@@ -291,28 +305,24 @@ int score_set(const int item, const int score)
         return !SUCCESS;
     }
     //check if score entry has already been entered by user
-    if (Score[item].used == true) {
+    if (game->score[item].used == true) {
         return !SUCCESS;
     }
     //update scorecard with entry from user
-    Score[item].value = score;
-    Score[item].used = true;
+    game->score[item].value = score;
+    game->score[item].used = true;
 
     //update section totals
     if (item >= 1 && item <= 6) {
-        left_score += score;
-        if (left_score >= LEFT_BONUS_SUBTOTAL){
-            bonus = BONUS_VALUE;
+        game->left_score += score;
+        if (game->left_score >= LEFT_BONUS_SUBTOTAL){
+            game->bonus = BONUS_VALUE;
         } else {
-            bonus = NOT_SCORED;
+            game->bonus = NOT_SCORED;
         }
     } else {        //the number is 7-13
-        right_score += score;
+        game->right_score += score;
     }
 
-    //update final and grand total 
-    total_score = left_score + right_score;
-    grand_total = left_score + right_score + bonus;
-
     return SUCCESS;
 }//end score_set
@@ -9,6 +9,8 @@
 #ifndef SCORE_H
 #define SCORE_H
 
+#include "game.h"
+
 #define ACES              1
 #define TWOS              2
 #define THREES            3
@@ -28,11 +30,16 @@
 #define SCORE_STRAIGHT_LG 40
 #define SCORE_YAHTZEE     50
 
+#define LEFT_BONUS_SUBTOTAL 63   // upper section total that earns the bonus
+#define BONUS_VALUE         35
+
 #define SUCCESS           0
 
-extern int  score_set(const int item, const int score);
-extern void score_reset(void);
-extern void score_display(void);
-extern void score_display_final(void);
+extern int  score_set(struct game_t *game, const int item, const int score);
+extern void score_reset(struct game_t *game);
+extern void score_display(const struct game_t *game);
+extern void score_display_final(const struct game_t *game);
+extern void score_state(const struct game_t *game, unsigned int *used,
+                        int *upper, int *total);
 
 #endif
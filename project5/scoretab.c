@@ -0,0 +1,344 @@
+// ----------------------------------------------------------------------
+// File: scoretab.c
+//
+// Name: Jonathan Goohs
+//
+// Description: This is the implementation of the SCORETAB module of the
+//     YAHTZEE game. Five dice can only show 252 different multisets of
+//     values, so the score of all 13 scorecard items is computed once
+//     per multiset at start-up. Every ordered roll (6^5 of them) is also
+//     mapped to the key of its multiset, which makes scoring a roll two
+//     indexed loads instead of scanning the dice per item.
+//
+//     The scores here are computed from a histogram of the dice, which
+//     is independent from the rules in play.c; play_verify_scores()
+//     checks that the two agree for every multiset.
+// ----------------------------------------------------------------------
+#include <stdbool.h>
+#include "play.h"
+#include "score.h"
+#include "scoretab.h"
+
+#define NO_KEY           255
+#define NOT_SCORED         0
+
+// The smallest modulus that leaves every counts word of five dice with a
+// different remainder, so the remainder can index Counts_key directly
+#define COUNTS_HASH     1433
+
+// **************************************************************************
+// **************************** GLOBAL VARIABLES ****************************
+// **************************************************************************
+
+// The score of every item for every multiset of dice
+static unsigned char Scores[SCORETAB_KEYS][SCORETAB_ITEMS];
+
+// The dice of every multiset, in increasing order
+static unsigned char Key_dice[SCORETAB_KEYS][NUMBER_OF_DICE];
+
+// The multiset key of every ordered roll
+static unsigned char Roll_key[SCORETAB_ROLLS];
+
+// The multiset key of every counts word, at its remainder by COUNTS_HASH
+static unsigned char Counts_key[COUNTS_HASH];
+
+static bool Table_ready = false;
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     roll_index
+// Inputs
+//     values
+//         The face up value (1 thru 6) of each die.
+// Outputs
+//     function result
+// Description
+//     Returns the position of the ordered roll in Roll_key, reading the
+//     dice as the digits of a base 6 number.
+// ---------------------------------------------------------------------
+static int roll_index(const unsigned char values[])
+{
+    int index = 0;
+
+    for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+        index = index * NUMBER_OF_SIDES + (values[i] - 1);
+    }
+
+    return index;
+
+}//end roll_index
+
+
+// ---------------------------------------------------------------------
+// Function
+//     counts_of
+// Inputs
+//     values
+//         The face up value (1 thru 6) of each die.
+// Outputs
+//     function result
+// Description
+//     Returns the counts word of the dice: how many show each value, in
+//     SCORETAB_COUNT_BITS bits per value, with ACES in the lowest bits.
+// ---------------------------------------------------------------------
+static unsigned int counts_of(const unsigned char values[])
+{
+    unsigned int counts = 0;
+
+    for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+        counts += 1u << (SCORETAB_COUNT_BITS * (values[i] - 1));
+    }
+
+    return counts;
+
+}//end counts_of
+
+
+// ---------------------------------------------------------------------
+// Function
+//     has_run
+// Inputs
+//     counts
+//         How many dice show each value (index 1 thru 6).
+//     first, length
+//         The run of values to look for.
+// Outputs
+//     function result
+// Description
+//     Returns true if every value from first to first+length-1 is
+//     showing on at least one die.
+// ---------------------------------------------------------------------
+static bool has_run(const int counts[], const int first, const int length)
+{
+    for (int value = first; value < first + length; ++value) {
+        if (counts[value] == 0) {
+            return false;
+        }
+    }
+
+    return true;
+
+}//end has_run
+
+
+// ---------------------------------------------------------------------
+// Function
+//     fill_scores
+// Inputs
+//     key
+//         The multiset whose dice are in Key_dice[key].
+// Outputs
+//     none
+// Description
+//     Computes the score of every scorecard item for the multiset.
+// ---------------------------------------------------------------------
+static void fill_scores(const int key)
+{
+    int counts[NUMBER_OF_SIDES + 1] = { 0 };
+    int total = 0;
+    int most  = 0;
+    bool pair = false;
+
+    for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+        ++counts[Key_dice[key][i]];
+        total += Key_dice[key][i];
+    }
+    for (int value = ACES; value <= SIXES; ++value) {
+        if (counts[value] > most) {
+            most = counts[value];
+        }
+        if (counts[value] == 2) {
+            pair = true;
+        }
+        Scores[key][value] = counts[value] * value;
+    }
+
+    Scores[key][KIND3] = (most >= 3) ? total : NOT_SCORED;
+    Scores[key][KIND4] = (most >= 4) ? total : NOT_SCORED;
+    Scores[key][FULL_HOUSE] = (most == 3 && pair) ? SCORE_FULL_HOUSE
+                                                   : NOT_SCORED;
+    Scores[key][STRAIGHT_SM] = (has_run(counts, ACES, 4) ||
+                                has_run(counts, TWOS, 4) ||
+                                has_run(counts, THREES, 4))
+                               ? SCORE_STRAIGHT_SM : NOT_SCORED;
+    Scores[key][STRAIGHT_LG] = (has_run(counts, ACES, 5) ||
+                                has_run(counts, TWOS, 5))
+                               ? SCORE_STRAIGHT_LG : NOT_SCORED;
+    Scores[key][YAHTZEE] = (most == NUMBER_OF_DICE) ? SCORE_YAHTZEE
+                                                    : NOT_SCORED;
+    Scores[key][CHANCE] = total;
+
+}//end fill_scores
+
+
+// **************************************************************************
+// *************************** EXTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     scoretab_init
+// Inputs
+//     none
+// Outputs
+//     none
+// Description
+//     Builds the tables. The multisets are numbered in the order of
+//     their sorted dice, e.g. key 0 is 1 1 1 1 1 and key 251 is
+//     6 6 6 6 6. Calling this more than once does nothing.
+// ---------------------------------------------------------------------
+void scoretab_init(void)
+{
+    unsigned char dice[NUMBER_OF_DICE];
+    int key = 0;
+
+    if (Table_ready) {
+        return;
+    }
+
+    for (int i = 0; i < SCORETAB_ROLLS; ++i) {
+        Roll_key[i] = NO_KEY;
+    }
+
+    // Walk the non-decreasing rolls; each one is a different multiset
+    for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+        dice[i] = ACES;
+    }
+    while (key < SCORETAB_KEYS) {
+        for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+            Key_dice[key][i] = dice[i];
+        }
+        fill_scores(key);
+        Roll_key[roll_index(dice)] = key;
+        Counts_key[counts_of(dice) % COUNTS_HASH] = key;
+        ++key;
+
+        // next non-decreasing roll: bump the last die that can go up
+        // and set every die after it to the same value
+        int i = NUMBER_OF_DICE - 1;
+        while (i >= 0 && dice[i] == NUMBER_OF_SIDES) {
+            --i;
+        }
+        if (i < 0) {
+            break;
+        }
+        ++dice[i];
+        for (int j = i + 1; j < NUMBER_OF_DICE; ++j) {
+            dice[j] = dice[i];
+        }
+    }
+
+    // Every other ordered roll has the key of its sorted roll
+    for (int index = 0; index < SCORETAB_ROLLS; ++index) {
+        int rest = index;
+        int counts[NUMBER_OF_SIDES + 1] = { 0 };
+
+        for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+            ++counts[rest % NUMBER_OF_SIDES + 1];
+            rest /= NUMBER_OF_SIDES;
+        }
+        for (int value = ACES, i = 0; value <= SIXES; ++value) {
+            while (counts[value]-- > 0) {
+                dice[i++] = value;
+            }
+        }
+        Roll_key[index] = Roll_key[roll_index(dice)];
+    }
+
+    Table_ready = true;
+
+}//end scoretab_init
+
+
+// ---------------------------------------------------------------------
+// Function
+//     scoretab_key
+// Inputs
+//     values
+//         The face up value (1 thru 6) of each of the five dice, in any
+//         order.
+// Outputs
+//     function result
+// Description
+//     Returns the key (0 thru 251) of the multiset of the dice.
+// ---------------------------------------------------------------------
+int scoretab_key(const unsigned char values[])
+{
+    return Roll_key[roll_index(values)];
+
+}//end scoretab_key
+
+
+// ---------------------------------------------------------------------
+// Function
+//     scoretab_counts_key
+// Inputs
+//     counts
+//         How many of the five dice show each value, SCORETAB_COUNT_BITS
+//         bits per value with ACES in the lowest bits, and nothing above
+//         the SIXES count.
+// Outputs
+//     function result
+// Description
+//     Returns the key (0 thru 251) of the multiset of the dice, without
+//     looking at the dice themselves.
+// ---------------------------------------------------------------------
+int scoretab_counts_key(const unsigned int counts)
+{
+    return Counts_key[counts % COUNTS_HASH];
+
+}//end scoretab_counts_key
+
+
+// ---------------------------------------------------------------------
+// Function
+//     scoretab_score
+// Inputs
+//     key
+//         A multiset key from scoretab_key().
+//     item
+//         The scorecard item (ACES thru CHANCE).
+// Outputs
+//     function result
+// Description
+//     Returns the score the dice would get in the item, or zero if the
+//     item does not exist.
+// ---------------------------------------------------------------------
+int scoretab_score(const int key, const int item)
+{
+    if ((item < ACES) || (item > CHANCE)) {
+        return NOT_SCORED;
+    }
+
+    return Scores[key][item];
+
+}//end scoretab_score
+
+
+// ---------------------------------------------------------------------
+// Function
+//     scoretab_dice
+// Inputs
+//     key
+//         A multiset key (0 thru 251).
+// Outputs
+//     values
+//         The five dice of the multiset, in increasing order.
+// Description
+//     This is the inverse of scoretab_key(), used to enumerate every
+//     possible roll.
+// ---------------------------------------------------------------------
+void scoretab_dice(const int key, unsigned char values[])
+{
+    for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+        values[i] = Key_dice[key][i];
+    }
+
+}//end scoretab_dice
+
+// end scoretab.c
@@ -0,0 +1,24 @@
+// -------------------------------------------------------------------
+// File: scoretab.h
+//
+// Name: Jonathan Goohs
+//
+// Description: This is the header file for the SCORETAB module of the
+//     YAHTZEE game. It holds the score of every scorecard item for
+//     every possible roll, so scoring a roll is a table lookup.
+// -------------------------------------------------------------------
+#ifndef SCORETAB_H
+#define SCORETAB_H
+
+#define SCORETAB_KEYS    252    // # different multisets of five dice
+#define SCORETAB_ROLLS  7776    // # ordered rolls of five dice (6^5)
+#define SCORETAB_ITEMS    14    // items ACES thru CHANCE; 0 is not used
+#define SCORETAB_COUNT_BITS 4   // bits per face in a counts word
+
+extern void scoretab_init(void);
+extern int  scoretab_key(const unsigned char values[]);
+extern int  scoretab_counts_key(const unsigned int counts);
+extern int  scoretab_score(const int key, const int item);
+extern void scoretab_dice(const int key, unsigned char values[]);
+
+#endif
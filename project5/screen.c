@@ -7,15 +7,38 @@
 //     This module sets the foreground and background colors of the
 //     terminal, clears the screen, and resets the terminal back to its
 //     original state.
+//
+//     Between screen_init() and screen_reset(), drawing goes to a 24x80
+//     buffer of cells (a character and its color) instead of the
+//     terminal. screen_present() compares the buffer with what the
+//     terminal already shows and sends only the cells that changed, in
+//     one write(). Redrawing the whole screen for every key used to
+//     send about 1 KB and made the screen flicker over slow links; most
+//     keys now send a few dozen bytes.
+//
+//     The user's typing is echoed by the terminal behind our back, so
+//     after each present the rest of the cursor's row and the row below
+//     are taken to be unknown, and get redrawn the next time. If the
+//     cursor is on the last row, the Enter key scrolls the whole
+//     screen, so then everything is redrawn. Once the terminal has been
+//     told not to echo (see keys.h), screen_echo(false) stops this, and
+//     a key that changes nothing on the screen sends nothing.
+//
+//     For a scripted run there is no terminal: screen_init_sink()
+//     starts the module like screen_init(), but what would be sent to
+//     the terminal is only counted, for screen_sink_counts().
 // ----------------------------------------------------------------------
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdarg.h>
 #include <stdbool.h>
+#include <string.h>
 #include <errno.h>
 #include <termios.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
+#include "phase.h"
 #include "screen.h"
 
 #define YAHTZEE_ROWS         24
@@ -28,29 +51,242 @@
 #define SET_FOREGROUND_COLOR "\x1b[%i"
 #define SET_BOTH_COLORS      "\x1b[%i;%im"  // background, foreground
 #define COLOR_RESET          "\x1b[0m"
+#define ERASE_LINE           "\x1b[K"     // to the end, in the background
+
+#define TAB_WIDTH             8
+#define BLANK               ' '
+#define UNKNOWN            '\0'    // a cell whose contents are not known
+#define NO_COLOR              0     // the color of a blank cell
+#define MAX_ESCAPE           16     // longest escape sequence sent
+#define MAX_PRINT           256     // longest screen_printf() text
+#define SKIP_LIMIT            4     // resend cells rather than move this far
+#define SCREEN_CELLS         (YAHTZEE_ROWS * YAHTZEE_COLS)
+#define OUTPUT_SIZE          (SCREEN_CELLS * (MAX_ESCAPE + 1))
 
 #define NEW_SCREEN() \
-        printf(CLEAR_SCREEN); \
-        fflush(stdout);
+        send_text(CLEAR_SCREEN);
+
+// ****  DEFINED TYPES ****
+
+// One character cell of the screen
+struct screen_cell_t {
+    char          ch;
+    unsigned char color;        // foreground; NO_COLOR for blanks
+};
+
 
 // ***********************************************************************
 // **************************** GLOBAL VARIABLES *************************
 // ***********************************************************************
 
 static bool Screen_initialized = false;
+static bool Screen_buffered    = false;   // drawing goes to Back
+static bool Screen_sink        = false;   // output is counted, not sent
+static bool Screen_echo        = true;    // the terminal echoes typing
+
+// What has gone to the sink
+static unsigned long long Sink_bytes  = 0;
+static unsigned long long Sink_writes = 0;
+
+// The screen being drawn, and what the terminal shows
+static struct screen_cell_t Back[YAHTZEE_ROWS][YAHTZEE_COLS];
+static struct screen_cell_t Front[YAHTZEE_ROWS][YAHTZEE_COLS];
+
+// Where the next character drawn goes, and in what color. The column
+// is one past the last when a character has just been drawn there; the
+// next one wraps, as on the terminal.
+static int Cursor_row = HOME_ROW;
+static int Cursor_col = HOME_COL;
+static int Color      = WHITE_TEXT;
+
+// The color the terminal is drawing in
+static int Term_color = NO_COLOR;
 
 
 // ***********************************************************************
 // *************************** INTERNAL FUNCTIONS ************************
 // ***********************************************************************
 
-static void set_colors(void)
+// ---------------------------------------------------------------------
+// Function
+//     send
+// Inputs
+//     data, size
+//         Bytes for the terminal.
+// Outputs
+//     none
+// Description
+//     Writes the bytes to the terminal, after anything printf() has
+//     buffered, or counts them when the output goes to the sink.
+// ---------------------------------------------------------------------
+static void send(const char *data, const int size)
 {
-    printf(SET_BOTH_COLORS, BACKGROUND_GREEN, WHITE_TEXT);
+    if (Screen_sink) {
+        Sink_bytes += size;
+        ++Sink_writes;
+        return;
+    }
+
     fflush(stdout);
+    for (int sent = 0; sent < size; ) {
+        ssize_t result = write(STDOUT_FILENO, data + sent, size - sent);
+
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        sent += result;
+    }
+
+}//end send
+
+
+// ---------------------------------------------------------------------
+// Function
+//     send_text
+// Inputs
+//     format, ...
+//         As for printf(); the text is at most MAX_PRINT bytes.
+// Outputs
+//     none
+// Description
+//     Sends formatted text with send().
+// ---------------------------------------------------------------------
+static void send_text(const char *format, ...)
+{
+    char text[MAX_PRINT];
+    va_list args;
+    int size;
+
+    va_start(args, format);
+    size = vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    send(text, (size < (int)sizeof(text)) ? size : (int)sizeof(text) - 1);
+
+}//end send_text
+
+
+static void set_colors(void)
+{
+    send_text(SET_BOTH_COLORS, BACKGROUND_GREEN, WHITE_TEXT);
+    Term_color = WHITE_TEXT;
 }//end set_colors
 
 
+// ---------------------------------------------------------------------
+// Function
+//     fill
+// Inputs
+//     cells
+//         A screen of cells.
+//     ch
+//         BLANK or UNKNOWN.
+//     row, col
+//         The first cell to fill, from 0.
+//     count
+//         How many cells to fill, going on into the next rows.
+// Outputs
+//     cells
+//         The cells are filled.
+// ---------------------------------------------------------------------
+static void fill(struct screen_cell_t cells[][YAHTZEE_COLS], const char ch,
+                 const int row, const int col, const int count)
+{
+    struct screen_cell_t *first = &cells[row][col];
+
+    for (struct screen_cell_t *cell = first; cell < first + count; ++cell) {
+        cell->ch    = ch;
+        cell->color = NO_COLOR;
+    }
+}//end fill
+
+
+// ---------------------------------------------------------------------
+// Function
+//     draw_char
+// Inputs
+//     ch
+//         A character to draw at the cursor.
+// Outputs
+//     none
+// Description
+//     Draws a character into the buffer the way the terminal would
+//     show it: a newline goes to the start of the next row, a tab to
+//     the next tab stop, and a character past the last column wraps.
+//     Anything below the last row is dropped.
+// ---------------------------------------------------------------------
+static void draw_char(const char ch)
+{
+    if (ch == '\n') {
+        ++Cursor_row;
+        Cursor_col = HOME_COL;
+    } else if (ch == '\r') {
+        Cursor_col = HOME_COL;
+    } else if (ch == '\t') {
+        Cursor_col = ((Cursor_col - 1) / TAB_WIDTH + 1) * TAB_WIDTH + 1;
+        if (Cursor_col > YAHTZEE_COLS) {
+            Cursor_col = YAHTZEE_COLS;
+        }
+    } else {
+        if (Cursor_col > YAHTZEE_COLS) {
+            ++Cursor_row;
+            Cursor_col = HOME_COL;
+        }
+        if (Cursor_row <= YAHTZEE_ROWS) {
+            struct screen_cell_t *cell = &Back[Cursor_row - 1][Cursor_col - 1];
+
+            cell->ch    = ch;
+            cell->color = (ch == BLANK) ? NO_COLOR : Color;
+        }
+        ++Cursor_col;
+    }
+}//end draw_char
+
+
+// ---------------------------------------------------------------------
+// Function
+//     same_cell
+// Inputs
+//     a, b
+//         Two cells.
+// Outputs
+//     function result
+//         true if they look the same; blanks look the same in any
+//         color.
+// ---------------------------------------------------------------------
+static bool same_cell(const struct screen_cell_t *a,
+                      const struct screen_cell_t *b)
+{
+    return (a->ch == b->ch) && ((a->ch == BLANK) || (a->color == b->color));
+}//end same_cell
+
+
+// ---------------------------------------------------------------------
+// Function
+//     send_color
+// Inputs
+//     out
+//         The output so far.
+//     color
+//         The color to draw in next.
+// Outputs
+//     out
+//         The escape sequence to change color, if it has to change.
+//     function result
+//         The number of bytes added.
+// ---------------------------------------------------------------------
+static int send_color(char *out, const int color)
+{
+    if ((color == NO_COLOR) || (color == Term_color)) {
+        return 0;
+    }
+    Term_color = color;
+    return sprintf(out, SET_BOTH_COLORS, BACKGROUND_GREEN, color);
+}//end send_color
+
+
 // ***********************************************************************
 // *************************** EXTERNAL FUNCTIONS ************************
 // ***********************************************************************
@@ -67,6 +303,10 @@ static void set_colors(void)
 // ---------------------------------------------------------------------
 void screen_clear(void)
 {
+    if (Screen_buffered) {
+        fill(Back, BLANK, 0, 0, SCREEN_CELLS);
+        return;
+    }
     NEW_SCREEN();
 }//end screen_clear
 
@@ -84,13 +324,15 @@ void screen_clear(void)
 // ---------------------------------------------------------------------
 void screen_reset(void)
 {
+    // Draw straight to the terminal from now on
+    Screen_buffered = false;
+
     // Reset the color scheme
-    printf(COLOR_RESET);
+    send_text(COLOR_RESET);
 
     // Clear the screen and move cursor to the top
     NEW_SCREEN();
-    printf(MOVE_CURSOR, HOME_ROW, HOME_COL);
-    fflush(stdout);
+    send_text(MOVE_CURSOR, HOME_ROW, HOME_COL);
 
 }//end screen_reset
 
@@ -123,23 +365,29 @@ void screen_init(void)
 
     // Get the current dimensions of the terminal, and the current
     // state of the terminal configuration so it can be restore later.
+    // The sink is always large enough.
     errno = 0;
-    result = ioctl(STDOUT_FILENO, TIOCGWINSZ, &term);
+    result = Screen_sink ? 0 : ioctl(STDOUT_FILENO, TIOCGWINSZ, &term);
     if (result < 0) {
         perror("Unable to determine terminal size");
         exit(EXIT_FAILURE);
     }
 
     // Make sure the terminal is large enough for the game.
-    if ((term.ws_row < YAHTZEE_ROWS) || (term.ws_col < YAHTZEE_COLS)) {
+    if (!Screen_sink &&
+        ((term.ws_row < YAHTZEE_ROWS) || (term.ws_col < YAHTZEE_COLS))) {
         printf("Error: the terminal must have a miminum of %i rows "
                "and %i columns", YAHTZEE_ROWS, YAHTZEE_COLS);
         exit(EXIT_FAILURE);
     }
 
-    // Set color scheme and initialize the screen
+    // Set color scheme and initialize the screen; the terminal now
+    // shows a blank screen, and drawing goes to the buffer.
     set_colors();
     NEW_SCREEN();
+    fill(Front, BLANK, 0, 0, SCREEN_CELLS);
+    fill(Back, BLANK, 0, 0, SCREEN_CELLS);
+    Screen_buffered = true;
 
     // Remember that we've done this
     Screen_initialized = true;
@@ -147,6 +395,65 @@ void screen_init(void)
 }//end screen_init
 
 
+// ---------------------------------------------------------------------
+// Function
+//     screen_init_sink
+// Inputs
+//     none
+// Outputs
+//     none
+// Description
+//     Like screen_init(), but for a run without a terminal: until
+//     screen_reset(), everything the module would send to the terminal
+//     is counted and thrown away. Nothing echoes into a sink.
+// ---------------------------------------------------------------------
+void screen_init_sink(void)
+{
+    Screen_sink = true;
+    Screen_echo = false;
+    screen_init();
+
+}//end screen_init_sink
+
+
+// ---------------------------------------------------------------------
+// Function
+//     screen_echo
+// Inputs
+//     echo
+//         Whether the terminal echoes what the user types.
+// Outputs
+//     none
+// Description
+//     Tells screen_present() whether the cells at the cursor can be
+//     trusted to stay as they were sent.
+// ---------------------------------------------------------------------
+void screen_echo(const bool echo)
+{
+    Screen_echo = echo;
+
+}//end screen_echo
+
+
+// ---------------------------------------------------------------------
+// Function
+//     screen_sink_counts
+// Inputs
+//     none
+// Outputs
+//     bytes, writes
+//         What has gone to the sink: the bytes, and in how many
+//         write()s they would have been sent.
+// ---------------------------------------------------------------------
+void screen_sink_counts(unsigned long long *bytes,
+                        unsigned long long *writes)
+{
+    *bytes  = Sink_bytes;
+    *writes = Sink_writes;
+
+}//end screen_sink_counts
+
+
 // ---------------------------------------------------------------------
 // Function
 //     screen_cursor
@@ -164,6 +471,12 @@ void screen_init(void)
 // ---------------------------------------------------------------------
 void screen_cursor(const int row, const int col)
 {
+    if (Screen_buffered) {
+        // The terminal takes row and column 0 as 1
+        Cursor_row = (row < HOME_ROW) ? HOME_ROW : row;
+        Cursor_col = (col < HOME_COL) ? HOME_COL : col;
+        return;
+    }
     printf(MOVE_CURSOR, row, col);
 }//end screen_cursor
 
@@ -182,5 +495,148 @@ void screen_cursor(const int row, const int col)
 // ---------------------------------------------------------------------
 void screen_text_color(const int color)
 {
+    if (Screen_buffered) {
+        Color = color;
+        return;
+    }
     printf(SET_BOTH_COLORS, BACKGROUND_GREEN, color);
 }//end screen_text_color
+
+
+// ---------------------------------------------------------------------
+// Function
+//     screen_printf
+// Inputs
+//     format, ...
+//         As for printf().
+// Outputs
+//     none
+// Description
+//     Draws text at the cursor in the current color, like printf().
+//     It shows up on the terminal at the next screen_present().
+// ---------------------------------------------------------------------
+void screen_printf(const char *format, ...)
+{
+    char text[MAX_PRINT];
+    va_list args;
+
+    va_start(args, format);
+    if (!Screen_buffered) {
+        vprintf(format, args);
+        va_end(args);
+        return;
+    }
+    vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+
+    for (const char *ch = text; *ch != '\0'; ++ch) {
+        draw_char(*ch);
+    }
+}//end screen_printf
+
+
+// ---------------------------------------------------------------------
+// Function
+//     screen_present
+// Inputs
+//     none
+// Outputs
+//     none
+// Description
+//     Brings the terminal up to date with the buffer in one write(),
+//     and leaves the terminal's cursor and color where the drawing
+//     left off, ready for the user's input. Only the cells that differ
+//     from the last present are sent: runs of changed cells go out
+//     after one cursor move, short gaps of unchanged cells are sent
+//     again rather than moved over, and a row that ends in blanks is
+//     cleared with one erase.
+// ---------------------------------------------------------------------
+void screen_present(void)
+{
+    static char out[OUTPUT_SIZE];
+    int used = 0;
+    int at_row = -1;            // where the terminal's cursor is, from 0
+    int at_col = -1;
+    int row = (Cursor_row > YAHTZEE_ROWS) ? YAHTZEE_ROWS : Cursor_row;
+    int col = (Cursor_col > YAHTZEE_COLS) ? YAHTZEE_COLS : Cursor_col;
+    uint64_t start = phase_begin();
+
+    if (!Screen_buffered) {
+        fflush(stdout);
+        return;
+    }
+
+    for (int r = 0; r < YAHTZEE_ROWS; ++r) {
+        struct screen_cell_t *back  = Back[r];
+        struct screen_cell_t *front = Front[r];
+        int tail = YAHTZEE_COLS;    // the row is blank from here on
+
+        while ((tail > 0) && (back[tail - 1].ch == BLANK)) {
+            --tail;
+        }
+
+        for (int c = 0; c < YAHTZEE_COLS; ++c) {
+            if (same_cell(&back[c], &front[c])) {
+                continue;
+            }
+
+            // Get the terminal's cursor here
+            if ((at_row == r) && (at_col <= c) &&
+                (c - at_col <= SKIP_LIMIT)) {
+                for (; at_col < c; ++at_col) {
+                    if ((back[at_col].ch != BLANK) &&
+                        (back[at_col].color != Term_color)) {
+                        break;
+                    }
+                    out[used++] = back[at_col].ch;
+                }
+            }
+            if ((at_row != r) || (at_col != c)) {
+                used += sprintf(out + used, MOVE_CURSOR, r + 1, c + 1);
+            }
+
+            // The rest of the row is blank: erase it in one go
+            if (c >= tail) {
+                if (Term_color == NO_COLOR) {
+                    used += send_color(out + used, WHITE_TEXT);
+                }
+                used += sprintf(out + used, ERASE_LINE);
+                for (; c < YAHTZEE_COLS; ++c) {
+                    front[c] = back[c];
+                }
+                at_row = r;
+                at_col = tail;
+                break;
+            }
+
+            used += send_color(out + used, back[c].color);
+            out[used++] = back[c].ch;
+            front[c] = back[c];
+            at_row = r;
+            at_col = c + 1;
+            if (at_col == YAHTZEE_COLS) {
+                // Where the cursor is after the last column varies
+                at_row = -1;
+            }
+        }
+    }
+
+    // Leave the cursor and color ready for the user's typing
+    if ((at_row != row - 1) || (at_col != col - 1)) {
+        used += sprintf(out + used, MOVE_CURSOR, row, col);
+    }
+    used += send_color(out + used, Color);
+    send(out, used);
+
+    // Forget what the echo of the user's typing may overwrite
+    if (Screen_echo) {
+        if (row == YAHTZEE_ROWS) {
+            fill(Front, UNKNOWN, 0, 0, SCREEN_CELLS);
+        } else {
+            // From the cursor to the end of the row below
+            fill(Front, UNKNOWN, row - 1, col - 1,
+                 YAHTZEE_COLS - (col - 1) + YAHTZEE_COLS);
+        }
+    }
+    phase_end(PHASE_PRESENT, start);
+}//end screen_present
@@ -10,13 +10,22 @@
 #ifndef SCREEN_H
 #define SCREEN_H
 
+#include <stdbool.h>
+
 #define BLACK_TEXT 30
 #define WHITE_TEXT 97
 
 extern void screen_init(void);
+extern void screen_init_sink(void);
+extern void screen_sink_counts(unsigned long long *bytes,
+                               unsigned long long *writes);
+extern void screen_echo(const bool echo);
 extern void screen_reset(void);
 extern void screen_clear(void);
 extern void screen_cursor(const int row, const int col);
 extern void screen_text_color(const int color);
+extern void screen_printf(const char *format, ...)
+            __attribute__((format(printf, 1, 2)));
+extern void screen_present(void);
 
 #endif // SCREEN_H
@@ -0,0 +1,587 @@
+// ----------------------------------------------------------------------
+// File: server.c
+//
+// Name: Jonathan Goohs
+//
+// Description: This is a YAHTZEE game server. It hosts any number of
+//     independent games from one process, for bots and load testing,
+//     speaking the line protocol of server.h on a local UNIX socket.
+//
+//     One thread runs an epoll loop over the listening socket and all
+//     the sessions. Every session has its own game_t, and its dice come
+//     from its own stream of the server's seed (stream n for the n-th
+//     session), so a session's dice do not depend on the others. The
+//     sockets are non-blocking: a session's requests are answered as
+//     they arrive, several per read if the client sends them ahead,
+//     and replies a slow client has not taken yet wait in the session,
+//     which is not read from again until they are gone.
+//
+//     On SIGINT or SIGTERM the server closes the socket and prints how
+//     many sessions and requests it served.
+//
+// Syntax: ./server [-p path] [-s seed] [-l log]
+//     -p  the socket to listen on (default yahtzee.sock)
+//     -s  seed of the sessions' random streams (default from the clock)
+//     -l  add every game played, finished or given up, to this log
+//
+// Resources:
+// 1. epoll(7) and unix(7) man pages
+// ----------------------------------------------------------------------
+#define _GNU_SOURCE             // for accept4()
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "gamelog.h"
+#include "play.h"
+#include "rng.h"
+#include "score.h"
+#include "scoretab.h"
+#include "server.h"
+
+#define MAX_EVENTS       256          // events taken per epoll_wait()
+#define SESSION_INPUT    (4 * SERVER_LINE)
+#define SESSION_OUTPUT   (16 * SERVER_LINE)
+#define ITEM_BASE        10
+
+// ****  DEFINED TYPES ****
+
+// A client connection and the game it is playing
+struct session_t {
+    int           fd;
+    unsigned int  events;         // what epoll is watching for
+    bool          playing;        // a game has been started
+    struct game_t game;
+    int           in_used;        // bytes of unanswered requests
+    char          in[SESSION_INPUT];
+    int           out_used;       // bytes of replies,
+    int           out_sent;       // and how many have been sent
+    char          out[SESSION_OUTPUT];
+};
+
+
+// **************************************************************************
+// **************************** GLOBAL VARIABLES ****************************
+// **************************************************************************
+
+static volatile sig_atomic_t Stopping = false;
+
+static int                Epoll_fd;
+static uint64_t           Seed;
+static unsigned long long Sessions;      // # sessions accepted
+static int                Open_sessions;
+static int                Peak_sessions;
+static unsigned long long Requests;      // # requests answered
+static bool               Logging = false;
+static struct gamelog_t   Log;
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     stop
+// Inputs
+//     signal
+//         SIGINT or SIGTERM.
+// Outputs
+//     none
+// Description
+//     The signal handler: asks the event loop to finish.
+// ---------------------------------------------------------------------
+static void stop(int signal)
+{
+    (void)signal;
+    Stopping = true;
+
+}//end stop
+
+
+// ---------------------------------------------------------------------
+// Function
+//     raise_file_limit
+// Inputs
+//     none
+// Outputs
+//     none
+// Description
+//     Every session takes a file descriptor, so allow as many as the
+//     hard limit lets us.
+// ---------------------------------------------------------------------
+static void raise_file_limit(void)
+{
+    struct rlimit limit;
+
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+}//end raise_file_limit
+
+
+// ---------------------------------------------------------------------
+// Function
+//     watch
+// Inputs
+//     session
+//         A session.
+// Outputs
+//     none
+// Description
+//     Tells epoll what the session waits for: replies to send, if any
+//     are waiting, and else more requests.
+// ---------------------------------------------------------------------
+static void watch(struct session_t *session)
+{
+    struct epoll_event event;
+    unsigned int events = (session->out_used > session->out_sent) ?
+                          EPOLLOUT : EPOLLIN;
+
+    if (events != session->events) {
+        event.events   = events;
+        event.data.ptr = session;
+        epoll_ctl(Epoll_fd, EPOLL_CTL_MOD, session->fd, &event);
+        session->events = events;
+    }
+
+}//end watch
+
+
+// ---------------------------------------------------------------------
+// Function
+//     close_session
+// Inputs
+//     session
+//         A session that is done, or whose client has gone.
+// Outputs
+//     none
+// ---------------------------------------------------------------------
+static void close_session(struct session_t *session)
+{
+    if (Logging && session->playing && !play_over(&session->game)) {
+        gamelog_add(&Log, &session->game);
+    }
+    close(session->fd);
+    free(session);
+    --Open_sessions;
+
+}//end close_session
+
+
+// ---------------------------------------------------------------------
+// Function
+//     accept_sessions
+// Inputs
+//     listener
+//         The listening socket.
+// Outputs
+//     none
+// Description
+//     Starts a session for every client waiting to connect.
+// ---------------------------------------------------------------------
+static void accept_sessions(const int listener)
+{
+    int fd;
+
+    while ((fd = accept4(listener, NULL, NULL, SOCK_NONBLOCK)) >= 0) {
+        struct session_t *session = calloc(1, sizeof(*session));
+        struct epoll_event event;
+
+        if (session == NULL) {
+            close(fd);
+            continue;
+        }
+        session->fd     = fd;
+        session->events = EPOLLIN;
+        rng_seed(&session->game.rng, Seed, Sessions);
+
+        event.events   = EPOLLIN;
+        event.data.ptr = session;
+        if (epoll_ctl(Epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            perror("epoll_ctl");
+            close(fd);
+            free(session);
+            continue;
+        }
+        ++Sessions;
+        if (++Open_sessions > Peak_sessions) {
+            Peak_sessions = Open_sessions;
+        }
+    }
+    if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
+        perror("accept");
+    }
+
+}//end accept_sessions
+
+
+// ---------------------------------------------------------------------
+// Function
+//     reply_state
+// Inputs
+//     session
+//         A session with room for a reply.
+// Outputs
+//     none
+// Description
+//     Replies with the state of the game: its turn, roll, dice and
+//     score, or only its score when it is over.
+// ---------------------------------------------------------------------
+static void reply_state(struct session_t *session)
+{
+    const struct game_t *game = &session->game;
+    char *out = session->out + session->out_used;
+    unsigned int used;
+    int upper;
+    int total;
+
+    score_state(game, &used, &upper, &total);
+    if (play_over(game)) {
+        session->out_used += sprintf(out, "%c %i\n", SERVER_END, total);
+    } else {
+        session->out_used += sprintf(out, "%c %u %u %u%u%u%u%u %i\n",
+                                     SERVER_DICE, game->num_turns,
+                                     game->num_rolls,
+                                     game->dice[0].value,
+                                     game->dice[1].value,
+                                     game->dice[2].value,
+                                     game->dice[3].value,
+                                     game->dice[4].value, total);
+    }
+
+}//end reply_state
+
+
+// ---------------------------------------------------------------------
+// Function
+//     reply_error
+// Inputs
+//     session
+//         A session with room for a reply.
+//     reason
+//         Why the request was refused.
+// Outputs
+//     none
+// ---------------------------------------------------------------------
+static void reply_error(struct session_t *session, const char *reason)
+{
+    session->out_used += sprintf(session->out + session->out_used,
+                                 "%c %s\n", SERVER_ERROR, reason);
+
+}//end reply_error
+
+
+// ---------------------------------------------------------------------
+// Function
+//     answer
+// Inputs
+//     session
+//         A session with room for a reply.
+//     request
+//         One request line, without its '\n'.
+// Outputs
+//     function result
+//         false if the session is to be closed.
+// Description
+//     Does what the request asks to the session's game and replies.
+// ---------------------------------------------------------------------
+static bool answer(struct session_t *session, const char *request)
+{
+    struct game_t *game = &session->game;
+
+    ++Requests;
+    if (request[0] == SERVER_QUIT) {
+        return false;
+    } else if (request[0] == SERVER_NEW) {
+        // A new game carries on with the session's random stream
+        if (Logging && session->playing && !play_over(game)) {
+            gamelog_add(&Log, game);
+        }
+        play_new_game(game);
+        session->playing = true;
+        reply_state(session);
+    } else if ((request[0] != SERVER_ROLL) && (request[0] != SERVER_SCORE)) {
+        reply_error(session, "unknown request");
+    } else if (!session->playing || play_over(game)) {
+        reply_error(session, "no game; send N");
+    } else if (request[0] == SERVER_ROLL) {
+        if (play_rolls_left(game) == 0) {
+            reply_error(session, "no rolls left");
+            return true;
+        }
+        for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+            game->dice[i].keep = false;
+        }
+        for (const char *ch = request + 1; *ch != '\0'; ++ch) {
+            if ((*ch >= '1') && (*ch < '1' + NUMBER_OF_DICE)) {
+                game->dice[*ch - '1'].keep = true;
+            }
+        }
+        play_roll(game);
+        reply_state(session);
+    } else {
+        if (play_score(game, strtol(request + 1, NULL, ITEM_BASE)) !=
+            SUCCESS) {
+            reply_error(session, "no such item, or it is used");
+            return true;
+        }
+        if (Logging && play_over(game)) {
+            gamelog_add(&Log, game);
+        }
+        reply_state(session);
+    }
+
+    return true;
+
+}//end answer
+
+
+// ---------------------------------------------------------------------
+// Function
+//     answer_lines
+// Inputs
+//     session
+//         A session whose replies have all been sent.
+// Outputs
+//     function result
+//         How many requests were answered, or -1 if the session is to
+//         be closed.
+// Description
+//     Answers the complete request lines that have been read, for as
+//     long as there is room for the replies.
+// ---------------------------------------------------------------------
+static int answer_lines(struct session_t *session)
+{
+    char *line = session->in;
+    char *end;
+    int answered = 0;
+
+    while ((session->out_used + SERVER_LINE <= (int)sizeof(session->out)) &&
+           ((end = memchr(line, '\n', session->in + session->in_used - line))
+            != NULL)) {
+        *end = '\0';
+        if (!answer(session, line)) {
+            return -1;
+        }
+        line = end + 1;
+        ++answered;
+    }
+    session->in_used -= line - session->in;
+    memmove(session->in, line, session->in_used);
+
+    return answered;
+
+}//end answer_lines
+
+
+// ---------------------------------------------------------------------
+// Function
+//     serve
+// Inputs
+//     session
+//         A session epoll has an event for.
+// Outputs
+//     function result
+//         false if the session is to be closed.
+// Description
+//     Sends the replies that are waiting, answers the requests that
+//     have been read, and reads more, until the client has nothing
+//     more to say or stops taking replies.
+// ---------------------------------------------------------------------
+static bool serve(struct session_t *session)
+{
+    ssize_t result;
+    int answered;
+
+    while (true) {
+        // Send what is waiting
+        while (session->out_sent < session->out_used) {
+            result = write(session->fd, session->out + session->out_sent,
+                           session->out_used - session->out_sent);
+            if (result < 0) {
+                if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+                    watch(session);
+                    return true;
+                } else if (errno != EINTR) {
+                    return false;
+                }
+            } else {
+                session->out_sent += result;
+            }
+        }
+        session->out_used = 0;
+        session->out_sent = 0;
+
+        // Answer what has been read, then send that
+        answered = answer_lines(session);
+        if (answered < 0) {
+            return false;
+        } else if (answered > 0) {
+            continue;
+        }
+
+        // No whole line fits: not our protocol
+        if (session->in_used == sizeof(session->in)) {
+            return false;
+        }
+
+        // Read what the client sent since
+        result = read(session->fd, session->in + session->in_used,
+                      sizeof(session->in) - session->in_used);
+        if (result == 0) {
+            return false;
+        } else if (result < 0) {
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK) ||
+                (errno == EINTR)) {
+                watch(session);
+                return true;
+            }
+            return false;
+        }
+        session->in_used += result;
+    }
+
+}//end serve
+
+
+// ---------------------------------------------------------------------
+// Function
+//     listen_on
+// Inputs
+//     path
+//         Where to put the socket.
+// Outputs
+//     function result
+//         The non-blocking listening socket, or -1.
+// ---------------------------------------------------------------------
+static int listen_on(const char *path)
+{
+    struct sockaddr_un address;
+    int fd;
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "%s: path too long\n", path);
+        return -1;
+    }
+    strcpy(address.sun_path, path);
+
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    unlink(path);
+    if ((bind(fd, (struct sockaddr *)&address, sizeof(address)) < 0) ||
+        (listen(fd, SOMAXCONN) < 0)) {
+        perror(path);
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+
+}//end listen_on
+
+
+// **************************************************************************
+// *********************************  MAIN **********************************
+// **************************************************************************
+int main(int argc, char *argv[])
+{
+    static struct epoll_event events[MAX_EVENTS];
+    const char *path = SERVER_PATH;
+    struct sigaction action;
+    struct epoll_event event;
+    int listener;
+    int opt;
+
+    Seed = time(NULL) * getpid();
+    while ((opt = getopt(argc, argv, "p:s:l:")) != -1) {
+        switch (opt) {
+        case 'p':
+            path = optarg;
+            break;
+        case 's':
+            Seed = strtoull(optarg, NULL, 0);
+            break;
+        case 'l':
+            if (gamelog_open(&Log, optarg) != SUCCESS) {
+                fprintf(stderr, "%s: cannot append to %s\n", argv[0],
+                        optarg);
+                return EXIT_FAILURE;
+            }
+            Logging = true;
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-p path] [-s seed] [-l log]\n",
+                    argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // The signals interrupt epoll_wait(), so no SA_RESTART
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = stop;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    raise_file_limit();
+    scoretab_init();
+
+    listener = listen_on(path);
+    Epoll_fd = epoll_create1(0);
+    if ((listener < 0) || (Epoll_fd < 0)) {
+        return EXIT_FAILURE;
+    }
+    event.events   = EPOLLIN;
+    event.data.ptr = NULL;          // the listener has no session
+    epoll_ctl(Epoll_fd, EPOLL_CTL_ADD, listener, &event);
+    printf("Serving on %s, seed %llu\n", path, (unsigned long long)Seed);
+    fflush(stdout);
+
+    while (!Stopping) {
+        int ready = epoll_wait(Epoll_fd, events, MAX_EVENTS, -1);
+
+        if ((ready < 0) && (errno != EINTR)) {
+            perror("epoll_wait");
+            break;
+        }
+        for (int i = 0; i < ready; ++i) {
+            struct session_t *session = events[i].data.ptr;
+
+            if (session == NULL) {
+                accept_sessions(listener);
+            } else if (!serve(session)) {
+                close_session(session);
+            }
+        }
+    }
+
+    close(listener);
+    unlink(path);
+    if (Logging) {
+        gamelog_close(&Log);
+    }
+    printf("%llu sessions (%i at most at once, %i still open), "
+           "%llu requests\n", Sessions, Peak_sessions, Open_sessions,
+           Requests);
+
+    return EXIT_SUCCESS;
+
+} // end main
+
+// end server.c
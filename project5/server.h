@@ -0,0 +1,38 @@
+// -------------------------------------------------------------------
+// File: server.h
+//
+// Name: Jonathan Goohs
+//
+// Description: This is the header file for the protocol between the
+//     YAHTZEE game server (./server) and its clients, e.g. ./bots.
+//     Both ways it is one short line of text per message, so it can
+//     be tried out by hand with "nc -U yahtzee.sock".
+//
+//     Requests:
+//         N               start a new game
+//         R [dice]        reroll, keeping the dice listed, e.g. "R 135"
+//         S item          score the dice in item 1 (Aces) to 13 (Chance)
+//         Q               end the session
+//     Replies, one per request:
+//         D turn roll dice total
+//                         the game, e.g. "D 3 1 25563 42": turn 3,
+//                         first roll, dice 2 5 5 6 3, 42 points so far
+//         E total         the game is over
+//         X reason        the request was refused
+// -------------------------------------------------------------------
+#ifndef SERVER_H
+#define SERVER_H
+
+#define SERVER_PATH    "yahtzee.sock"   // default socket
+#define SERVER_LINE    64               // longest line, '\n' included
+
+#define SERVER_NEW     'N'
+#define SERVER_ROLL    'R'
+#define SERVER_SCORE   'S'
+#define SERVER_QUIT    'Q'
+
+#define SERVER_DICE    'D'
+#define SERVER_END     'E'
+#define SERVER_ERROR   'X'
+
+#endif
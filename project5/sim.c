@@ -0,0 +1,557 @@
+// ----------------------------------------------------------------------
+// File: sim.c
+//
+// Name: Jonathan Goohs
+//
+// Description: This is a headless Monte Carlo simulator for the YAHTZEE
+//     game. It plays millions of solitaire games with a fixed strategy
+//     on a pool of worker threads and reports the distribution of the
+//     final scores (mean, spread, percentiles), how often each scorecard
+//     item is filled with a non-zero score, and how fast games are
+//     played.
+//
+//     The default strategy is a simple greedy one. With -o the games
+//     are played optimally from a SOLVER table instead, which checks
+//     the solver: the mean score must come out at the value it expects.
+//
+//     The games are played with the same PLAY and SCORE modules as the
+//     interactive game, through a game_t of each worker's own, so the
+//     simulator plays by exactly the same rules. Every game_t carries
+//     its own random number stream, every worker has its own statistics,
+//     and the statistics are only merged after all the workers are
+//     done, so the threads share nothing while playing.
+//
+// Syntax: ./sim [-g games] [-t threads] [-s seed] [-o table] [-S] [-l log]
+//     -g  number of games to play (default 1000000)
+//     -t  number of worker threads (default 1)
+//     -s  seed of the random number streams (default from the clock)
+//     -o  play optimally with this table from ./solve
+//     -S  scaling run: play the games with 1, 2, 4, ... up to -t
+//         threads and report games/s for each
+//     -l  add every game to this log; each worker writes its own
+//         batches of whole games
+//
+// Resources:
+// 1. pthread_create man page
+// ----------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <math.h>
+#include <pthread.h>
+#include "gamelog.h"
+#include "play.h"
+#include "rng.h"
+#include "score.h"
+#include "scoretab.h"
+#include "solver.h"
+
+#define DEFAULT_GAMES     1000000L
+#define DEFAULT_THREADS   1
+#define MAX_THREADS       256
+#define NUMBER_OF_ITEMS   13
+#define MAX_GAME_SCORE    400       // 375 is the best possible game
+#define CACHE_LINE        64
+#define NSEC_PER_SEC      1000000000L
+#define PERCENT           100.0
+
+// Order in which items are given up when a roll scores nothing
+static const int Dump_order[NUMBER_OF_ITEMS] = {
+    ACES, YAHTZEE, TWOS, STRAIGHT_LG, KIND4, THREES, FULL_HOUSE,
+    STRAIGHT_SM, FOURS, KIND3, FIVES, SIXES, CHANCE
+};
+
+// Short names of the items, for the report
+static const char *Item_names[NUMBER_OF_ITEMS + 1] = {
+    "", "Aces", "Twos", "Threes", "Fours", "Fives", "Sixes",
+    "3 of a Kind", "4 of a Kind", "Full House", "Sm. Straight",
+    "Lg. Straight", "YAHTZEE", "Chance"
+};
+
+// Percentiles of the final score that are reported
+static const double Percentiles[] = { 1, 10, 25, 50, 75, 90, 99 };
+
+
+// **************************************************************************
+// ****************************  DEFINED TYPES   ****************************
+// **************************************************************************
+
+// The results of many games. Each worker has its own, and they are
+// merged when all the workers are done.
+struct sim_stats_t {
+    unsigned long games;
+    unsigned long bonuses;                          // games with the bonus
+    unsigned long histogram[MAX_GAME_SCORE + 1];    // # games per score
+    unsigned long hits[NUMBER_OF_ITEMS + 1];        // # non-zero scores
+    unsigned long item_total[NUMBER_OF_ITEMS + 1];  // sum of the scores
+};
+
+// A worker thread; aligned so workers never share a cache line
+struct sim_worker_t {
+    pthread_t          thread;
+    long               games;        // # games this worker plays
+    struct game_t      game;         // the game being played
+    struct gamelog_t  *log;          // where the games go, if anywhere
+    struct sim_stats_t stats;
+} __attribute__((aligned(CACHE_LINE)));
+
+
+// **************************************************************************
+// **************************** GLOBAL VARIABLES ****************************
+// **************************************************************************
+
+static struct sim_worker_t Workers[MAX_THREADS];
+static bool Optimal = false;      // play from the solver table
+static const char *Log_path = NULL;
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     choose_keep
+// Inputs
+//     used
+//         The items used so far, bit item-1 for each.
+//     values
+//         The dice.
+// Outputs
+//     keep
+//         Whether to keep each die.
+// Description
+//     This is the strategy for rerolls. With four dice of an open
+//     straight already showing, those four are kept; otherwise all the
+//     dice of the most common face are kept (the higher face on a tie).
+// ---------------------------------------------------------------------
+static void choose_keep(const unsigned int used,
+                        const unsigned char values[], bool keep[])
+{
+    static const int runs[] = { ACES, TWOS, THREES };
+    int counts[NUMBER_OF_SIDES + 1] = { 0 };
+    int best = ACES;
+
+    for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+        ++counts[values[i]];
+    }
+
+    // Go for an open straight when four in a row are showing
+    if ((used & (SOLVER_ITEM_BIT(STRAIGHT_SM) |
+                 SOLVER_ITEM_BIT(STRAIGHT_LG))) !=
+        (SOLVER_ITEM_BIT(STRAIGHT_SM) | SOLVER_ITEM_BIT(STRAIGHT_LG))) {
+        for (int r = 0; r < (int)(sizeof(runs) / sizeof(runs[0])); ++r) {
+            int start = runs[r];
+
+            if (counts[start] && counts[start + 1] &&
+                counts[start + 2] && counts[start + 3]) {
+                bool taken[NUMBER_OF_SIDES + 1] = { false };
+
+                for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+                    keep[i] = (values[i] >= start) &&
+                              (values[i] <= start + 3) &&
+                              !taken[values[i]];
+                    taken[values[i]] |= keep[i];
+                }
+                return;
+            }
+        }
+    }
+
+    // Otherwise collect the most common face
+    for (int face = TWOS; face <= SIXES; ++face) {
+        if (counts[face] >= counts[best]) {
+            best = face;
+        }
+    }
+    for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+        keep[i] = (values[i] == best);
+    }
+
+}//end choose_keep
+
+
+// ---------------------------------------------------------------------
+// Function
+//     choose_item
+// Inputs
+//     used
+//         The items used so far, bit item-1 for each.
+//     key
+//         The SCORETAB key of the final dice of the turn.
+// Outputs
+//     function result
+// Description
+//     This is the strategy for scoring: the open item with the highest
+//     score, or, when no open item scores, the first open item of
+//     Dump_order.
+// ---------------------------------------------------------------------
+static int choose_item(const unsigned int used, const int key)
+{
+    int best = 0;
+    int best_score = 0;
+
+    for (int item = ACES; item <= CHANCE; ++item) {
+        if (!(used & SOLVER_ITEM_BIT(item)) &&
+            (scoretab_score(key, item) > best_score)) {
+            best = item;
+            best_score = scoretab_score(key, item);
+        }
+    }
+    for (int i = 0; (best == 0) && (i < NUMBER_OF_ITEMS); ++i) {
+        if (!(used & SOLVER_ITEM_BIT(Dump_order[i]))) {
+            best = Dump_order[i];
+        }
+    }
+
+    return best;
+
+}//end choose_item
+
+
+// ---------------------------------------------------------------------
+// Function
+//     keep_dice
+// Inputs
+//     keep
+//         The REROLL keep chosen by the solver.
+//     values
+//         The dice.
+// Outputs
+//     keep_flags
+//         Whether to keep each die.
+// Description
+//     Marks the dice that make up the keep, one die per kept value.
+// ---------------------------------------------------------------------
+static void keep_dice(const int keep, const unsigned char values[],
+                      bool keep_flags[])
+{
+    unsigned char kept[NUMBER_OF_DICE];
+    int count = reroll_size(keep);
+
+    reroll_dice(keep, kept);
+    for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+        keep_flags[i] = false;
+        for (int k = 0; k < count; ++k) {
+            if (kept[k] == values[i]) {
+                keep_flags[i] = true;
+                kept[k] = 0;             // each kept value is used once
+                break;
+            }
+        }
+    }
+
+}//end keep_dice
+
+
+// ---------------------------------------------------------------------
+// Function
+//     play_game
+// Inputs
+//     worker
+//         The worker playing the game.
+// Outputs
+//     none
+// Description
+//     Plays one game of 13 turns and adds its results to the worker's
+//     statistics.
+// ---------------------------------------------------------------------
+static void play_game(struct sim_worker_t *worker)
+{
+    struct game_t *game = &worker->game;
+    struct solver_turn_t plan;       // the solver's values of the turn
+    struct sim_stats_t *stats = &worker->stats;
+    unsigned char values[NUMBER_OF_DICE];
+    bool keep[NUMBER_OF_DICE];
+    unsigned int used;
+    int upper;
+    int total;
+
+    // Carry on with the random stream of the last game
+    play_new_game(game);
+    while (!play_over(game)) {
+        int item;
+
+        score_state(game, &used, &upper, &total);
+        if (Optimal) {
+            solver_turn(used, upper, &plan);
+        }
+
+        for (int left = play_rolls_left(game); left > 0; --left) {
+            for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+                values[i] = game->dice[i].value;
+            }
+            if (Optimal) {
+                keep_dice(solver_best_keep(&plan, play_dice_key(game), left),
+                          values, keep);
+            } else {
+                choose_keep(used, values, keep);
+            }
+            for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+                game->dice[i].keep = keep[i];
+            }
+            play_roll(game);
+        }
+
+        item = Optimal ? solver_best_item(used, upper, play_dice_key(game))
+                       : choose_item(used, play_dice_key(game));
+        play_score(game, item);
+    }
+
+    score_state(game, &used, &upper, &total);
+    stats->bonuses += (game->bonus != 0);
+    ++stats->games;
+    ++stats->histogram[total];
+    for (int item = ACES; item <= CHANCE; ++item) {
+        stats->hits[item] += (game->score[item].value != 0);
+        stats->item_total[item] += game->score[item].value;
+    }
+
+}//end play_game
+
+
+// ---------------------------------------------------------------------
+// Function
+//     run_worker
+// Inputs
+//     arg
+//         The worker.
+// Outputs
+//     function result (always NULL)
+// Description
+//     The thread function: plays the worker's share of the games.
+// ---------------------------------------------------------------------
+static void *run_worker(void *arg)
+{
+    struct sim_worker_t *worker = arg;
+
+    if (Log_path != NULL) {
+        worker->log = malloc(sizeof(*worker->log));
+        if ((worker->log == NULL) ||
+            (gamelog_open(worker->log, Log_path) != SUCCESS)) {
+            perror(Log_path);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    for (long game = 0; game < worker->games; ++game) {
+        play_game(worker);
+        if (worker->log != NULL) {
+            gamelog_add(worker->log, &worker->game);
+        }
+    }
+
+    if (worker->log != NULL) {
+        gamelog_close(worker->log);
+        free(worker->log);
+    }
+
+    return NULL;
+
+}//end run_worker
+
+
+// ---------------------------------------------------------------------
+// Function
+//     simulate
+// Inputs
+//     games, threads, seed
+//         What to play, on how many threads, and the seed of the
+//         random streams; worker i uses stream i of the seed.
+// Outputs
+//     stats
+//         The merged results of all the workers.
+//     function result
+//         The wall clock time of the run in seconds.
+// Description
+//     Splits the games over the workers, runs them, and merges their
+//     statistics.
+// ---------------------------------------------------------------------
+static double simulate(const long games, const int threads,
+                       const uint64_t seed, struct sim_stats_t *stats)
+{
+    struct timespec start;
+    struct timespec stop;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int t = 0; t < threads; ++t) {
+        memset(&Workers[t], 0, sizeof(Workers[t]));
+        Workers[t].games = games / threads + (t < games % threads);
+        rng_seed(&Workers[t].game.rng, seed, t);
+        if (pthread_create(&Workers[t].thread, NULL, run_worker,
+                           &Workers[t]) != 0) {
+            perror("pthread_create");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    for (int t = 0; t < threads; ++t) {
+        struct sim_stats_t *part = &Workers[t].stats;
+
+        pthread_join(Workers[t].thread, NULL);
+        stats->games   += part->games;
+        stats->bonuses += part->bonuses;
+        for (int score = 0; score <= MAX_GAME_SCORE; ++score) {
+            stats->histogram[score] += part->histogram[score];
+        }
+        for (int item = ACES; item <= CHANCE; ++item) {
+            stats->hits[item]       += part->hits[item];
+            stats->item_total[item] += part->item_total[item];
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+
+    return (stop.tv_sec - start.tv_sec) +
+           (double)(stop.tv_nsec - start.tv_nsec) / NSEC_PER_SEC;
+
+}//end simulate
+
+
+// ---------------------------------------------------------------------
+// Function
+//     report
+// Inputs
+//     stats
+//         The merged results.
+// Outputs
+//     none
+// Description
+//     Prints the score distribution and the per-item figures.
+// ---------------------------------------------------------------------
+static void report(const struct sim_stats_t *stats)
+{
+    double n = stats->games;
+    double sum = 0;
+    double squares = 0;
+    int low = -1;
+    int high = 0;
+    unsigned long seen = 0;
+    int p = 0;
+    const int percentiles = sizeof(Percentiles) / sizeof(Percentiles[0]);
+
+    for (int score = 0; score <= MAX_GAME_SCORE; ++score) {
+        if (stats->histogram[score] != 0) {
+            if (low < 0) {
+                low = score;
+            }
+            high = score;
+        }
+        sum     += (double)score * stats->histogram[score];
+        squares += (double)score * score * stats->histogram[score];
+    }
+    printf("Score: mean %.2f  sd %.2f  min %i  max %i\n", sum / n,
+           sqrt(squares / n - (sum / n) * (sum / n)), low, high);
+
+    // Walk the histogram once for all the percentiles
+    printf("Percentiles:");
+    for (int score = 0; (score <= MAX_GAME_SCORE) && (p < percentiles);
+         ++score) {
+        seen += stats->histogram[score];
+        while ((p < percentiles) && (seen >= Percentiles[p] * n / PERCENT)) {
+            printf("  p%g %i", Percentiles[p], score);
+            ++p;
+        }
+    }
+    printf("\n\n");
+
+    printf("%-14s %7s %7s\n", "Item", "hit %", "mean");
+    for (int item = ACES; item <= CHANCE; ++item) {
+        printf("%-14s %7.2f %7.2f\n", Item_names[item],
+               PERCENT * stats->hits[item] / n, stats->item_total[item] / n);
+    }
+    printf("%-14s %7.2f %7.2f\n", "Upper bonus",
+           PERCENT * stats->bonuses / n, BONUS_VALUE * stats->bonuses / n);
+
+}//end report
+
+
+// **************************************************************************
+// *********************************  MAIN **********************************
+// **************************************************************************
+int main(int argc, char *argv[])
+{
+    static struct sim_stats_t stats;
+    long games = DEFAULT_GAMES;
+    int threads = DEFAULT_THREADS;
+    unsigned long long seed = time(NULL) * getpid();
+    bool scaling = false;
+    double seconds;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "g:t:s:o:Sl:")) != -1) {
+        switch (opt) {
+        case 'g':
+            games = atol(optarg);
+            break;
+        case 't':
+            threads = atoi(optarg);
+            break;
+        case 's':
+            seed = strtoull(optarg, NULL, 0);
+            break;
+        case 'o':
+            if (solver_load(optarg) != SUCCESS) {
+                fprintf(stderr, "%s: cannot load %s; run ./solve\n",
+                        argv[0], optarg);
+                return EXIT_FAILURE;
+            }
+            Optimal = true;
+            break;
+        case 'S':
+            scaling = true;
+            break;
+        case 'l':
+            Log_path = optarg;
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-g games] [-t threads] "
+                    "[-s seed] [-o table] [-S] [-l log]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if ((games < 1) || (threads < 1) || (threads > MAX_THREADS)) {
+        fprintf(stderr, "%s: need at least 1 game and 1 to %i threads\n",
+                argv[0], MAX_THREADS);
+        return EXIT_FAILURE;
+    }
+
+    // The tables are read-only once built, so the workers can share them
+    scoretab_init();
+
+    if (scaling) {
+        double base = 0;
+
+        printf("%li games, %li online CPUs\n", games,
+               sysconf(_SC_NPROCESSORS_ONLN));
+        printf("%7s %9s %12s %8s\n", "threads", "seconds", "games/s",
+               "speedup");
+        for (int t = 1; t <= threads; t *= 2) {
+            seconds = simulate(games, t, seed, &stats);
+            if (t == 1) {
+                base = seconds;
+            }
+            printf("%7i %9.3f %12.0f %8.2f\n", t, seconds, games / seconds,
+                   base / seconds);
+        }
+        return EXIT_SUCCESS;
+    }
+
+    seconds = simulate(games, threads, seed, &stats);
+    printf("%li games on %i thread%s, seed %llu: %.3f s, %.0f games/s\n\n",
+           games, threads, (threads == 1) ? "" : "s", seed, seconds,
+           games / seconds);
+    if (Optimal) {
+        printf("Optimal strategy; the solver expects %.2f\n\n",
+               solver_value(0, 0));
+    }
+    report(&stats);
+
+    return EXIT_SUCCESS;
+
+} // end main
+
+// end sim.c
@@ -0,0 +1,67 @@
+// ----------------------------------------------------------------------
+// File: solve.c
+//
+// Name: Jonathan Goohs
+//
+// Description: This program solves solitaire YAHTZEE with the SOLVER
+//     module and writes the table of expected scores that the game and
+//     the simulator map at start-up. It reports how long solving took
+//     and the expected final score of optimal play.
+//
+// Syntax: ./solve [-t threads] [-f file]
+//     -t  number of worker threads per layer (default: online CPUs)
+//     -f  table file to write (default yahtzee.ev)
+// ----------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include "solver.h"
+
+#define NSEC_PER_SEC  1000000000L
+
+
+// **************************************************************************
+// *********************************  MAIN **********************************
+// **************************************************************************
+int main(int argc, char *argv[])
+{
+    const char *path = SOLVER_FILE;
+    int threads = sysconf(_SC_NPROCESSORS_ONLN);
+    struct timespec start;
+    struct timespec stop;
+    double seconds;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:f:")) != -1) {
+        switch (opt) {
+        case 't':
+            threads = atoi(optarg);
+            break;
+        case 'f':
+            path = optarg;
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-t threads] [-f file]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (solver_build(path, threads) != SUCCESS) {
+        return EXIT_FAILURE;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    seconds = (stop.tv_sec - start.tv_sec) +
+              (double)(stop.tv_nsec - start.tv_nsec) / NSEC_PER_SEC;
+
+    printf("Solved %i states on %i thread%s in %.2f s, wrote %s\n",
+           SOLVER_MASKS * SOLVER_UPPERS, threads, (threads == 1) ? "" : "s",
+           seconds, path);
+    printf("Expected score with optimal play: %.4f\n", solver_value(0, 0));
+
+    return EXIT_SUCCESS;
+
+} // end main
+
+// end solve.c
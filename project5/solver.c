@@ -0,0 +1,633 @@
+// ----------------------------------------------------------------------
+// File: solver.c
+//
+// Name: Jonathan Goohs
+//
+// Description: This is the implementation of the SOLVER module of the
+//     YAHTZEE game. It computes, by dynamic programming, the expected
+//     final score of optimal solitaire play from every scorecard state:
+//     13 used-item bits times the upper subtotal 0 thru 63.
+//
+//     The value of a state is the value of its turn: roll five dice,
+//     pick the best keep twice, then the best item. Scoring an item
+//     moves to a state with one more item used, so the states are
+//     solved in layers, from the full scorecard (worth nothing more)
+//     back to the empty one. The states of a layer only depend on the
+//     layer after them, so each layer is split over worker threads.
+//
+//     The bonus follows score.c exactly: BONUS_VALUE is earned by the
+//     item that brings the upper subtotal to LEFT_BONUS_SUBTOTAL or
+//     more, which is why subtotals above it are all the same state.
+//
+//     The table (2 MiB of floats) is written to a file with a small
+//     header; later runs mmap it read-only instead of solving again.
+//
+// Resources:
+// 1. mmap man page
+// 2. J. Glenn, "An Optimal Strategy for Yahtzee" (2006)
+// ----------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "play.h"
+#include "solver.h"
+
+#define SOLVER_MAGIC      "YZEV"
+#define SOLVER_VERSION    1
+#define MAX_THREADS       256
+#define UPPER_MASK        ((1u << SIXES) - 1)   // bits of ACES thru SIXES
+#define ALL_USED          (SOLVER_MASKS - 1)
+#define MAX_DICE_OF_FACE  NUMBER_OF_DICE
+#define NO_ITEM           0
+
+// **************************************************************************
+// ****************************  DEFINED TYPES   ****************************
+// **************************************************************************
+
+// The start of the table file
+struct solver_header_t {
+    char     magic[4];
+    uint32_t version;
+    uint32_t masks;            // SOLVER_MASKS
+    uint32_t uppers;           // SOLVER_UPPERS
+};
+
+// One worker solving part of a layer
+struct solver_worker_t {
+    pthread_t thread;
+    int       first;           // every "step"th mask of the layer,
+    int       step;            // starting from "first"
+    int       layer;           // # items used in the layer
+};
+
+
+// **************************************************************************
+// **************************** GLOBAL VARIABLES ****************************
+// **************************************************************************
+
+// The expected rest-of-game score of every state, [used][upper]
+static const float *Values = NULL;
+
+// The mapped file, when the table was loaded
+static void  *Mapping = NULL;
+static size_t Mapping_size = 0;
+
+// Which upper subtotals can happen with each set of upper items used
+static bool Reachable[UPPER_MASK + 1][SOLVER_UPPERS];
+
+// The table being solved
+static float *Building = NULL;
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     find_reachable
+// Inputs
+//     none
+// Outputs
+//     none
+// Description
+//     Fills Reachable[]: with the upper items of "mask" used, the
+//     subtotal is a sum of count * face, 0 thru 5 dice of each face.
+//     States that cannot happen are skipped by the solver.
+// ---------------------------------------------------------------------
+static void find_reachable(void)
+{
+    for (unsigned int mask = 0; mask <= UPPER_MASK; ++mask) {
+        memset(Reachable[mask], false, sizeof(Reachable[mask]));
+        Reachable[mask][0] = true;
+        for (int face = ACES; face <= SIXES; ++face) {
+            if (!(mask & SOLVER_ITEM_BIT(face))) {
+                continue;
+            }
+            // Add the face to every subtotal found without it
+            for (int upper = SOLVER_UPPERS - 1; upper >= 0; --upper) {
+                if (!Reachable[mask][upper]) {
+                    continue;
+                }
+                for (int count = 1; count <= MAX_DICE_OF_FACE; ++count) {
+                    int total = upper + count * face;
+
+                    if (total >= SOLVER_UPPERS) {
+                        total = SOLVER_UPPERS - 1;
+                    }
+                    Reachable[mask][total] = true;
+                }
+            }
+        }
+    }
+
+}//end find_reachable
+
+
+// ---------------------------------------------------------------------
+// Function
+//     score_item
+// Inputs
+//     used, upper
+//         The scorecard state.
+//     key
+//         The final roll of the turn.
+//     item
+//         An unused item.
+// Outputs
+//     function result
+// Description
+//     Returns the score of the roll in the item, plus the bonus if it
+//     is earned by this item, plus the value of the state it leads to
+//     (zero when no table is loaded).
+// ---------------------------------------------------------------------
+static float score_item(const unsigned int used, const int upper,
+                        const int key, const int item)
+{
+    int score = scoretab_score(key, item);
+    int next  = upper;
+    float value = score;
+
+    if (item <= SIXES) {
+        next = upper + score;
+        if ((upper < LEFT_BONUS_SUBTOTAL) && (next >= LEFT_BONUS_SUBTOTAL)) {
+            value += BONUS_VALUE;
+        }
+        if (next >= SOLVER_UPPERS) {
+            next = SOLVER_UPPERS - 1;
+        }
+    }
+
+    if (Values == NULL) {
+        return value;
+    }
+
+    return value +
+           Values[(used | SOLVER_ITEM_BIT(item)) * SOLVER_UPPERS + next];
+
+}//end score_item
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solve_layer_part
+// Inputs
+//     arg
+//         The worker.
+// Outputs
+//     function result (always NULL)
+// Description
+//     The thread function: solves the worker's share of the states of
+//     one layer, reading only the layer after it.
+// ---------------------------------------------------------------------
+static void *solve_layer_part(void *arg)
+{
+    struct solver_worker_t *worker = arg;
+    struct solver_turn_t *turn = malloc(sizeof(*turn));
+    int seen = 0;
+
+    for (unsigned int used = 0; used < SOLVER_MASKS; ++used) {
+        if (__builtin_popcount(used) != worker->layer) {
+            continue;
+        }
+        if (seen++ % worker->step != worker->first) {
+            continue;
+        }
+        for (int upper = 0; upper < SOLVER_UPPERS; ++upper) {
+            float value = 0;
+
+            if (Reachable[used & UPPER_MASK][upper]) {
+                value = solver_turn(used, upper, turn);
+            }
+            Building[used * SOLVER_UPPERS + upper] = value;
+        }
+    }
+    free(turn);
+
+    return NULL;
+
+}//end solve_layer_part
+
+
+// ---------------------------------------------------------------------
+// Function
+//     write_table
+// Inputs
+//     path
+//         The file to write.
+// Outputs
+//     function result
+//         SUCCESS or !SUCCESS.
+// Description
+//     Writes the header and the solved table to a temporary file and
+//     renames it over "path", so a reader never maps half a table.
+// ---------------------------------------------------------------------
+static int write_table(const char *path)
+{
+    struct solver_header_t header;
+    char temp[FILENAME_MAX];
+    FILE *file;
+    size_t count = (size_t)SOLVER_MASKS * SOLVER_UPPERS;
+    bool ok;
+
+    memcpy(header.magic, SOLVER_MAGIC, sizeof(header.magic));
+    header.version = SOLVER_VERSION;
+    header.masks   = SOLVER_MASKS;
+    header.uppers  = SOLVER_UPPERS;
+
+    snprintf(temp, sizeof(temp), "%s.tmp", path);
+    file = fopen(temp, "wb");
+    if (file == NULL) {
+        perror(temp);
+        return !SUCCESS;
+    }
+    ok = (fwrite(&header, sizeof(header), 1, file) == 1) &&
+         (fwrite(Building, sizeof(*Building), count, file) == count);
+    ok = (fclose(file) == 0) && ok;
+    if (!ok || (rename(temp, path) != 0)) {
+        perror(path);
+        unlink(temp);
+        return !SUCCESS;
+    }
+
+    return SUCCESS;
+
+}//end write_table
+
+
+// **************************************************************************
+// *************************** EXTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_build
+// Inputs
+//     path
+//         The file to write the table to.
+//     threads
+//         How many worker threads to solve each layer with.
+// Outputs
+//     function result
+//         SUCCESS or !SUCCESS.
+// Description
+//     Solves every scorecard state and writes the table. The table is
+//     also left in use, as if solver_load() had been called.
+// ---------------------------------------------------------------------
+int solver_build(const char *path, const int threads)
+{
+    struct solver_worker_t workers[MAX_THREADS];
+    int count = (threads < 1) ? 1 : (threads > MAX_THREADS) ? MAX_THREADS
+                                                            : threads;
+
+    reroll_init();
+    find_reachable();
+    solver_unload();
+
+    Building = calloc((size_t)SOLVER_MASKS * SOLVER_UPPERS,
+                      sizeof(*Building));
+    if (Building == NULL) {
+        perror("solver_build");
+        return !SUCCESS;
+    }
+    Values = Building;
+
+    // The full scorecard is worth nothing more (calloc'd zeros)
+    for (int layer = SOLVER_ITEMS - 1; layer >= 0; --layer) {
+        for (int t = 0; t < count; ++t) {
+            workers[t].first = t;
+            workers[t].step  = count;
+            workers[t].layer = layer;
+            if (pthread_create(&workers[t].thread, NULL, solve_layer_part,
+                               &workers[t]) != 0) {
+                perror("pthread_create");
+                exit(EXIT_FAILURE);
+            }
+        }
+        for (int t = 0; t < count; ++t) {
+            pthread_join(workers[t].thread, NULL);
+        }
+    }
+
+    return write_table(path);
+
+}//end solver_build
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_load
+// Inputs
+//     path
+//         A table file written by solver_build().
+// Outputs
+//     function result
+//         SUCCESS, or !SUCCESS if the file is missing or not a table of
+//         this version and size (a message says which).
+// Description
+//     Maps the table read-only, which makes it ready at once; pages
+//     are read from the file as they are first used.
+// ---------------------------------------------------------------------
+int solver_load(const char *path)
+{
+    struct solver_header_t header;
+    struct stat info;
+    size_t size = sizeof(header) +
+                  (size_t)SOLVER_MASKS * SOLVER_UPPERS * sizeof(float);
+    void *map;
+    int fd;
+
+    reroll_init();
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return !SUCCESS;
+    }
+    if ((fstat(fd, &info) != 0) || ((size_t)info.st_size != size)) {
+        fprintf(stderr, "%s: not a solver table of the right size\n", path);
+        close(fd);
+        return !SUCCESS;
+    }
+    map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror(path);
+        return !SUCCESS;
+    }
+
+    memcpy(&header, map, sizeof(header));
+    if ((memcmp(header.magic, SOLVER_MAGIC, sizeof(header.magic)) != 0) ||
+        (header.version != SOLVER_VERSION) ||
+        (header.masks != SOLVER_MASKS) || (header.uppers != SOLVER_UPPERS)) {
+        fprintf(stderr, "%s: wrong solver table version\n", path);
+        munmap(map, size);
+        return !SUCCESS;
+    }
+
+    solver_unload();
+    Mapping      = map;
+    Mapping_size = size;
+    Values       = (const float *)((const char *)map + sizeof(header));
+
+    return SUCCESS;
+
+}//end solver_load
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_unload
+// Inputs
+//     none
+// Outputs
+//     none
+// Description
+//     Releases the table, mapped or built.
+// ---------------------------------------------------------------------
+void solver_unload(void)
+{
+    if (Mapping != NULL) {
+        munmap(Mapping, Mapping_size);
+        Mapping = NULL;
+    }
+    free(Building);
+    Building = NULL;
+    Values   = NULL;
+
+}//end solver_unload
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_loaded
+// Inputs
+//     none
+// Outputs
+//     function result
+// Description
+//     Returns true if a table is in use. Without one, solver_value()
+//     is zero and the other functions below play for the best score of
+//     the current turn only.
+// ---------------------------------------------------------------------
+bool solver_loaded(void)
+{
+    return Values != NULL;
+
+}//end solver_loaded
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_value
+// Inputs
+//     used
+//         The items used so far, bit item-1 for each.
+//     upper
+//         The upper section subtotal so far.
+// Outputs
+//     function result
+// Description
+//     Returns the expected score of the rest of the game (bonus
+//     included) with optimal play, or zero if no table is loaded.
+// ---------------------------------------------------------------------
+double solver_value(const unsigned int used, const int upper)
+{
+    int capped = (upper < SOLVER_UPPERS) ? upper : SOLVER_UPPERS - 1;
+
+    if (Values == NULL) {
+        return 0;
+    }
+
+    return Values[(used & ALL_USED) * SOLVER_UPPERS + capped];
+
+}//end solver_value
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_turn
+// Inputs
+//     used, upper
+//         The scorecard state at the start of the turn, which must not
+//         be full. The states after it must be solved already (or no
+//         table loaded).
+// Outputs
+//     turn
+//         The value of every roll and keep of the turn.
+//     function result
+//         The expected rest-of-game score of the state.
+// Description
+//     Works backward through the turn: the value of a final roll is its
+//     best item; the value of a keep is the average over the next die
+//     of its children (a keep of five dice is worth its roll); and the
+//     value of a roll before a reroll is its best keep.
+// ---------------------------------------------------------------------
+double solver_turn(const unsigned int used, const int upper,
+                   struct solver_turn_t *turn)
+{
+    int capped = (upper < SOLVER_UPPERS) ? upper : SOLVER_UPPERS - 1;
+    double expected = 0;
+
+    for (int key = 0; key < SCORETAB_KEYS; ++key) {
+        float best = 0;
+
+        for (int item = ACES; item <= CHANCE; ++item) {
+            if (!(used & SOLVER_ITEM_BIT(item))) {
+                float value = score_item(used, capped, key, item);
+
+                if (value > best) {
+                    best = value;
+                }
+            }
+        }
+        turn->roll_value[0][key] = best;
+    }
+
+    for (int left = 1; left <= SOLVER_REROLLS; ++left) {
+        float *keeps = turn->keep_value[left - 1];
+        const float *rolls = turn->roll_value[left - 1];
+
+        // Children are numbered after their parents
+        for (int keep = REROLL_KEEPS - 1; keep >= 0; --keep) {
+            float sum = 0;
+
+            if (reroll_size(keep) == NUMBER_OF_DICE) {
+                keeps[keep] = rolls[reroll_keep_roll(keep)];
+                continue;
+            }
+            for (int face = ACES; face <= SIXES; ++face) {
+                sum += keeps[reroll_child(keep, face)];
+            }
+            keeps[keep] = sum / NUMBER_OF_SIDES;
+        }
+
+        for (int key = 0; key < SCORETAB_KEYS; ++key) {
+            const short *subkeeps;
+            int count = reroll_subkeeps(key, &subkeeps);
+            float best = 0;
+
+            for (int i = 0; i < count; ++i) {
+                if (keeps[subkeeps[i]] > best) {
+                    best = keeps[subkeeps[i]];
+                }
+            }
+            turn->roll_value[left][key] = best;
+        }
+    }
+
+    for (int key = 0; key < SCORETAB_KEYS; ++key) {
+        expected += reroll_probability(key) *
+                    turn->roll_value[SOLVER_REROLLS][key];
+    }
+
+    return expected;
+
+}//end solver_turn
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_best_keep
+// Inputs
+//     turn
+//         The values of the turn, from solver_turn().
+//     key
+//         The roll.
+//     rerolls_left
+//         1 or 2.
+// Outputs
+//     function result
+// Description
+//     Returns the keep with the highest expected value; keeping all
+//     five dice means not rerolling.
+// ---------------------------------------------------------------------
+int solver_best_keep(const struct solver_turn_t *turn, const int key,
+                     const int rerolls_left)
+{
+    const float *keeps = turn->keep_value[rerolls_left - 1];
+    const short *subkeeps;
+    int count = reroll_subkeeps(key, &subkeeps);
+    int best = subkeeps[0];
+
+    for (int i = 1; i < count; ++i) {
+        if (keeps[subkeeps[i]] > keeps[best]) {
+            best = subkeeps[i];
+        }
+    }
+
+    return best;
+
+}//end solver_best_keep
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_item_value
+// Inputs
+//     used, upper
+//         The scorecard state.
+//     key
+//         The final roll of the turn.
+//     item
+//         An unused item.
+// Outputs
+//     function result
+// Description
+//     Returns the expected rest-of-game score of scoring the roll in
+//     the item: its score, the bonus if it earns it, and the value of
+//     the state it leads to.
+// ---------------------------------------------------------------------
+double solver_item_value(const unsigned int used, const int upper,
+                         const int key, const int item)
+{
+    int capped = (upper < SOLVER_UPPERS) ? upper : SOLVER_UPPERS - 1;
+
+    return score_item(used, capped, key, item);
+
+}//end solver_item_value
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_best_item
+// Inputs
+//     used, upper
+//         The scorecard state, which must not be full.
+//     key
+//         The final roll of the turn.
+// Outputs
+//     function result
+// Description
+//     Returns the unused item that gives the highest expected final
+//     score for the roll.
+// ---------------------------------------------------------------------
+int solver_best_item(const unsigned int used, const int upper,
+                     const int key)
+{
+    int capped = (upper < SOLVER_UPPERS) ? upper : SOLVER_UPPERS - 1;
+    int best = NO_ITEM;
+    float best_value = 0;
+
+    for (int item = ACES; item <= CHANCE; ++item) {
+        if (!(used & SOLVER_ITEM_BIT(item))) {
+            float value = score_item(used, capped, key, item);
+
+            if ((best == NO_ITEM) || (value > best_value)) {
+                best = item;
+                best_value = value;
+            }
+        }
+    }
+
+    return best;
+
+}//end solver_best_item
+
+// end solver.c
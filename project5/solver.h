@@ -0,0 +1,55 @@
+// -------------------------------------------------------------------
+// File: solver.h
+//
+// Name: Jonathan Goohs
+//
+// Description: This is the header file for the SOLVER module of the
+//     YAHTZEE game. It holds the expected final score of optimal play
+//     from every scorecard state, and uses it to pick the best keep
+//     and the best item for a roll.
+//
+//     A scorecard state is the set of items used so far (bit item-1
+//     of "used") and the upper section subtotal, capped at the bonus
+//     threshold since nothing above it matters.
+// -------------------------------------------------------------------
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <stdbool.h>
+#include "reroll.h"
+#include "score.h"
+#include "scoretab.h"
+
+#define SOLVER_ITEMS      13
+#define SOLVER_MASKS      8192                  // 2^13 sets of used items
+#define SOLVER_UPPERS     (LEFT_BONUS_SUBTOTAL + 1)
+#define SOLVER_REROLLS    2
+#define SOLVER_FILE       "yahtzee.ev"
+#define SOLVER_ITEM_BIT(item)  (1u << ((item) - 1))
+
+// The values of one turn from a scorecard state, playing optimally
+struct solver_turn_t {
+    // roll_value[n][key]: expected rest-of-game score holding the roll
+    // with n rerolls left
+    float roll_value[SOLVER_REROLLS + 1][SCORETAB_KEYS];
+
+    // keep_value[n][keep]: expected rest-of-game score of keeping the
+    // dice and rolling the others, which leaves n rerolls
+    float keep_value[SOLVER_REROLLS][REROLL_KEEPS];
+};
+
+extern int    solver_build(const char *path, const int threads);
+extern int    solver_load(const char *path);
+extern void   solver_unload(void);
+extern bool   solver_loaded(void);
+extern double solver_value(const unsigned int used, const int upper);
+extern double solver_turn(const unsigned int used, const int upper,
+                          struct solver_turn_t *turn);
+extern int    solver_best_keep(const struct solver_turn_t *turn,
+                               const int key, const int rerolls_left);
+extern double solver_item_value(const unsigned int used, const int upper,
+                                const int key, const int item);
+extern int    solver_best_item(const unsigned int used, const int upper,
+                               const int key);
+
+#endif
@@ -1,33 +1,212 @@
 // ---------------------------------------------------------------------
 // File: display.c
 //
-// Name: Al Shaffer & Paul Clark
+// Name: Al Shaffer & Paul Clark & Jonathan Goohs
 //
 // Description:
 //     This module displays the given hours and minutes of the day in
-//     hh:mm format in large "text".
+//     hh:mm format in large "text", optionally followed by the seconds
+//     (hh:mm:ss) and the tenths of a second. It remembers which large
+//     character is in each position of the clock so that only the
+//     characters that change are redrawn.
 // ---------------------------------------------------------------------
 
 #include <stdio.h>
 #include <stdbool.h>
 #include "display.h"
+#include "frame.h"
 
 #define MOVE_CURSOR   "\x1b[%d;%dH"
 #define BASE_10       10
 
-#define HOUR2_OFFSET  (DIGIT_WIDTH + DIGIT_SPACING)
-#define COLON_OFFSET  (2 * (DIGIT_WIDTH + DIGIT_SPACING))
-#define MIN1_OFFSET   (3 * (DIGIT_WIDTH + DIGIT_SPACING))
-#define MIN2_OFFSET   (4 * (DIGIT_WIDTH + DIGIT_SPACING))
+#define HOUR1_SLOT    0
+#define HOUR2_SLOT    1
+#define COLON_SLOT    2
+#define MIN1_SLOT     3
+#define MIN2_SLOT     4
+#define COLON2_SLOT   5
+#define SEC1_SLOT     6
+#define SEC2_SLOT     7
+#define TENTHS_SLOT   8     // small text, not a large glyph
+#define MAX_SLOTS     9
+
+#define HHMM_SLOTS    5
+#define HHMMSS_SLOTS  8
+#define TENTHS_WIDTH  2     // ".t" in normal sized text
 
 #define HOURS_PER_DAY    24
 #define MINUTES_PER_HOUR 60
+#define SECONDS_PER_MIN  60
 #define COLON            ':'
 
+// Indexes into the glyph table that are not digits
+#define GLYPH_COLON      10
+#define GLYPH_BLANK      11
+#define GLYPH_SEP_COLON  12    // narrow colon between seconds fields
+#define GLYPH_SEP_BLANK  13    // narrow blank between seconds fields
+#define GLYPH_COUNT      14
+#define NO_GLYPH         -1
+#define MAX_LINE        512    // longest scaled glyph row we can build
+
+// ---------------------------------------------------------------------
+// The large "text" for each digit, the colon and the blank space. Each
+// glyph is DIGIT_HEIGHT rows of DIGIT_WIDTH characters, except the
+// narrow separators used when the seconds are shown, which are
+// SEP_WIDTH characters wide so that "HH:MM:SS" fits in 80 columns.
+// ---------------------------------------------------------------------
+static const char *Glyphs[GLYPH_COUNT][DIGIT_HEIGHT] = {
+    { " XXXXXXX ", "XXXXXXXXX", "XXX   XXX", "XXX   XXX", "XXX   XXX",
+      "XXX   XXX", "XXX   XXX", "XXX   XXX", "XXXXXXXXX", " XXXXXXX " },
+    { "   XXX   ", "  XXXX   ", "   XXX   ", "   XXX   ", "   XXX   ",
+      "   XXX   ", "   XXX   ", "   XXX   ", " XXXXXXX ", "XXXXXXXXX" },
+    { " XXXXXX  ", "XXXXXXXX ", " XX  XXX ", "    XXX  ", "   XXX   ",
+      "  XXX    ", " XXX     ", "XXX      ", "XXXXXXXXX", "XXXXXXXXX" },
+    { " XXXXXXX ", "XXXXXXXXX", "      XXX", "      XXX", "  XXXXXXX",
+      "  XXXXXXX", "      XXX", "      XXX", "XXXXXXXXX", " XXXXXXX " },
+    { "XXX      ", "XXX      ", "XXX  XXX ", "XXX  XXX ", "XXXXXXXXX",
+      "XXXXXXXXX", "     XXX ", "     XXX ", "     XXX ", "     XXX " },
+    { "XXXXXXXXX", "XXXXXXXXX", "XXX      ", "XXX      ", "XXXXXXXX ",
+      "XXXXXXXXX", "      XXX", "      XXX", "XXXXXXXXX", "XXXXXXXX " },
+    { " XXXXXXX ", "XXXXXXXXX", "XXX      ", "XXX      ", "XXXXXXX  ",
+      "XXXXXXXX ", "XXX   XXX", "XXX   XXX", "XXXXXXXXX", " XXXXXXX " },
+    { "XXXXXXXXX", "XXXXXXXXX", "      XXX", "     XXX ", "    XXX  ",
+      "   XXX   ", "  XXX    ", " XXX     ", "XXX      ", "XXX      " },
+    { " XXXXXXX ", "XXXXXXXXX", "XXX   XXX", "XXX   XXX", " XXXXXXX ",
+      " XXXXXXX ", "XXX   XXX", "XXX   XXX", "XXXXXXXXX", " XXXXXXX " },
+    { " XXXXXXX ", "XXXXXXXXX", "XXX   XXX", "XXX   XXX", " XXXXXXXX",
+      "  XXXXXXX", "     XXX ", "    XXX  ", "   XXX   ", "  XXX    " },
+    // colon for non-mil time
+    { "         ", "         ", "   XXX   ", "   XXX   ", "         ",
+      "         ", "   XXX   ", "   XXX   ", "         ", "         " },
+    // default blank space
+    { "         ", "         ", "         ", "         ", "         ",
+      "         ", "         ", "         ", "         ", "         " },
+    // narrow colon
+    { "   ", "   ", "XXX", "XXX", "   ", "   ", "XXX", "XXX", "   ", "   " },
+    // narrow blank
+    { "   ", "   ", "   ", "   ", "   ", "   ", "   ", "   ", "   ", "   " }
+};
+
+// ---------------------------------------------------------------------
+// Global variables
+// ---------------------------------------------------------------------
+static unsigned int Scale   = 1;          // glyph scale factor
+static unsigned int Max_col = MAX_LINE;   // right-most drawable column
+static unsigned int Mode    = MODE_HHMM;  // which fields are shown
+static unsigned int Slots   = HHMM_SLOTS; // # large glyphs in Mode
+
+// The column of each slot, relative to the left edge of the clock
+static unsigned int Slot_col[MAX_SLOTS];
+
+// The shadow of the screen: the glyph last drawn in each clock slot
+// (the tenths digit for TENTHS_SLOT), or NO_GLYPH when the screen
+// contents are unknown.
+static int Shadow[MAX_SLOTS] = { NO_GLYPH, NO_GLYPH, NO_GLYPH,
+                                 NO_GLYPH, NO_GLYPH, NO_GLYPH,
+                                 NO_GLYPH, NO_GLYPH, NO_GLYPH };
+
+
+// ---------------------------------------------------------------------
+// Name:
+//     glyph_of
+// Inputs:
+//     num
+//         The numerical value to display. This is expected to be a
+//         number between 0 and 9 (inclusive) or the ":" seperator.
+// Outputs:
+//     function result
+//         The index of the glyph for num in the glyph table.
+// Description:
+//     Maps the value to display onto its glyph. Any illegal value is
+//     shown as a blank space.
+// ---------------------------------------------------------------------
+static int glyph_of(const unsigned int num)
+{
+    int glyph = GLYPH_BLANK;
+
+    if (num < BASE_10) {
+        glyph = num;
+    } else if (num == COLON) {
+        glyph = GLYPH_COLON;
+    }
+
+    return glyph;
+
+}//end glyph_of
+
+
+// ---------------------------------------------------------------------
+// Name:
+//     is_separator
+// Inputs:
+//     slot
+//         A clock slot.
+// Outputs:
+//     function result
+//         true if the slot holds the colon between two fields.
+// ---------------------------------------------------------------------
+static bool is_separator(const int slot)
+{
+    return (slot == COLON_SLOT) || (slot == COLON2_SLOT);
+
+}//end is_separator
+
+
+// ---------------------------------------------------------------------
+// Name:
+//     slot_width
+// Inputs:
+//     slot
+//         A clock slot.
+// Outputs:
+//     function result
+//         The unscaled width of the glyphs drawn in the slot. The
+//         separators are narrow whenever the seconds are shown.
+// ---------------------------------------------------------------------
+static unsigned int slot_width(const int slot)
+{
+    unsigned int width = DIGIT_WIDTH;
+
+    if (is_separator(slot) && (Mode != MODE_HHMM)) {
+        width = SEP_WIDTH;
+    }
+
+    return width;
+
+}//end slot_width
+
+
+// ---------------------------------------------------------------------
+// Name:
+//     place_slots
+// Description:
+//     Computes the column of every slot for the current mode and
+//     scale, and forgets what is on the screen.
+// ---------------------------------------------------------------------
+static void place_slots(void)
+{
+    unsigned int offset = 0;
+
+    Slots = (Mode == MODE_HHMM) ? HHMM_SLOTS : HHMMSS_SLOTS;
+    for (int slot = 0; slot < Slots; ++slot) {
+        Slot_col[slot] = offset;
+        offset += (slot_width(slot) + DIGIT_SPACING) * Scale;
+    }
+    // the tenths sit right after the last large digit
+    Slot_col[TENTHS_SLOT] = offset;
+
+    display_invalidate();
+
+}//end place_slots
+
+
 // ---------------------------------------------------------------------
 // Name:
 //     display_num
 // Inputs:
+//     slot
+//         Which character of the clock is being drawn (0 is the
+//         left-most); this is used to skip unchanged characters.
 //     row
 //         The terminal row from which to start the display of the
 //         given number in large "text". This is the upper-most row
@@ -44,168 +223,154 @@
 // Description:
 //     This function displays a digit (or colon) using large "text"
 //     that is made up of individual ASCII values. Each larger digit
-//     is DIGIT_WIDTH characters high and DIGIT_HEIGHT tall. The input
-//     (x,y) represents the upper-left-most corner of the larger text.
-//     If an an illegal value in passed in the input num, then the
-//     larger text will be a full block of characters to represent an
-//     illegal value.
+//     is slot_width() characters wide and DIGIT_HEIGHT tall, and every
+//     character is repeated Scale times in both directions. The input
+//     (row,col) represents the upper-left-most corner of the larger
+//     text. Nothing is printed if the slot already shows this glyph.
 // ---------------------------------------------------------------------
-static void display_num(const int row, const int col, unsigned int num)
+static void display_num(const int slot, const int row, const int col,
+                        unsigned int num)
 {
-    unsigned int new_row = row;
-
-    switch (num) {    // cases for each of the clock display digits
-        case (0):
-            printf(MOVE_CURSOR " XXXXXXX ", new_row++, col);
-            printf(MOVE_CURSOR "XXXXXXXXX", new_row++, col);
-            printf(MOVE_CURSOR "XXX   XXX", new_row++, col);
-            printf(MOVE_CURSOR "XXX   XXX", new_row++, col);
-            printf(MOVE_CURSOR "XXX   XXX", new_row++, col);
-            printf(MOVE_CURSOR "XXX   XXX", new_row++, col);
-            printf(MOVE_CURSOR "XXX   XXX", new_row++, col);
-            printf(MOVE_CURSOR "XXX   XXX", new_row++, col);
-            printf(MOVE_CURSOR "XXXXXXXXX", new_row++, col);
-            printf(MOVE_CURSOR " XXXXXXX ", new_row  , col);
-            break;
-        case (1):
-            printf(MOVE_CURSOR "   XXX   ", new_row++, col);
-            printf(MOVE_CURSOR "  XXXX   ", new_row++, col);
-            printf(MOVE_CURSOR "   XXX   ", new_row++, col);
-            printf(MOVE_CURSOR "   XXX   ", new_row++, col);
-            printf(MOVE_CURSOR "   XXX   ", new_row++, col);
-            printf(MOVE_CURSOR "   XXX   ", new_row++, col);
-            printf(MOVE_CURSOR "   XXX   ", new_row++, col);
-            printf(MOVE_CURSOR "   XXX   ", new_row++, col);
-            printf(MOVE_CURSOR " XXXXXXX ", new_row++, col);
-            printf(MOVE_CURSOR "XXXXXXXXX", new_row  , col);
-            break;
-        case (2):
-            printf(MOVE_CURSOR " XXXXXX  ", new_row++, col);
-            printf(MOVE_CURSOR "XXXXXXXX ", new_row++, col);
-            printf(MOVE_CURSOR " XX  XXX ", new_row++, col);
-            printf(MOVE_CURSOR "    XXX  ", new_row++, col);
-            printf(MOVE_CURSOR "   XXX   ", new_row++, col);
-            printf(MOVE_CURSOR "  XXX    ", new_row++, col);
-            printf(MOVE_CURSOR " XXX     ", new_row++, col);
-            printf(MOVE_CURSOR "XXX      ", new_row++, col);
-            printf(MOVE_CURSOR "XXXXXXXXX", new_row++, col);
-            printf(MOVE_CURSOR "XXXXXXXXX", new_row,   col);
-            break;
-        case (3):
-            printf(MOVE_CURSOR " XXXXXXX ", new_row++, col);
-            printf(MOVE_CURSOR "XXXXXXXXX", new_row++, col);
-            printf(MOVE_CURSOR "      XXX", new_row++, col);
-            printf(MOVE_CURSOR "      XXX", new_row++, col);
-            printf(MOVE_CURSOR "  XXXXXXX", new_row++, col);
-            printf(MOVE_CURSOR "  XXXXXXX", new_row++, col);
-            printf(MOVE_CURSOR "      XXX", new_row++, col);
-            printf(MOVE_CURSOR "      XXX", new_row++, col);
-            printf(MOVE_CURSOR "XXXXXXXXX", new_row++, col);
-            printf(MOVE_CURSOR " XXXXXXX ", new_row,   col);
-            break;
-        case (4):
-            printf(MOVE_CURSOR "XXX      ", new_row++, col);
-            printf(MOVE_CURSOR "XXX      ", new_row++, col);
-            printf(MOVE_CURSOR "XXX  XXX ", new_row++, col);
-            printf(MOVE_CURSOR "XXX  XXX ", new_row++, col);
-            printf(MOVE_CURSOR "XXXXXXXXX", new_row++, col);
-            printf(MOVE_CURSOR "XXXXXXXXX", new_row++, col);
-            printf(MOVE_CURSOR "     XXX ", new_row++, col);
-            printf(MOVE_CURSOR "     XXX ", new_row++, col);
-            printf(MOVE_CURSOR "     XXX ", new_row++, col);
-            printf(MOVE_CURSOR "     XXX ", new_row,   col);
-            break;
-        case (5):
-            printf(MOVE_CURSOR "XXXXXXXXX", new_row++, col);
-            printf(MOVE_CURSOR "XXXXXXXXX", new_row++, col);
-            printf(MOVE_CURSOR "XXX      ", new_row++, col);
-            printf(MOVE_CURSOR "XXX      ", new_row++, col);
-            printf(MOVE_CURSOR "XXXXXXXX ", new_row++, col);
-            printf(MOVE_CURSOR "XXXXXXXXX", new_row++, col);
-            printf(MOVE_CURSOR "      XXX", new_row++, col);
-            printf(MOVE_CURSOR "      XXX", new_row++, col);
-            printf(MOVE_CURSOR "XXXXXXXXX", new_row++, col);
-            printf(MOVE_CURSOR "XXXXXXXX ", new_row,   col);
-            break;
-        case (6):
-            printf(MOVE_CURSOR " XXXXXXX ", new_row++, col);
-            printf(MOVE_CURSOR "XXXXXXXXX", new_row++, col);
-            printf(MOVE_CURSOR "XXX      ", new_row++, col);
-            printf(MOVE_CURSOR "XXX      ", new_row++, col);
-            printf(MOVE_CURSOR "XXXXXXX  ", new_row++, col);
-            printf(MOVE_CURSOR "XXXXXXXX ", new_row++, col);
-            printf(MOVE_CURSOR "XXX   XXX", new_row++, col);
-            printf(MOVE_CURSOR "XXX   XXX", new_row++, col);
-            printf(MOVE_CURSOR "XXXXXXXXX", new_row++, col);
-            printf(MOVE_CURSOR " XXXXXXX ", new_row,   col);
-            break;
-        case (7):
-            printf(MOVE_CURSOR "XXXXXXXXX", new_row++, col);
-            printf(MOVE_CURSOR "XXXXXXXXX", new_row++, col);
-            printf(MOVE_CURSOR "      XXX", new_row++, col);
-            printf(MOVE_CURSOR "     XXX ", new_row++, col);
-            printf(MOVE_CURSOR "    XXX  ", new_row++, col);
-            printf(MOVE_CURSOR "   XXX   ", new_row++, col);
-            printf(MOVE_CURSOR "  XXX    ", new_row++, col);
-            printf(MOVE_CURSOR " XXX     ", new_row++, col);
-            printf(MOVE_CURSOR "XXX      ", new_row++, col);
-            printf(MOVE_CURSOR "XXX      ", new_row,   col);
-            break;
-        case (8):
-            printf(MOVE_CURSOR " XXXXXXX ", new_row++, col);
-            printf(MOVE_CURSOR "XXXXXXXXX", new_row++, col);
-            printf(MOVE_CURSOR "XXX   XXX", new_row++, col);
-            printf(MOVE_CURSOR "XXX   XXX", new_row++, col);
-            printf(MOVE_CURSOR " XXXXXXX ", new_row++, col);
-            printf(MOVE_CURSOR " XXXXXXX ", new_row++, col);
-            printf(MOVE_CURSOR "XXX   XXX", new_row++, col);
-            printf(MOVE_CURSOR "XXX   XXX", new_row++, col);
-            printf(MOVE_CURSOR "XXXXXXXXX", new_row++, col);
-            printf(MOVE_CURSOR " XXXXXXX ", new_row,   col);
-            break;
-        case (9):
-            printf(MOVE_CURSOR " XXXXXXX ", new_row++, col);
-            printf(MOVE_CURSOR "XXXXXXXXX", new_row++, col);
-            printf(MOVE_CURSOR "XXX   XXX", new_row++, col);
-            printf(MOVE_CURSOR "XXX   XXX", new_row++, col);
-            printf(MOVE_CURSOR " XXXXXXXX", new_row++, col);
-            printf(MOVE_CURSOR "  XXXXXXX", new_row++, col);
-            printf(MOVE_CURSOR "     XXX ", new_row++, col);
-            printf(MOVE_CURSOR "    XXX  ", new_row++, col);
-            printf(MOVE_CURSOR "   XXX   ", new_row++, col);
-            printf(MOVE_CURSOR "  XXX    ", new_row,   col);
-            break;
-        case (COLON):    // colon for non-mil time
-            printf(MOVE_CURSOR "         ", new_row++, col);
-            printf(MOVE_CURSOR "         ", new_row++, col);
-            printf(MOVE_CURSOR "   XXX   ", new_row++, col);
-            printf(MOVE_CURSOR "   XXX   ", new_row++, col);
-            printf(MOVE_CURSOR "         ", new_row++, col);
-            printf(MOVE_CURSOR "         ", new_row++, col);
-            printf(MOVE_CURSOR "   XXX   ", new_row++, col);
-            printf(MOVE_CURSOR "   XXX   ", new_row++, col);
-            printf(MOVE_CURSOR "         ", new_row++, col);
-            printf(MOVE_CURSOR "         ", new_row,   col);
-            break;
-        default:    // default blank space
-            printf(MOVE_CURSOR "         ", new_row++, col);
-            printf(MOVE_CURSOR "         ", new_row++, col);
-            printf(MOVE_CURSOR "         ", new_row++, col);
-            printf(MOVE_CURSOR "         ", new_row++, col);
-            printf(MOVE_CURSOR "         ", new_row++, col);
-            printf(MOVE_CURSOR "         ", new_row++, col);
-            printf(MOVE_CURSOR "         ", new_row++, col);
-            printf(MOVE_CURSOR "         ", new_row++, col);
-            printf(MOVE_CURSOR "         ", new_row++, col);
-            printf(MOVE_CURSOR "         ", new_row,   col);
-            break;
+    char line[MAX_LINE + 1];
+    int  glyph = glyph_of(num);
+    int  width;
+
+    // the separators have their own narrow glyphs next to the seconds
+    if (is_separator(slot) && (Mode != MODE_HHMM)) {
+        glyph = (glyph == GLYPH_COLON) ? GLYPH_SEP_COLON : GLYPH_SEP_BLANK;
     }
 
-    fflush(stdout);
+    if (Shadow[slot] == glyph) {
+        return;    // already on the screen
+    }
+    Shadow[slot] = glyph;
+
+    // clip the glyph at the right edge of the terminal
+    if (col > Max_col) {
+        return;
+    }
+    width = slot_width(slot) * Scale;
+    if (col + width - 1 > Max_col) {
+        width = Max_col - col + 1;
+    }
+    if (width > MAX_LINE) {
+        width = MAX_LINE;
+    }
+
+    for (int r = 0; r < DIGIT_HEIGHT; ++r) {
+        // widen the glyph row once, then repeat it Scale times
+        for (int c = 0; c < width; ++c) {
+            line[c] = Glyphs[glyph][r][c / Scale];
+        }
+        line[width] = '\0';
+        for (int s = 0; s < Scale; ++s) {
+            frame_printf(MOVE_CURSOR "%s", row + (r * Scale) + s, col, line);
+        }
+    }
 
 }//end display_num
 
 
+// ---------------------------------------------------------------------
+// Name:
+//     display_set_scale
+// Description:
+//     See display.h
+// ---------------------------------------------------------------------
+void display_set_scale(const unsigned int scale, const unsigned int max_col)
+{
+    Scale   = (scale < 1) ? 1 : scale;
+    Max_col = max_col;
+    place_slots();
+
+}//end display_set_scale
+
+
+// ---------------------------------------------------------------------
+// Name:
+//     display_set_mode
+// Description:
+//     See display.h
+// ---------------------------------------------------------------------
+void display_set_mode(const unsigned int mode)
+{
+    Mode = (mode > MODE_TENTHS) ? MODE_HHMM : mode;
+    place_slots();
+
+}//end display_set_mode
+
+
+// ---------------------------------------------------------------------
+// Name:
+//     display_width
+// Description:
+//     See display.h
+// ---------------------------------------------------------------------
+unsigned int display_width(const unsigned int scale)
+{
+    unsigned int width = 0;
+    unsigned int slots = (Mode == MODE_HHMM) ? HHMM_SLOTS : HHMMSS_SLOTS;
+
+    for (int slot = 0; slot < slots; ++slot) {
+        width += (slot_width(slot) + DIGIT_SPACING) * scale;
+    }
+    if (Mode == MODE_TENTHS) {
+        width += TENTHS_WIDTH;
+    } else {
+        width -= DIGIT_SPACING * scale;  // no spacing after the last one
+    }
+
+    return width;
+
+}//end display_width
+
+
+// ---------------------------------------------------------------------
+// Name:
+//     display_invalidate
+// Description:
+//     See display.h
+// ---------------------------------------------------------------------
+void display_invalidate(void)
+{
+    for (int slot = 0; slot < MAX_SLOTS; ++slot) {
+        Shadow[slot] = NO_GLYPH;
+    }
+
+}//end display_invalidate
+
+
+// ---------------------------------------------------------------------
+// Name:
+//     display_tenths
+// Inputs:
+//     row, col
+//         The upper-left corner of the large clock.
+//     tenths
+//         The tenths of a second, 0 thru 9.
+// Description:
+//     Shows ".t" in normal sized text next to the bottom of the last
+//     large digit, when it changed since the last call.
+// ---------------------------------------------------------------------
+static void display_tenths(const unsigned int row,
+                           const unsigned int col,
+                           const unsigned int tenths)
+{
+    unsigned int tenths_col = col + Slot_col[TENTHS_SLOT];
+
+    if (Shadow[TENTHS_SLOT] == tenths) {
+        return;    // already on the screen
+    }
+    Shadow[TENTHS_SLOT] = tenths;
+
+    if (tenths_col + TENTHS_WIDTH - 1 <= Max_col) {
+        frame_printf(MOVE_CURSOR ".%u", row + DIGIT_HEIGHT * Scale - 1,
+               tenths_col, tenths % BASE_10);
+    }
+
+}//end display_tenths
+
+
 // ---------------------------------------------------------------------
 // Name:
 //     display_time
@@ -222,68 +387,77 @@ static void display_num(const int row, const int col, unsigned int num)
 //         The current hour in 24-hour or 12-hour format.
 //     mins
 //         The current minute within the current hour.
+//     secs
+//         The current second within the current minute.
+//     tenths
+//         The current tenth of a second.
 // Outputs:
 //     N/A
 // Description:
 //     This is an external function to be used to display the input
-//     hours and mins in HH:MM format on the screen in a large format.
+//     time in HH:MM, HH:MM:SS or HH:MM:SS.t format (depending on the
+//     mode) on the screen in a large format.
 // ---------------------------------------------------------------------
 void display_time(const unsigned int row,
                   const unsigned int col,
                   const unsigned int hours,
-                  const unsigned int mins)
+                  const unsigned int mins,
+                  const unsigned int secs,
+                  const unsigned int tenths)
 {
     extern bool Miltime;
+    unsigned int num[MAX_SLOTS];
 
-    // Display the first digit of the hour
+    // The first digit of the hour
     if (hours < HOURS_PER_DAY) {
         if (Miltime) {
             // Show leading zero, when applicable
-            display_num(row, col,
-                       (hours < BASE_10) ? 0 : (hours / BASE_10));
+            num[HOUR1_SLOT] = (hours < BASE_10) ? 0 : (hours / BASE_10);
         } else {
             // Show no leading zero, i.e., default blank, when applicable
-            display_num(row, col,
-                       (hours < BASE_10) ? BASE_10 : (hours / BASE_10));
+            num[HOUR1_SLOT] = (hours < BASE_10) ? BASE_10 : (hours / BASE_10);
         }
     } else {
         // bad hour
-        display_num(row, col, hours);
+        num[HOUR1_SLOT] = hours;
     }
 
-    // Display the second digit of the hour
+    // The second digit of the hour
     if (hours < HOURS_PER_DAY) {
-        display_num(row,
-                   (col + HOUR2_OFFSET),
-                   (hours < BASE_10) ? hours : (hours % BASE_10));
+        num[HOUR2_SLOT] = (hours < BASE_10) ? hours : (hours % BASE_10);
     } else {
         // bad hour
-        display_num(row, (col + HOUR2_OFFSET), hours);
+        num[HOUR2_SLOT] = hours;
     }
 
-    // Display the colon separating hour and minute
-    if (Miltime) {
-        // Show no colon
-        display_num(row, (col + COLON_OFFSET), BASE_10);
-    } else {
-        // Show the colon
-        display_num(row, (col + COLON_OFFSET), COLON);
-    }
+    // The colons separating the fields; mil time shows no colon
+    num[COLON_SLOT]  = Miltime ? BASE_10 : COLON;
+    num[COLON2_SLOT] = num[COLON_SLOT];
 
-    // Display the first digit of the minutes
+    // The digits of the minutes
     if (mins < MINUTES_PER_HOUR) {
-        display_num(row, (col + MIN1_OFFSET), (mins / BASE_10));
+        num[MIN1_SLOT] = mins / BASE_10;
+        num[MIN2_SLOT] = mins % BASE_10;
     } else {
         // bad minute
-        display_num(row, (col + MIN1_OFFSET), mins);
+        num[MIN1_SLOT] = num[MIN2_SLOT] = mins;
     }
 
-    // Display the second digit of the minutes
-    if (mins < MINUTES_PER_HOUR) {
-        display_num(row, (col + MIN2_OFFSET), (mins % BASE_10));
+    // The digits of the seconds
+    if (secs < SECONDS_PER_MIN) {
+        num[SEC1_SLOT] = secs / BASE_10;
+        num[SEC2_SLOT] = secs % BASE_10;
     } else {
-        // bad minute
-        display_num(row, (col + MIN2_OFFSET), mins);
+        // bad second
+        num[SEC1_SLOT] = num[SEC2_SLOT] = secs;
+    }
+
+    // Draw the slots that changed
+    for (int slot = 0; slot < Slots; ++slot) {
+        display_num(slot, row, col + Slot_col[slot], num[slot]);
+    }
+    if (Mode == MODE_TENTHS) {
+        display_tenths(row, col, tenths);
     }
 
 }//end display_time
@@ -1,7 +1,7 @@
 // ------------------------------------------------------------------
 // File: display.h
 //
-// Name: Al Shaffer & Paul Clark
+// Name: Al Shaffer & Paul Clark & Jonathan Goohs
 //
 // Description:
 //     This is the header file for the DISPLAY module, which is used
@@ -14,6 +14,12 @@
 #define DIGIT_WIDTH    9    // # characters that make up the width
 #define DIGIT_HEIGHT  10    // # characters that make up the height
 #define DIGIT_SPACING  2    // # spaces between displayed digits
+#define SEP_WIDTH      3    // # characters in a narrow colon
+
+// Which fields of the time are displayed
+#define MODE_HHMM      0    // HH:MM
+#define MODE_HHMMSS    1    // HH:MM:SS
+#define MODE_TENTHS    2    // HH:MM:SS.t
 
 // ------------------------------------------------------------------
 // Function:
@@ -23,16 +29,74 @@
 //     col   The terminal col to start the clock display
 //     hours The hour to display in the clock ("HH")
 //     mins  The minutes to display in the clock ("MM")
+//     secs  The seconds to display in the clock ("SS")
+//     tenths The tenths of a second to display (".t")
 // Description:
-//     This function displays the input time in a "HH:MM" format at
+//     This function displays the input time in a "HH:MM" format (or
+//     "HH:MM:SS" / "HH:MM:SS.t", see display_set_mode()) at
 //     the position (row,col) of the terminal with large "numbers"
-//     that are each DIGIT_WIDTH wide and DIGIT_HEIGHT tall.
+//     that are each DIGIT_WIDTH wide and DIGIT_HEIGHT tall, times
+//     the scale set by display_set_scale(). Only the characters that
+//     differ from what is already on the screen are drawn. The
+//     caller is responsible for flushing stdout.
 // ------------------------------------------------------------------
 extern void display_time(
     const unsigned int row,      // The terminal row to start the clock
     const unsigned int col,      // The terminal col to start the clock
     const unsigned int hours,    // The hours to display "HH"
-    const unsigned int mins);    // The minutes to display "MM"
+    const unsigned int mins,     // The minutes to display "MM"
+    const unsigned int secs,     // The seconds to display "SS"
+    const unsigned int tenths);  // The tenths of a second ".t"
+
+// ------------------------------------------------------------------
+// Function:
+//     display_set_scale
+// Inputs:
+//     scale    The glyph scale factor, 1 or more
+//     max_col  The right-most terminal column that may be drawn
+// Description:
+//     Changes the size of the large characters. Each glyph cell is
+//     drawn as a scale x scale block, and anything past max_col is
+//     clipped so a narrow terminal does not wrap. This invalidates
+//     the shadow of what is on the screen.
+// ------------------------------------------------------------------
+extern void display_set_scale(const unsigned int scale,
+                              const unsigned int max_col);
+
+// ------------------------------------------------------------------
+// Function:
+//     display_invalidate
+// Description:
+//     Forgets what the module believes is on the screen, so the next
+//     call to display_time() redraws every character. Call this after
+//     the screen was cleared or the text color changed.
+// ------------------------------------------------------------------
+extern void display_invalidate(void);
+
+// ------------------------------------------------------------------
+// Function:
+//     display_set_mode
+// Inputs:
+//     mode  MODE_HHMM, MODE_HHMMSS or MODE_TENTHS
+// Description:
+//     Chooses which fields of the time are displayed. When the
+//     seconds are shown the colons are drawn narrow so the clock
+//     still fits an 80 column terminal; the tenths are shown in
+//     normal sized text. This invalidates the shadow of the screen.
+// ------------------------------------------------------------------
+extern void display_set_mode(const unsigned int mode);
+
+// ------------------------------------------------------------------
+// Function:
+//     display_width
+// Inputs:
+//     scale  A glyph scale factor
+// Outputs:
+//     function result
+//         The number of terminal columns the clock uses in the
+//         current mode at the given scale.
+// ------------------------------------------------------------------
+extern unsigned int display_width(const unsigned int scale);
 
 #endif
 
@@ -0,0 +1,101 @@
+// ---------------------------------------------------------------------
+// File: frame.c
+//
+// Name: Jonathan Goohs
+//
+// Description:
+//     This module buffers the output of one frame of the clock and
+//     sends it to the terminal with a single write(2). Escape
+//     sequences for a whole frame therefore never interleave with
+//     another thread's output, and the recorder sees exactly the
+//     bytes the terminal received.
+//
+// Resources:
+// 1. vsnprintf and write man pages
+// ---------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <unistd.h>
+#include "frame.h"
+#include "record.h"
+
+#define FRAME_SIZE   65536    // larger than a full redraw at scale 4
+
+// ---------------------------------------------------------------------
+// Global variables
+// ---------------------------------------------------------------------
+static char   Frame[FRAME_SIZE];
+static size_t Frame_len = 0;
+
+
+// ---------------------------------------------------------------------
+// Name:
+//     frame_printf
+// Description:
+//     See frame.h. If the frame is full it is flushed early rather
+//     than dropping output.
+// ---------------------------------------------------------------------
+void frame_printf(const char *format, ...)
+{
+    va_list args;
+    int     len;
+
+    va_start(args, format);
+    len = vsnprintf(Frame + Frame_len, FRAME_SIZE - Frame_len, format, args);
+    va_end(args);
+
+    if (len < 0) {
+        return;
+    }
+    if (Frame_len + len >= FRAME_SIZE) {
+        // did not fit; send what we have and format again
+        frame_flush();
+        va_start(args, format);
+        len = vsnprintf(Frame, FRAME_SIZE, format, args);
+        va_end(args);
+        if (len >= FRAME_SIZE) {
+            len = FRAME_SIZE - 1;
+        }
+    }
+    Frame_len += len;
+
+}//end frame_printf
+
+
+// ---------------------------------------------------------------------
+// Name:
+//     frame_flush
+// Description:
+//     See frame.h
+// ---------------------------------------------------------------------
+size_t frame_flush(void)
+{
+    size_t  sent = Frame_len;
+    size_t  done = 0;
+    ssize_t rval;
+
+    if (Frame_len == 0) {
+        return 0;
+    }
+
+    record_frame(Frame, Frame_len);
+
+    while (done < Frame_len) {
+        rval = write(STDOUT_FILENO, Frame + done, Frame_len - done);
+        if (rval < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;    // nothing sensible to do; drop the frame
+        }
+        done += rval;
+    }
+    Frame_len = 0;
+
+    return sent;
+
+}//end frame_flush
+
+//end frame.c
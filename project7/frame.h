@@ -0,0 +1,46 @@
+// ------------------------------------------------------------------
+// File: frame.h
+//
+// Name: Jonathan Goohs
+//
+// Description:
+//     This is the header file for the FRAME module, which collects
+//     everything the clock draws between two flushes into one buffer,
+//     so that each frame reaches the terminal in a single write and
+//     can be handed to the recorder.
+// ------------------------------------------------------------------
+
+#ifndef _FRAME_H_
+#define _FRAME_H_
+
+#include <stddef.h>
+
+// ------------------------------------------------------------------
+// Function:
+//     frame_printf
+// Inputs:
+//     format, ...  Same as printf
+// Description:
+//     Appends formatted text to the current frame. Nothing is sent
+//     to the terminal until frame_flush() is called. The caller must
+//     hold the screen lock.
+// ------------------------------------------------------------------
+extern void frame_printf(const char *format, ...)
+    __attribute__((format(printf, 1, 2)));
+
+// ------------------------------------------------------------------
+// Function:
+//     frame_flush
+// Outputs:
+//     function result
+//         The number of bytes in the frame that was sent.
+// Description:
+//     Writes the current frame to stdout with one write, passes it
+//     to the recorder (when recording) and starts an empty frame.
+//     An empty frame is neither written nor recorded.
+// ------------------------------------------------------------------
+extern size_t frame_flush(void);
+
+#endif
+
+//end frame.h
@@ -0,0 +1,161 @@
+// ---------------------------------------------------------------------
+// File: layout.c
+//
+// Name: Jonathan Goohs
+//
+// Description:
+//     This module computes where the clock, the CPU statistics and the
+//     user prompt go on the terminal. The terminal size is only read
+//     with ioctl(TIOCGWINSZ) after a SIGWINCH (and once at start-up);
+//     the positions and the glyph scale are cached in between, so the
+//     clock ticks never pay for a system call.
+//
+// Resources:
+// 1. ioctl_tty man page (TIOCGWINSZ)
+// 2. signal-safety man page
+// ---------------------------------------------------------------------
+
+#include <signal.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include "display.h"
+#include "layout.h"
+
+#define DEFAULT_ROWS        24     // used when stdout is not a terminal
+#define DEFAULT_COLS        80
+#define DISPLAY_START_ROW    2     // clock position when the terminal
+#define DISPLAY_START_COL    1     // is too small to center it
+#define MAX_SCALE            4
+#define STATS_GAP            2     // blank rows between clock and stats
+#define STATS_LINES          3
+#define PROMPT_GAP           2     // blank rows between stats and prompt
+#define PROMPT_LINES         3
+#define MAX_LINE_WIDTH      79
+#define IOCTL_GVAL           0
+
+// height of everything drawn, not counting the clock itself
+#define FIXED_ROWS  (STATS_GAP + STATS_LINES + PROMPT_GAP + PROMPT_LINES)
+
+// ---------------------------------------------------------------------
+// Global variables
+// ---------------------------------------------------------------------
+
+// Set by the SIGWINCH handler; starts set so the first tick lays out
+static volatile sig_atomic_t Resize_pending = 1;
+static struct layout_t Layout;
+
+
+// ---------------------------------------------------------------------
+// Name:
+//     pick_scale
+// Inputs:
+//     rows, cols
+//         The size of the terminal.
+// Outputs:
+//     function result
+//         The largest glyph scale whose clock and text fit on the
+//         terminal, never less than 1.
+// ---------------------------------------------------------------------
+static unsigned int pick_scale(const unsigned int rows,
+                               const unsigned int cols)
+{
+    unsigned int scale = 1;
+
+    while ((scale < MAX_SCALE) &&
+           (display_width(scale + 1) <= cols) &&
+           (DIGIT_HEIGHT * (scale + 1) + FIXED_ROWS + DISPLAY_START_ROW
+            <= rows)) {
+        ++scale;
+    }
+
+    return scale;
+
+}//end pick_scale
+
+
+// ---------------------------------------------------------------------
+// Name:
+//     layout_request
+// Description:
+//     See layout.h
+// ---------------------------------------------------------------------
+void layout_request(void)
+{
+    Resize_pending = 1;
+
+}//end layout_request
+
+
+// ---------------------------------------------------------------------
+// Name:
+//     layout_update
+// Description:
+//     See layout.h
+// ---------------------------------------------------------------------
+bool layout_update(void)
+{
+    struct winsize term;
+    unsigned int height;
+    unsigned int width;
+
+    if (!Resize_pending) {
+        return false;
+    }
+    Resize_pending = 0;
+
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &term) != IOCTL_GVAL ||
+        term.ws_row == 0 || term.ws_col == 0) {
+        term.ws_row = DEFAULT_ROWS;
+        term.ws_col = DEFAULT_COLS;
+    }
+    Layout.term_rows = term.ws_row;
+    Layout.term_cols = term.ws_col;
+
+    // Use the biggest clock that fits, then center the whole block
+    Layout.scale = pick_scale(Layout.term_rows, Layout.term_cols);
+    width  = display_width(Layout.scale);
+    height = DIGIT_HEIGHT * Layout.scale + FIXED_ROWS;
+
+    if (Layout.term_cols > width) {
+        Layout.clock_col = (Layout.term_cols - width) / 2 + 1;
+    } else {
+        Layout.clock_col = DISPLAY_START_COL;
+    }
+    if (Layout.term_rows > height + DISPLAY_START_ROW) {
+        Layout.clock_row = (Layout.term_rows - height) / 2 + 1;
+    } else {
+        Layout.clock_row = DISPLAY_START_ROW;
+    }
+
+    Layout.stats_row  = Layout.clock_row + DIGIT_HEIGHT * Layout.scale +
+                        STATS_GAP;
+    Layout.stats_col  = Layout.clock_col;
+    Layout.prompt_row = Layout.stats_row + STATS_LINES + PROMPT_GAP;
+    Layout.prompt_col = Layout.clock_col;
+
+    Layout.line_width = Layout.term_cols - Layout.stats_col + 1;
+    if (Layout.line_width > MAX_LINE_WIDTH) {
+        Layout.line_width = MAX_LINE_WIDTH;
+    }
+
+    display_set_scale(Layout.scale, Layout.term_cols);
+
+    return true;
+
+}//end layout_update
+
+
+// ---------------------------------------------------------------------
+// Name:
+//     layout_get
+// Description:
+//     See layout.h
+// ---------------------------------------------------------------------
+const struct layout_t *layout_get(void)
+{
+    return &Layout;
+
+}//end layout_get
+
+//end layout.c
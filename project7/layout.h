@@ -0,0 +1,74 @@
+// ------------------------------------------------------------------
+// File: layout.h
+//
+// Name: Jonathan Goohs
+//
+// Description:
+//     This is the header file for the LAYOUT module, which decides
+//     where the clock, the CPU statistics and the user prompt are
+//     drawn for the current size of the terminal.
+// ------------------------------------------------------------------
+
+#ifndef _LAYOUT_H_
+#define _LAYOUT_H_
+
+#include <stdbool.h>
+
+// The cached screen positions for the current terminal size
+struct layout_t {
+    unsigned int term_rows;     // terminal height in rows
+    unsigned int term_cols;     // terminal width in columns
+    unsigned int clock_row;     // upper-most row of the large clock
+    unsigned int clock_col;     // left-most column of the large clock
+    unsigned int scale;         // glyph scale factor (1 = normal size)
+    unsigned int stats_row;     // first row of the CPU statistics
+    unsigned int stats_col;     // column of the CPU statistics
+    unsigned int line_width;    // # columns a statistics line may use
+    unsigned int prompt_row;    // first row of the user prompt
+    unsigned int prompt_col;    // column of the user prompt
+};
+
+// ------------------------------------------------------------------
+// Function:
+//     layout_request
+// Inputs:
+//     none
+// Description:
+//     Marks the cached layout as stale. This only stores a flag, so
+//     it is safe to call from a signal handler (SIGWINCH).
+// ------------------------------------------------------------------
+extern void layout_request(void);
+
+// ------------------------------------------------------------------
+// Function:
+//     layout_update
+// Inputs:
+//     none
+// Outputs:
+//     function result
+//         true if the layout was recomputed, which means the caller
+//         must clear the screen and redraw everything.
+// Description:
+//     If a resize was requested since the last call, the terminal
+//     size is read with ioctl(TIOCGWINSZ) and all positions and the
+//     glyph scale are recomputed. Otherwise nothing is done, so this
+//     is cheap enough to call on every clock tick. The caller must
+//     hold the screen lock.
+// ------------------------------------------------------------------
+extern bool layout_update(void);
+
+// ------------------------------------------------------------------
+// Function:
+//     layout_get
+// Inputs:
+//     none
+// Outputs:
+//     function result
+//         The cached layout. The caller must hold the screen lock
+//         while reading it.
+// ------------------------------------------------------------------
+extern const struct layout_t *layout_get(void);
+
+#endif
+
+//end layout.h
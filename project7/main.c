@@ -7,11 +7,31 @@
 //     generates two additional threads: 1) one thread to display a
 //     large clock of the current time; 2) one thread to display CPU
 //     resources usage. The program also responds to signals during
-//     execution.
+//     execution. The layout follows the size of the terminal: a
+//     SIGWINCH makes the next clock tick re-read the terminal size,
+//     clear the screen and redraw everything once.
+//
+//     The clock ticks on deadlines anchored to CLOCK_MONOTONIC and
+//     aligned to the wall clock: once a minute for HH:MM, once a
+//     second for HH:MM:SS, and ten times a second when the tenths are
+//     shown. Signals and the exit request wake the clock thread early
+//     through a pipe. The CPU time of every frame is measured and
+//     shown; when the tenths are shown, a frame that goes over
+//     FRAME_BUDGET_US makes the clock skip its next frame, so the
+//     average cost stays within budget. A skipped frame only ever
+//     holds back a tenth: the frame that starts a new second, and
+//     every frame of HH:MM and HH:MM:SS, is always drawn.
+//
+//     Every frame is sent to the terminal with one write, and can be
+//     appended to a log (see record.h) that ./replay plays back.
 //
 // Syntax:
-//     ./clock
-//     The program ignores any inputs provided by the user.
+//     ./clock [-s | -t] [-r log | -R log]
+//     -s shows the seconds (HH:MM:SS), -t also shows the tenths of a
+//     second (HH:MM:SS.t). Without an option the clock shows HH:MM.
+//     -r records every frame to the log, delta encoded against the
+//     previous frame; -R records every frame whole.
+//     The program ignores any other inputs provided by the user.
 //
 // Resources
 // 1. tcsetattr man page
@@ -19,6 +39,8 @@
 // 3. getchar man page
 // 4. tzsetr man page
 // 5. stackoverflow.com/questions/50227212/how-to-get-epoch-day-and-time-in-c-for-even-different-time-zone
+// 6. ioctl_tty man page (SIGWINCH and TIOCGWINSZ)
+// 7. clock_gettime and poll man pages; the self-pipe trick
 // ------------------------------------------------------------------
 
 #include <stdio.h>
@@ -31,9 +53,14 @@
 #include <signal.h> //for siigaction
 #include <string.h>
 #include <unistd.h> //for posix os function - STDIN_FILENO
-#include <time.h> //for tzset() and time()
+#include <fcntl.h> //for the wake pipe flags
+#include <poll.h> //for waiting on the wake pipe until a deadline
+#include <time.h> //for tzset() and clock_gettime()
 #include <sys/resource.h> //for getrusage
 #include "display.h"
+#include "layout.h"
+#include "frame.h"
+#include "record.h"
 
 
 #define SECS_PER_DAY        86400
@@ -43,14 +70,19 @@
 #define HOURS_PER_DAY          24
 #define HOURS_PER_H_DAY        12
 
+#define NSEC_PER_SEC   1000000000L
+#define NSEC_PER_MSEC     1000000L
+#define NSEC_PER_USEC        1000L
+#define NSEC_PER_TENTH  100000000L
+#define TENTHS_PER_SEC  10
+#define FRAME_BUDGET_US       500 //CPU time one frame may use
+#define OPTIONS           "str:R:"
+
 #define MOVE_CURSOR "\x1b[%d;%dH"
 #define HIDE_CURSOR   "\x1b[?25l"
 #define SHOW_CURSOR   "\x1b[?25h"
 #define CLEAR_SCREEN    "\x1b[2J"
 
-#define DISPLAY_START_ROW      2
-#define DISPLAY_START_COL      1       
-
 
 #define RED            "\x1b[31m"
 #define GREEN          "\x1b[32m"
@@ -68,13 +100,8 @@
 #define COLOR_SWITCH_CASE      0
 #define MIL_CIV_SWITCH_CASE    0
 
-#define PROMPT_START_ROW      18
-#define PROMPT_START_COL       1
-
-#define STATS_START_ROW       14
-#define STATS_START_COL        1
 #define NOT_CR                 1
-#define CLEAR_LINE   "%-79s", ""
+#define CLEAR_LINE   "%-*s"
 
 #define SIGEMPTY_GVAL          0
 #define SIGACTION_GVAL         0
@@ -87,6 +114,8 @@
 #define TOTAL_COLORS           3
 #define TIME_GVAL              0
 #define RUSAGE_GVAL            0
+#define PIPE_GVAL              0
+#define POLL_TIMEOUT           0
 
 // ------------------------------------------------------------------
 // Global variables
@@ -97,6 +126,17 @@ bool Miltime  =                      true;
 // add any other needed globals
 int current_color =   COLOR_SWITCH_CASE;
 struct termios og_term;
+unsigned int Mode = MODE_HHMM; //which fields of the time are shown
+int Wake_pipe[2] = { -1, -1 }; //written to wake the time thread early
+
+//CPU cost of drawing the clock; protected by Screen_lock
+struct frame_stats_t {
+    long last_ns;                //CPU time of the latest frame
+    long max_ns;                 //most expensive frame so far
+    long total_ns;               //for the average
+    unsigned long frames;        //# frames drawn
+    unsigned long skipped;       //# frames dropped to stay in budget
+} Frame_stats;
 
 //set by tzset()
 extern long timezone;
@@ -110,11 +150,15 @@ void *mil_time(void * arg);
 void *clock_stats(void *arg);
 void signal_handler(int sig);
 void clean_display(void);
+void draw_prompt(void);
+int draw_stats(void);
+int get_options(int argc, char *argv[], unsigned int *mode);
+void wake_clock(void);
 
 // ********************************************************************
 // ****************************** M A I N *****************************
 // ********************************************************************
-int main(void)
+int main(int argc, char *argv[])
 {
     int result = EXIT_SUCCESS;
     struct sigaction sa;
@@ -134,6 +178,20 @@ int main(void)
     int statsattr_rval;
     int statsjoin_rval;
 
+    if (get_options(argc, argv, &Mode) != EXIT_SUCCESS) {
+        return result = EXIT_FAILURE;
+    }
+    display_set_mode(Mode);
+
+    //pipe the signal handler writes to, so a sleeping clock wakes up
+    errno = 0;
+    if (pipe(Wake_pipe) != PIPE_GVAL ||
+        fcntl(Wake_pipe[0], F_SETFL, O_NONBLOCK) != PIPE_GVAL ||
+        fcntl(Wake_pipe[1], F_SETFL, O_NONBLOCK) != PIPE_GVAL) {
+        perror("Error creating the wake up pipe");
+        return result = EXIT_FAILURE;
+    }
+
     // Prepare signal action settings
     sa.sa_handler = signal_handler; //set the hanlder function
     errno = 0;
@@ -160,6 +218,15 @@ int main(void)
                 strerror(errno));
         return result = EXIT_FAILURE;
     }
+
+    //Register handler for terminal resize signal
+    errno = 0;
+    siga_rval = sigaction(SIGWINCH, &sa, NULL);
+    if (siga_rval != SIGACTION_GVAL) {
+        fprintf(stderr, "Unable to pass window change signal to resize the clock: %s\n",
+                strerror(errno));
+        return result = EXIT_FAILURE;
+    }
     
     //call cleanup function through atexit()
     int atexit_rval = atexit(clean_display);
@@ -184,8 +251,8 @@ int main(void)
         return result = EXIT_FAILURE;
     }
 
-    printf(HIDE_CURSOR);
-    printf(CLEAR_SCREEN);
+    frame_printf(HIDE_CURSOR);
+    frame_printf(CLEAR_SCREEN);
 
     if (pthread_mutex_init(&Screen_lock, NULL) != PTHREAD_MUTEX_GVAL) {
         fprintf(stderr, "Error initializing mutex: %s\n", strerror(errno));
@@ -239,21 +306,8 @@ int main(void)
     pthread_attr_destroy(&timeattr);
     pthread_attr_destroy(&statsattr);
     
-    //lock the tterminal
-    pthread_mutex_lock(&Screen_lock);
-    //display user prompt for interrupts
-
-    int row = PROMPT_START_ROW;
-    int col = PROMPT_START_COL;
-    printf(MOVE_CURSOR, row, col);
-
-    printf("Press Ctrl-C to change clock color.\n");
-    printf("Press Ctrl-\\ to change clock time format.\n");
-    printf("Press CR to Exit.\n");
-
-    fflush(stdout);
-    //unlcok the terminal
-    pthread_mutex_unlock(&Screen_lock);
+    //the user prompt is drawn by the time thread on its first tick,
+    //as part of laying out the screen
     //wait for CR
     int c;
     while ((c = getchar()) != EOF) {
@@ -264,6 +318,7 @@ int main(void)
 
     //at this point the user has hit CR
     Finished = true;
+    wake_clock(); //the clock may be asleep until the next minute
 
     //wait for threadds to finish
     timejoin_rval = pthread_join(time_thread, NULL);
@@ -276,7 +331,7 @@ int main(void)
         fprintf(stderr, "Error: pthread_join failed with code %d\n", statsjoin_rval);
         return result = EXIT_FAILURE;
     }
-    printf("made it to end of main function.\n");
+    frame_printf("made it to end of main function.\n");
     pthread_mutex_destroy(&Screen_lock);
     return result = EXIT_SUCCESS;
 
@@ -296,27 +351,144 @@ void signal_handler(int sig){
             current_color = (current_color +1) % TOTAL_COLORS;
         } else if (sig == SIGQUIT) {
         Miltime = !Miltime;
+        } else if (sig == SIGWINCH) {
+            layout_request(); //only sets a flag; the time thread redraws
         }
+        wake_clock(); //show the change now, not at the next tick
     }
 
+//write() is async-signal-safe, so this may be called from the handler
+void wake_clock(void) {
+    int saved_errno = errno;
+    char c = 'w';
+    if (write(Wake_pipe[1], &c, sizeof(c)) < 0) {
+        ; //the pipe is full, so the clock is already being woken
+    }
+    errno = saved_errno;
+}
+
+//checks for the optional -s (seconds) or -t (tenths) argument, and
+//starts recording when -r or -R names a log
+int get_options(int argc, char *argv[], unsigned int *mode) {
+    int result = EXIT_SUCCESS;
+    int opt;
+    int record_rval;
+
+    *mode = MODE_HHMM;
+    while ((opt = getopt(argc, argv, OPTIONS)) != -1) {
+        switch (opt) {
+            case 's': *mode = MODE_HHMMSS;
+            break;
+            case 't': *mode = MODE_TENTHS;
+            break;
+            case 'r':
+            case 'R':
+            record_rval = record_open(optarg, opt == 'r');
+            if (record_rval != 0) {
+                fprintf(stderr, "Unable to record to %s: %s\n", optarg,
+                        strerror(record_rval));
+                result = EXIT_FAILURE;
+            }
+            break;
+            default: result = EXIT_FAILURE;
+            break;
+        }
+    }
+    if (optind != argc || result != EXIT_SUCCESS) {
+        fprintf(stderr, "Usage: %s [-s | -t] [-r log | -R log]\n", argv[0]);
+        result = EXIT_FAILURE;
+    }
+    return result;
+}
+
+//nanoseconds between two clock readings
+static long ns_between(const struct timespec *from, const struct timespec *to) {
+    return (to->tv_sec - from->tv_sec) * NSEC_PER_SEC +
+           (to->tv_nsec - from->tv_nsec);
+}
+
+//moves a timespec forward by ns nanoseconds
+static void add_ns(struct timespec *ts, long ns) {
+    ts->tv_sec  += ns / NSEC_PER_SEC;
+    ts->tv_nsec += ns % NSEC_PER_SEC;
+    if (ts->tv_nsec >= NSEC_PER_SEC) {
+        ts->tv_nsec -= NSEC_PER_SEC;
+        ts->tv_sec++;
+    }
+}
+
+//the first monotonic deadline on which the wall clock crosses a
+//multiple of period (every period divides an hour); later deadlines
+//are this anchor plus whole periods
+static void anchor_deadline(long period, struct timespec *deadline) {
+    struct timespec wall;
+    clock_gettime(CLOCK_REALTIME, &wall);
+    clock_gettime(CLOCK_MONOTONIC, deadline);
+    long into_period = ((wall.tv_sec % SECS_PER_HOUR) * NSEC_PER_SEC +
+                        wall.tv_nsec) % period;
+    add_ns(deadline, period - into_period);
+}
+
+//sleeps until the monotonic deadline, returning early (true) when
+//woken through the pipe by a signal or the exit request
+static bool wait_until(const struct timespec *deadline) {
+    struct pollfd pfd = { .fd = Wake_pipe[0], .events = POLLIN };
+    struct timespec now;
+    char drain[16];
+
+    while (!Finished) {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        long left = ns_between(&now, deadline);
+        if (left <= 0) {
+            return false;
+        }
+        //round up, so a timeout means the deadline has passed
+        int timeout = (left + NSEC_PER_MSEC - 1) / NSEC_PER_MSEC;
+        if (poll(&pfd, 1, timeout) > POLL_TIMEOUT) {
+            while (read(Wake_pipe[0], drain, sizeof(drain)) > 0) {
+                ; //empty the pipe
+            }
+            return true;
+        }
+    }
+    return true;
+}
+
 void *mil_time(void * arg) {
+    int drawn_color = -1; //color the clock was last drawn in
+    long period = NSEC_PER_SEC; //time between frames
+    struct timespec deadline;
+    struct timespec wall;
+    struct timespec cpu_start;
+    struct timespec cpu_end;
+
     tzset();
     //call tzset to initalize time zone information
+
+    if (Mode == MODE_HHMM) {
+        period = SECS_PER_MIN * NSEC_PER_SEC;
+    } else if (Mode == MODE_TENTHS) {
+        period = NSEC_PER_TENTH;
+    }
+    anchor_deadline(period, &deadline);
     
     while (!Finished) {   
         
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_start);
         errno = 0;
-        long epoch_secs = time(NULL);
-        if (errno != TIME_GVAL) {
+        if (clock_gettime(CLOCK_REALTIME, &wall) != TIME_GVAL) {
             perror("Error calling time function");
             pthread_exit(NULL);
         }
+        long epoch_secs = wall.tv_sec;
         
         long adjusted_time = epoch_secs - timezone;
         adjusted_time += (daylight * SECS_PER_HOUR); //always apply DST
 
         int hours = (adjusted_time % SECS_PER_DAY) / SECS_PER_HOUR;
         int min = (adjusted_time % SECS_PER_HOUR) / SECS_PER_MIN;
+        int sec = adjusted_time % SECS_PER_MIN;
+        int tenths = wall.tv_nsec / NSEC_PER_TENTH;
 
 
         //wrap around for 24 hours cycle from total amount of hours
@@ -337,22 +509,72 @@ void *mil_time(void * arg) {
         }
 
         pthread_mutex_lock(&Screen_lock);
-        switch(current_color) {
-            case RED_COLOR : printf(RED);
+        //after a resize, clear the garbage and redraw everything in one pass
+        if (layout_update()) {
+            frame_printf(DEFAULT_COLOR);
+            frame_printf(CLEAR_SCREEN);
+            draw_prompt();
+            if (draw_stats() != RUSAGE_GVAL) {
+                pthread_mutex_unlock(&Screen_lock);
+                pthread_exit(NULL);
+            }
+        }
+        //a new color means every digit on the screen is stale
+        if (drawn_color != current_color) {
+            drawn_color = current_color;
+            display_invalidate();
+        }
+        switch(drawn_color) {
+            case RED_COLOR : frame_printf(RED);
             break;
-            case GREEN_COLOR: printf(GREEN);
+            case GREEN_COLOR: frame_printf(GREEN);
             break;
             default:
-            printf(DEFAULT_COLOR);
+            frame_printf(DEFAULT_COLOR);
             break;
         }
-        display_time(DISPLAY_START_ROW, DISPLAY_START_COL, hour, min);
-
-        fflush(stdout);
+        //only the digits that changed are drawn
+        display_time(layout_get()->clock_row, layout_get()->clock_col,
+                     hour, min, sec, tenths);
+
+        frame_flush();
+
+        //account for the CPU this frame used
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_end);
+        long frame_ns = ns_between(&cpu_start, &cpu_end);
+        Frame_stats.last_ns = frame_ns;
+        Frame_stats.total_ns += frame_ns;
+        Frame_stats.frames++;
+        if (frame_ns > Frame_stats.max_ns) {
+            Frame_stats.max_ns = frame_ns;
+        }
+        //only a tenth may be skipped, never a tick that changes the
+        //seconds or minutes
+        bool skip_next = (Mode == MODE_TENTHS) &&
+                         (frame_ns > FRAME_BUDGET_US * NSEC_PER_USEC) &&
+                         (tenths + 1 < TENTHS_PER_SEC);
+        if (skip_next) {
+            Frame_stats.skipped++;
+        }
         pthread_mutex_unlock(&Screen_lock);
 
-        //loop with a sleep or wait for 0.5 seconds using usleep(500000) in macro HALFSECONDy
-        usleep(HALFSECOND);
+        //a signal redraws right away without moving the deadline
+        if (wait_until(&deadline)) {
+            continue;
+        }
+
+        //next deadline; an expensive frame gives up the next tenth
+        add_ns(&deadline, period);
+        if (skip_next) {
+            add_ns(&deadline, period);
+        }
+
+        //if we fell more than a period behind, re-anchor instead of
+        //drawing all the missed frames back to back
+        clock_gettime(CLOCK_MONOTONIC, &cpu_end);
+        if (ns_between(&deadline, &cpu_end) > period) {
+            anchor_deadline(period, &deadline);
+        }
     }
     pthread_exit(NULL);
     
@@ -360,26 +582,13 @@ void *mil_time(void * arg) {
 
 void *clock_stats(void *arg) {
     while (Finished != true) {
-        struct rusage usage; //declare struct for getusage call
-        int usage_rval = getrusage(RUSAGE_SELF, &usage);
-        errno = 0;
-        if (usage_rval || errno != RUSAGE_GVAL) {
-            perror("Issues getting usage stats for calling process.");
-            pthread_exit(NULL);
-        }
         pthread_mutex_lock(&Screen_lock);
-        printf(MOVE_CURSOR, STATS_START_ROW, STATS_START_COL);
-        printf(CLEAR_LINE); //to avoid overprinting lines
-        printf(DEFAULT_COLOR);
-        printf(MOVE_CURSOR, STATS_START_ROW, STATS_START_COL);
-        printf("User CPU time\t : %ld sec., %ld microsec.", usage.ru_utime.tv_sec, usage.ru_utime.tv_usec);
-        printf(MOVE_CURSOR, STATS_START_ROW+1, STATS_START_COL);
-        printf(CLEAR_LINE);
-        printf(DEFAULT_COLOR);
-        printf(MOVE_CURSOR, STATS_START_ROW+1, STATS_START_COL);
-        printf("System CPU time  : %ld sec., %ld microsec.", usage.ru_stime.tv_sec, usage.ru_stime.tv_usec);
-        fflush(stdout);
+        int stats_rval = draw_stats();
+        frame_flush();
         pthread_mutex_unlock(&Screen_lock);
+        if (stats_rval != RUSAGE_GVAL) {
+            pthread_exit(NULL);
+        }
         
         usleep(HALFSECOND);
 
@@ -387,14 +596,59 @@ void *clock_stats(void *arg) {
     pthread_exit(NULL);
 }
 
+//draws the user prompt for interrupts; the caller holds Screen_lock
+void draw_prompt(void) {
+    const struct layout_t *layout = layout_get();
+    int row = layout->prompt_row;
+    int col = layout->prompt_col;
+
+    frame_printf(DEFAULT_COLOR);
+    frame_printf(MOVE_CURSOR, row++, col);
+    frame_printf("Press Ctrl-C to change clock color.");
+    frame_printf(MOVE_CURSOR, row++, col);
+    frame_printf("Press Ctrl-\\ to change clock time format.");
+    frame_printf(MOVE_CURSOR, row, col);
+    frame_printf("Press CR to Exit.");
+}
+
+//draws the CPU usage lines; the caller holds Screen_lock
+int draw_stats(void) {
+    const struct layout_t *layout = layout_get();
+    struct rusage usage; //declare struct for getusage call
+    errno = 0;
+    int usage_rval = getrusage(RUSAGE_SELF, &usage);
+    if (usage_rval || errno != RUSAGE_GVAL) {
+        perror("Issues getting usage stats for calling process.");
+        return !RUSAGE_GVAL;
+    }
+    frame_printf(MOVE_CURSOR, layout->stats_row, layout->stats_col);
+    frame_printf(CLEAR_LINE, (int)layout->line_width, ""); //to avoid overprinting lines
+    frame_printf(DEFAULT_COLOR);
+    frame_printf(MOVE_CURSOR, layout->stats_row, layout->stats_col);
+    frame_printf("User CPU time\t : %ld sec., %ld microsec.", usage.ru_utime.tv_sec, usage.ru_utime.tv_usec);
+    frame_printf(MOVE_CURSOR, layout->stats_row+1, layout->stats_col);
+    frame_printf(CLEAR_LINE, (int)layout->line_width, "");
+    frame_printf(DEFAULT_COLOR);
+    frame_printf(MOVE_CURSOR, layout->stats_row+1, layout->stats_col);
+    frame_printf("System CPU time  : %ld sec., %ld microsec.", usage.ru_stime.tv_sec, usage.ru_stime.tv_usec);
+    frame_printf(MOVE_CURSOR, layout->stats_row+2, layout->stats_col);
+    frame_printf(CLEAR_LINE, (int)layout->line_width, "");
+    frame_printf(MOVE_CURSOR, layout->stats_row+2, layout->stats_col);
+    long avg_ns = Frame_stats.frames ? Frame_stats.total_ns / (long)Frame_stats.frames : 0;
+    frame_printf("Frame CPU time   : %ld us (avg %ld, max %ld, budget %d), %lu skipped",
+           Frame_stats.last_ns / NSEC_PER_USEC, avg_ns / NSEC_PER_USEC,
+           Frame_stats.max_ns / NSEC_PER_USEC, FRAME_BUDGET_US, Frame_stats.skipped);
+    return RUSAGE_GVAL;
+}
+
 void clean_display(void) {
-    printf("in cleanup function");
+    frame_printf("in cleanup function");
     int row = CLEANUP_ROW_TERM;
     int col = CLEANUP_COL_TERM;
     //reset display color back to default
     current_color = START_COLOR;
     //turn cursor back on
-    printf(SHOW_CURSOR);
+    frame_printf(SHOW_CURSOR);
     //turn back on keyboard input echoing
     
     int tcg_rval = tcgetattr(STDIN_FILENO, &og_term);
@@ -410,10 +664,11 @@ void clean_display(void) {
     }
 
     //display the cursor below the program display, at the left hand column of the terminal
-    printf(CLEAR_SCREEN);
-    printf(MOVE_CURSOR, row, col);
+    frame_printf(CLEAR_SCREEN);
+    frame_printf(MOVE_CURSOR, row, col);
     
-    fflush(stdout);
+    frame_flush();
+    record_close();
     fflush(stderr);
 }
 
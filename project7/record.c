@@ -0,0 +1,485 @@
+// ---------------------------------------------------------------------
+// File: record.c
+//
+// Name: Jonathan Goohs
+//
+// Description:
+//     This module records the frames the clock sends to the terminal
+//     into an append-only binary log, and reads such a log back. See
+//     record.h for the format. Frames are usually tiny edits of the
+//     previous frame (a digit or a statistics line), so each frame is
+//     delta encoded against the previous one whenever that is smaller
+//     than storing it whole.
+//
+// Resources:
+// 1. open(2) man page, O_APPEND
+// 2. en.wikipedia.org/wiki/LEB128
+// ---------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "record.h"
+
+#define MAGIC            "CLKR"
+#define MAGIC_LEN        4
+#define VERSION          1
+#define HEADER_LEN       8
+#define VARINT_MAX      10          // bytes in the longest 64-bit varint
+#define RECORD_OVERHEAD (3 * VARINT_MAX)
+#define MIN_COPY         4          // shorter matches are kept literal
+#define NSEC_PER_USEC    1000L
+#define USEC_PER_SEC     1000000L
+#define SUCCESS          0
+#define NOT_OPEN        -1
+
+// ---------------------------------------------------------------------
+// Global variables (recording side)
+// ---------------------------------------------------------------------
+static int             Log_fd = NOT_OPEN;
+static bool            Use_delta;
+static unsigned char  *Prev;        // previous frame, for delta encoding
+static size_t          Prev_len;
+static unsigned char  *Record;      // one encoded record
+static struct timespec Last_time;   // when the previous frame was sent
+
+
+// ---------------------------------------------------------------------
+// Name:
+//     put_varint
+// Inputs:
+//     out    Where to store the encoding.
+//     value  The value to encode.
+// Outputs:
+//     function result
+//         The number of bytes stored.
+// ---------------------------------------------------------------------
+static size_t put_varint(unsigned char *out, unsigned long value)
+{
+    size_t n = 0;
+
+    while (value >= 0x80) {
+        out[n++] = (value & 0x7f) | 0x80;
+        value >>= 7;
+    }
+    out[n++] = value;
+
+    return n;
+
+}//end put_varint
+
+
+// ---------------------------------------------------------------------
+// Name:
+//     get_varint
+// Inputs:
+//     file  The log being read.
+// Outputs:
+//     value  The decoded value.
+//     count  Incremented by the number of bytes read.
+//     function result
+//         1 on success, 0 at a clean end of file, -1 if the file ends
+//         in the middle of a varint.
+// ---------------------------------------------------------------------
+static int get_varint(FILE *file, unsigned long *value, unsigned long *count)
+{
+    unsigned long result = 0;
+    int           shift  = 0;
+    int           c;
+
+    while ((c = fgetc(file)) != EOF) {
+        ++*count;
+        result |= (unsigned long)(c & 0x7f) << shift;
+        if ((c & 0x80) == 0) {
+            *value = result;
+            return 1;
+        }
+        shift += 7;
+        if (shift >= 64) {
+            return -1;
+        }
+    }
+
+    return (shift == 0) ? 0 : -1;
+
+}//end get_varint
+
+
+// ---------------------------------------------------------------------
+// Name:
+//     read_varint
+// Inputs:
+//     in, end  The bytes to decode from; in is advanced.
+// Outputs:
+//     value  The decoded value.
+//     function result
+//         false if the bytes ran out.
+// ---------------------------------------------------------------------
+static bool read_varint(const unsigned char **in, const unsigned char *end,
+                        unsigned long *value)
+{
+    unsigned long result = 0;
+    int           shift  = 0;
+
+    while (*in < end && shift < 64) {
+        unsigned char c = *(*in)++;
+        result |= (unsigned long)(c & 0x7f) << shift;
+        if ((c & 0x80) == 0) {
+            *value = result;
+            return true;
+        }
+        shift += 7;
+    }
+
+    return false;
+
+}//end read_varint
+
+
+// ---------------------------------------------------------------------
+// Name:
+//     matches_prev
+// Inputs:
+//     cur, len  The frame being encoded.
+//     pos       An offset into the frame.
+// Outputs:
+//     function result
+//         true if at least MIN_COPY bytes at pos are the same as in
+//         the previous frame.
+// ---------------------------------------------------------------------
+static bool matches_prev(const unsigned char *cur, const size_t len,
+                         const size_t pos)
+{
+    return (pos + MIN_COPY <= len) && (pos + MIN_COPY <= Prev_len) &&
+           (memcmp(cur + pos, Prev + pos, MIN_COPY) == 0);
+
+}//end matches_prev
+
+
+// ---------------------------------------------------------------------
+// Name:
+//     delta_encode
+// Inputs:
+//     cur, len  The frame to encode.
+//     out       Room for at most len bytes of encoding.
+// Outputs:
+//     function result
+//         The size of the encoding, or 0 if it would not be smaller
+//         than the frame itself.
+// Description:
+//     Encodes the frame as runs of bytes copied from the same offset
+//     of the previous frame and runs of literal bytes.
+// ---------------------------------------------------------------------
+static size_t delta_encode(const unsigned char *cur, const size_t len,
+                           unsigned char *out)
+{
+    size_t n = 0;
+    size_t i = 0;
+
+    while (i < len) {
+        size_t copy = 0;
+        size_t lit  = 0;
+
+        // bytes that match the previous frame
+        while ((i + copy < len) && (i + copy < Prev_len) &&
+               (cur[i + copy] == Prev[i + copy])) {
+            ++copy;
+        }
+        i += copy;
+
+        // new bytes, up to the next match worth copying
+        while ((i + lit < len) && !matches_prev(cur, len, i + lit)) {
+            ++lit;
+        }
+
+        if (n + 2 * VARINT_MAX + lit >= len) {
+            return 0;    // not worth it
+        }
+        n += put_varint(out + n, copy);
+        n += put_varint(out + n, lit);
+        memcpy(out + n, cur + i, lit);
+        n += lit;
+        i += lit;
+    }
+
+    return n;
+
+}//end delta_encode
+
+
+// ---------------------------------------------------------------------
+// Name:
+//     delta_decode
+// Inputs:
+//     in, size   The payload.
+//     prev       The previous frame.
+//     len        The length of the frame being decoded.
+// Outputs:
+//     out        The decoded frame.
+//     function result
+//         false if the payload is damaged.
+// ---------------------------------------------------------------------
+static bool delta_decode(const unsigned char *in, const size_t size,
+                         const unsigned char *prev, const size_t prev_len,
+                         unsigned char *out, const size_t len)
+{
+    const unsigned char *end = in + size;
+    size_t i = 0;
+
+    while (i < len) {
+        unsigned long copy;
+        unsigned long lit;
+
+        if (!read_varint(&in, end, &copy) || !read_varint(&in, end, &lit) ||
+            i + copy + lit > len || i + copy > prev_len ||
+            (unsigned long)(end - in) < lit) {
+            return false;
+        }
+        memcpy(out + i, prev + i, copy);
+        i += copy;
+        memcpy(out + i, in, lit);
+        in += lit;
+        i  += lit;
+    }
+
+    return in == end;
+
+}//end delta_decode
+
+
+// ---------------------------------------------------------------------
+// Name:
+//     record_open
+// Description:
+//     See record.h
+// ---------------------------------------------------------------------
+int record_open(const char *path, const bool delta)
+{
+    unsigned char header[HEADER_LEN] = { 0 };
+    struct stat   info;
+
+    Prev   = malloc(RECORD_MAX_FRAME);
+    Record = malloc(RECORD_MAX_FRAME + RECORD_OVERHEAD);
+    if (Prev == NULL || Record == NULL) {
+        record_close();
+        return ENOMEM;
+    }
+
+    Log_fd = open(path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (Log_fd < 0 || fstat(Log_fd, &info) != SUCCESS) {
+        int error = errno;
+        record_close();
+        return error;
+    }
+
+    // a new log starts with the header; an old one is appended to
+    if (info.st_size == 0) {
+        memcpy(header, MAGIC, MAGIC_LEN);
+        header[MAGIC_LEN] = VERSION;
+        if (write(Log_fd, header, HEADER_LEN) != HEADER_LEN) {
+            int error = errno;
+            record_close();
+            return error;
+        }
+    }
+
+    Use_delta = delta;
+    Prev_len  = 0;    // the first frame of a session is stored whole
+    clock_gettime(CLOCK_MONOTONIC, &Last_time);
+
+    return SUCCESS;
+
+}//end record_open
+
+
+// ---------------------------------------------------------------------
+// Name:
+//     record_frame
+// Description:
+//     See record.h
+// ---------------------------------------------------------------------
+void record_frame(const char *bytes, const size_t len)
+{
+    const unsigned char *frame = (const unsigned char *)bytes;
+    unsigned char        head[RECORD_OVERHEAD];
+    struct timespec      now;
+    unsigned long        delay;
+    size_t               payload = 0;
+    size_t               n;
+    int                  delta = 0;
+
+    if (Log_fd == NOT_OPEN || len == 0 || len > RECORD_MAX_FRAME) {
+        return;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    delay = (now.tv_sec - Last_time.tv_sec) * USEC_PER_SEC +
+            (now.tv_nsec - Last_time.tv_nsec) / NSEC_PER_USEC;
+    Last_time = now;
+
+    // encode the payload after room for the largest record header
+    if (Use_delta && Prev_len > 0) {
+        payload = delta_encode(frame, len, Record + RECORD_OVERHEAD);
+        delta   = (payload > 0) ? RECORD_DELTA : 0;
+    }
+    if (!delta) {
+        memcpy(Record + RECORD_OVERHEAD, frame, len);
+        payload = len;
+    }
+
+    // then slide the header in right in front of it
+    n  = put_varint(head, delay);
+    n += put_varint(head + n, (len << 1) | delta);
+    n += put_varint(head + n, payload);
+    memcpy(Record + RECORD_OVERHEAD - n, head, n);
+
+    if (write(Log_fd, Record + RECORD_OVERHEAD - n, n + payload) < 0) {
+        ; // keep the clock running even if the log cannot be written
+    }
+
+    memcpy(Prev, frame, len);
+    Prev_len = len;
+
+}//end record_frame
+
+
+// ---------------------------------------------------------------------
+// Name:
+//     record_close
+// Description:
+//     See record.h
+// ---------------------------------------------------------------------
+void record_close(void)
+{
+    if (Log_fd != NOT_OPEN) {
+        close(Log_fd);
+        Log_fd = NOT_OPEN;
+    }
+    free(Prev);
+    free(Record);
+    Prev   = NULL;
+    Record = NULL;
+
+}//end record_close
+
+
+// ---------------------------------------------------------------------
+// Name:
+//     record_reader_open
+// Description:
+//     See record.h
+// ---------------------------------------------------------------------
+int record_reader_open(struct record_reader_t *reader, const char *path)
+{
+    unsigned char header[HEADER_LEN];
+
+    memset(reader, 0, sizeof(*reader));
+    reader->file = fopen(path, "rb");
+    if (reader->file == NULL) {
+        return errno;
+    }
+
+    if (fread(header, 1, HEADER_LEN, reader->file) != HEADER_LEN ||
+        memcmp(header, MAGIC, MAGIC_LEN) != 0 || header[MAGIC_LEN] != VERSION) {
+        record_reader_close(reader);
+        return EINVAL;
+    }
+    reader->log_bytes = HEADER_LEN;
+
+    reader->prev    = malloc(RECORD_MAX_FRAME);
+    reader->frame   = malloc(RECORD_MAX_FRAME);
+    reader->payload = malloc(RECORD_MAX_FRAME + RECORD_OVERHEAD);
+    if (reader->prev == NULL || reader->frame == NULL ||
+        reader->payload == NULL) {
+        record_reader_close(reader);
+        return ENOMEM;
+    }
+
+    return SUCCESS;
+
+}//end record_reader_open
+
+
+// ---------------------------------------------------------------------
+// Name:
+//     record_read
+// Description:
+//     See record.h
+// ---------------------------------------------------------------------
+int record_read(struct record_reader_t *reader, unsigned long *delay_us,
+                const unsigned char **bytes, size_t *len)
+{
+    unsigned long  info;
+    unsigned long  size;
+    unsigned long  frame_len;
+    unsigned char *swap;
+    int            rval;
+
+    rval = get_varint(reader->file, delay_us, &reader->log_bytes);
+    if (rval <= 0) {
+        return rval;
+    }
+    if (get_varint(reader->file, &info, &reader->log_bytes) != 1 ||
+        get_varint(reader->file, &size, &reader->log_bytes) != 1) {
+        return -1;
+    }
+
+    frame_len = info >> 1;
+    if (frame_len > RECORD_MAX_FRAME ||
+        size > RECORD_MAX_FRAME + RECORD_OVERHEAD ||
+        fread(reader->payload, 1, size, reader->file) != size) {
+        return -1;
+    }
+    reader->log_bytes += size;
+
+    if (info & RECORD_DELTA) {
+        if (!delta_decode(reader->payload, size, reader->prev,
+                          reader->prev_len, reader->frame, frame_len)) {
+            return -1;
+        }
+    } else {
+        if (size != frame_len) {
+            return -1;
+        }
+        memcpy(reader->frame, reader->payload, size);
+    }
+
+    // the frame just read is the base for the next delta
+    swap           = reader->prev;
+    reader->prev   = reader->frame;
+    reader->frame  = swap;
+    reader->prev_len = frame_len;
+
+    *bytes = reader->prev;
+    *len   = frame_len;
+
+    return 1;
+
+}//end record_read
+
+
+// ---------------------------------------------------------------------
+// Name:
+//     record_reader_close
+// Description:
+//     See record.h
+// ---------------------------------------------------------------------
+void record_reader_close(struct record_reader_t *reader)
+{
+    if (reader->file != NULL) {
+        fclose(reader->file);
+    }
+    free(reader->prev);
+    free(reader->frame);
+    free(reader->payload);
+    memset(reader, 0, sizeof(*reader));
+
+}//end record_reader_close
+
+//end record.c
@@ -0,0 +1,123 @@
+// ------------------------------------------------------------------
+// File: record.h
+//
+// Name: Jonathan Goohs
+//
+// Description:
+//     This is the header file for the RECORD module, which writes the
+//     frames sent to the terminal into a compact append-only log and
+//     reads them back for replay.
+//
+//     Log format (all integers are unsigned LEB128 varints):
+//         header  "CLKR" followed by a version byte and 3 reserved
+//                 bytes; written once when the log is created
+//         record  delay   microseconds since the previous frame
+//                 info    (frame length << 1) | RECORD_DELTA
+//                 size    # payload bytes that follow
+//                 payload the frame bytes, or when RECORD_DELTA is
+//                         set, a list of (copy, literal, bytes...)
+//                         runs: copy bytes come from the same offset
+//                         of the previous frame, followed by literal
+//                         new bytes, until the frame length is reached
+//     The first frame of every recording session is stored whole, so
+//     sessions appended to the same log replay correctly.
+// ------------------------------------------------------------------
+
+#ifndef _RECORD_H_
+#define _RECORD_H_
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define RECORD_DELTA       0x01    // payload is delta encoded
+#define RECORD_MAX_FRAME  65536    // largest frame that can be logged
+
+// A log opened for reading
+struct record_reader_t {
+    FILE          *file;
+    unsigned char *prev;           // previous decoded frame
+    size_t         prev_len;
+    unsigned char *frame;          // the frame most recently read
+    unsigned char *payload;        // scratch space for the payload
+    unsigned long  log_bytes;      // # bytes read from the log so far
+};
+
+// ------------------------------------------------------------------
+// Function:
+//     record_open
+// Inputs:
+//     path   The log to append to; it is created if needed.
+//     delta  Whether frames may be delta encoded against the
+//            previous frame.
+// Outputs:
+//     function result
+//         0 on success, otherwise an errno value.
+// Description:
+//     Starts recording. Every frame passed to record_frame() after
+//     this is appended to the log with a single write.
+// ------------------------------------------------------------------
+extern int record_open(const char *path, const bool delta);
+
+// ------------------------------------------------------------------
+// Function:
+//     record_frame
+// Inputs:
+//     bytes, len  The bytes of one frame, as sent to the terminal.
+// Description:
+//     Appends the frame and its timestamp to the log. Does nothing
+//     when no recording was started.
+// ------------------------------------------------------------------
+extern void record_frame(const char *bytes, const size_t len);
+
+// ------------------------------------------------------------------
+// Function:
+//     record_close
+// Description:
+//     Stops recording and closes the log.
+// ------------------------------------------------------------------
+extern void record_close(void);
+
+// ------------------------------------------------------------------
+// Function:
+//     record_reader_open
+// Inputs:
+//     reader  The reader to initialize.
+//     path    The log to read.
+// Outputs:
+//     function result
+//         0 on success, otherwise an errno value (EINVAL if the file
+//         is not a clock log).
+// ------------------------------------------------------------------
+extern int record_reader_open(struct record_reader_t *reader,
+                              const char *path);
+
+// ------------------------------------------------------------------
+// Function:
+//     record_read
+// Inputs:
+//     reader  An open reader.
+// Outputs:
+//     delay_us  Microseconds between this frame and the previous one
+//     bytes     The decoded frame; valid until the next call
+//     len       The length of the frame
+//     function result
+//         1 when a frame was read, 0 at the end of the log, or -1 if
+//         the log is damaged.
+// ------------------------------------------------------------------
+extern int record_read(struct record_reader_t *reader,
+                       unsigned long *delay_us,
+                       const unsigned char **bytes,
+                       size_t *len);
+
+// ------------------------------------------------------------------
+// Function:
+//     record_reader_close
+// Description:
+//     Closes the log and frees the reader's buffers.
+// ------------------------------------------------------------------
+extern void record_reader_close(struct record_reader_t *reader);
+
+#endif
+
+//end record.h
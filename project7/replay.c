@@ -0,0 +1,170 @@
+// ------------------------------------------------------------------
+// File: replay.c
+//
+// Name: Jonathan Goohs
+//
+// Description:
+//     This program plays back a log recorded with "./clock -r". The
+//     frames are written to the terminal (or any other sink) either
+//     with their original timing or as fast as possible. Replaying at
+//     maximum speed into a terminal measures how fast the terminal
+//     can consume the clock's output; replaying into /dev/null
+//     measures the decoder alone.
+//
+// Syntax:
+//     ./replay [-m] [-o sink] log
+//     -m replays at maximum speed instead of the original speed.
+//     -o writes the frames to sink instead of stdout.
+//     A summary of the replay is printed on stderr.
+//
+// Resources
+// 1. clock_nanosleep man page (TIMER_ABSTIME)
+// ------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include "record.h"
+
+#define OPTIONS        "mo:"
+#define NSEC_PER_SEC   1000000000L
+#define NSEC_PER_USEC  1000L
+#define BYTES_PER_MB   1000000.0
+#define SUCCESS        0
+
+// ------------------------------------------------------------------
+// Function prototypes
+// ------------------------------------------------------------------
+int write_all(int fd, const unsigned char *bytes, size_t len);
+void add_usec(struct timespec *ts, unsigned long usec);
+double seconds_since(const struct timespec *start);
+
+// ********************************************************************
+// ****************************** M A I N *****************************
+// ********************************************************************
+int main(int argc, char *argv[])
+{
+    struct record_reader_t reader;
+    struct timespec start;
+    struct timespec due;
+    const unsigned char *frame;
+    unsigned long delay;
+    unsigned long frames = 0;
+    unsigned long bytes  = 0;
+    size_t len;
+    bool max_speed = false;
+    char *sink = NULL;
+    int out_fd = STDOUT_FILENO;
+    int opt;
+    int rval;
+
+    while ((opt = getopt(argc, argv, OPTIONS)) != -1) {
+        if (opt == 'm') {
+            max_speed = true;
+        } else if (opt == 'o') {
+            sink = optarg;
+        } else {
+            optind = argc + 1;    // force the usage message
+            break;
+        }
+    }
+    if (optind != argc - 1) {
+        fprintf(stderr, "Usage: %s [-m] [-o sink] log\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    rval = record_reader_open(&reader, argv[optind]);
+    if (rval != SUCCESS) {
+        fprintf(stderr, "Unable to read %s: %s\n", argv[optind],
+                (rval == EINVAL) ? "not a clock log" : strerror(rval));
+        return EXIT_FAILURE;
+    }
+    if (sink != NULL) {
+        out_fd = open(sink, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (out_fd < 0) {
+            perror("Unable to open the sink");
+            record_reader_close(&reader);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Frames are due at the start time plus the sum of the delays, so
+    // time spent writing a frame does not push the later ones back
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    due = start;
+    while ((rval = record_read(&reader, &delay, &frame, &len)) == 1) {
+        if (!max_speed) {
+            add_usec(&due, delay);
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due,
+                                   NULL) == EINTR) {
+                ;
+            }
+        }
+        if (write_all(out_fd, frame, len) != SUCCESS) {
+            perror("Error writing a frame");
+            break;
+        }
+        ++frames;
+        bytes += len;
+    }
+    double elapsed = seconds_since(&start);
+
+    if (rval < 0) {
+        fprintf(stderr, "Warning: the log is damaged after frame %lu\n",
+                frames);
+    }
+    fprintf(stderr, "%lu frames, %lu bytes (log %lu bytes) in %.3f s: "
+            "%.0f frames/s, %.2f MB/s\n", frames, bytes, reader.log_bytes,
+            elapsed, frames / elapsed, bytes / BYTES_PER_MB / elapsed);
+
+    record_reader_close(&reader);
+    if (sink != NULL) {
+        close(out_fd);
+    }
+
+    return (rval < 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+
+}//end main
+
+
+//writes the whole frame, retrying short writes
+int write_all(int fd, const unsigned char *bytes, size_t len) {
+    while (len > 0) {
+        ssize_t done = write(fd, bytes, len);
+        if (done < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno;
+        }
+        bytes += done;
+        len   -= done;
+    }
+    return SUCCESS;
+}
+
+//moves a timespec forward by usec microseconds
+void add_usec(struct timespec *ts, unsigned long usec) {
+    long ns = usec * NSEC_PER_USEC;
+    ts->tv_sec  += ns / NSEC_PER_SEC;
+    ts->tv_nsec += ns % NSEC_PER_SEC;
+    if (ts->tv_nsec >= NSEC_PER_SEC) {
+        ts->tv_nsec -= NSEC_PER_SEC;
+        ts->tv_sec++;
+    }
+}
+
+//seconds on the monotonic clock since start
+double seconds_since(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) +
+           (now.tv_nsec - start->tv_nsec) / (double)NSEC_PER_SEC;
+}
+
+//end replay.c